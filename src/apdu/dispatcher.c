@@ -31,6 +31,8 @@
 #include "../handler/get_app_name.h"
 #include "../handler/get_public_key.h"
 #include "../handler/sign_tx.h"
+#include "../handler/get_batch_signatures.h"
+#include "../handler/get_addresses.h"
 
 int apdu_dispatcher(const command_t *cmd) {
     LEDGER_ASSERT(cmd != NULL, "NULL cmd");
@@ -55,7 +57,8 @@ int apdu_dispatcher(const command_t *cmd) {
 
             return handler_get_app_name();
         case GET_PUBLIC_KEY:
-            if (cmd->p1 > 1 || cmd->p2 > 0) {
+            // The extended public key is not displayed
+            if (cmd->p1 > 1 || cmd->p2 > P2_EXTENDED || (cmd->p1 == 1 && cmd->p2 == P2_EXTENDED)) {
                 return io_send_sw(SW_WRONG_P1P2);
             }
 
@@ -67,13 +70,19 @@ int apdu_dispatcher(const command_t *cmd) {
             buf.size = cmd->lc;
             buf.offset = 0;
 
-            return handler_get_public_key(&buf, (bool) cmd->p1);
+            return handler_get_public_key(&buf, (bool) cmd->p1, cmd->p2 == P2_EXTENDED);
         case SIGN_TX:
-            if ((cmd->p1 == P1_START && cmd->p2 != P2_MORE) ||  //
-                cmd->p1 > P1_MAX ||                             //
-                (cmd->p2 != P2_LAST && cmd->p2 != P2_MORE)) {
+            // The fee payer, multi path and batch flags are only accepted with the BIP32 paths,
+            // on the first chunk. A batch is signed by one path as its sender.
+            if ((cmd->p1 == P1_START &&
+                 (cmd->p2 & ~(P2_FEE_PAYER | P2_MULTI_PATH | P2_BATCH)) != P2_MORE) ||
+                (cmd->p1 == P1_START && (cmd->p2 & P2_BATCH) &&
+                 (cmd->p2 & (P2_FEE_PAYER | P2_MULTI_PATH))) ||
+                (cmd->p1 != P1_START && cmd->p2 != P2_LAST && cmd->p2 != P2_MORE)) {
                 return io_send_sw(SW_WRONG_P1P2);
             }
+            // The chunk index is not bounded and wraps from 0xFF to 0x01, the retained
+            // transaction length is checked by the handler
 
             if (!cmd->data) {
                 return io_send_sw(SW_WRONG_DATA_LENGTH);
@@ -83,7 +92,33 @@ int apdu_dispatcher(const command_t *cmd) {
             buf.size = cmd->lc;
             buf.offset = 0;
 
-            return handler_sign_tx(&buf, cmd->p1, (bool) (cmd->p2 & P2_MORE));
+            return handler_sign_tx(&buf,
+                                   cmd->p1,
+                                   (bool) (cmd->p2 & P2_MORE),
+                                   (bool) (cmd->p2 & P2_FEE_PAYER),
+                                   (bool) (cmd->p2 & P2_MULTI_PATH),
+                                   (bool) (cmd->p2 & P2_BATCH));
+        case GET_BATCH_SIGNATURES:
+            if (cmd->p1 != 0 || cmd->p2 != 0) {
+                return io_send_sw(SW_WRONG_P1P2);
+            }
+
+            return handler_get_batch_signatures();
+        case GET_ADDRESSES:
+            // The first request holds the path and the range, the next ones hold no data
+            if (cmd->p1 > 1 || (cmd->p2 != P2_LAST && cmd->p2 != P2_MORE)) {
+                return io_send_sw(SW_WRONG_P1P2);
+            }
+
+            if (cmd->p2 == P2_LAST && !cmd->data) {
+                return io_send_sw(SW_WRONG_DATA_LENGTH);
+            }
+
+            buf.ptr = cmd->data;
+            buf.size = cmd->lc;
+            buf.offset = 0;
+
+            return handler_get_addresses(&buf, (bool) cmd->p1, cmd->p2 == P2_MORE);
         default:
             return io_send_sw(SW_INS_NOT_SUPPORTED);
     }
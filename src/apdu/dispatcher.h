@@ -13,13 +13,25 @@
  */
 #define P2_MORE 0x80
 /**
- * Parameter 1 for first APDU number.
+ * Parameter 2 flag of the first SIGN_TX APDU to sign as the fee payer.
  */
-#define P1_START 0x00
+#define P2_FEE_PAYER 0x01
+/**
+ * Parameter 2 flag of the first SIGN_TX APDU holding several BIP32 paths.
+ */
+#define P2_MULTI_PATH 0x02
+/**
+ * Parameter 2 flag of the first SIGN_TX APDU starting a batch of transactions.
+ */
+#define P2_BATCH 0x04
 /**
- * Parameter 1 for maximum APDU number.
+ * Parameter 2 of GET_PUBLIC_KEY to return the extended public key of a hardened path.
  */
-#define P1_MAX MAX_TRANSACTION_LEN / MAX_APDU_SIZE
+#define P2_EXTENDED 0x01
+/**
+ * Parameter 1 for first APDU number.
+ */
+#define P1_START 0x00
 
 /**
  * Dispatch APDU command received to the right handler.
@@ -25,6 +25,7 @@
 #include "globals.h"
 #include "io.h"
 #include "sw.h"
+#include "helper/bip32_cache.h"
 #include "ui/menu.h"
 #include "apdu/dispatcher.h"
 
@@ -61,6 +62,7 @@ void app_main() {
         // Receive command bytes in G_io_apdu_buffer
         if ((input_len = io_recv_command()) < 0) {
             PRINTF("=> io_recv_command failure\n");
+            bip32_cache_wipe();
             return;
         }
 
@@ -83,6 +85,7 @@ void app_main() {
         // Dispatch structured APDU command to handler
         if (apdu_dispatcher(&cmd) < 0) {
             PRINTF("=> apdu_dispatcher failure\n");
+            bip32_cache_wipe();
             return;
         }
     }
@@ -21,7 +21,8 @@
 #define MAX_APPNAME_LEN 64
 
 /**
- * Maximum transaction length (bytes).
+ * Maximum transaction length (bytes) when the raw transaction is kept in RAM.
+ * Not used with HAVE_STREAMING_SIGN_TX, where each chunk is dropped once parsed and hashed.
  */
 #define MAX_TRANSACTION_LEN 8190
 
@@ -30,9 +31,10 @@
  */
 #define MAX_APDU_SIZE 255
 /**
- * Maximum signature length (bytes).
+ * Maximum number of BIP32 paths signing one transaction, their signatures fit in one response
+ * for a chain ID of up to 19 bytes.
  */
-#define MAX_DER_SIG_LEN 72
+#define MAX_SIGN_PATHS 3
 
 /**
  * Exponent used to convert peb to KAIA unit (N KAIA = N * 10^18 kei).
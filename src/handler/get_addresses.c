@@ -0,0 +1,108 @@
+/*****************************************************************************
+ *   Ledger App Kaia.
+ *   (c) 2024 Blooo SAS.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *****************************************************************************/
+
+#include <stdint.h>   // uint*_t
+#include <stdbool.h>  // bool
+#include <stddef.h>   // size_t
+#include <string.h>   // memcpy, explicit_bzero
+
+#include "os.h"
+#include "cx.h"
+#include "io.h"
+#include "buffer.h"
+
+#include "get_addresses.h"
+#include "../globals.h"
+#include "../types.h"
+#include "../sw.h"
+#include "../address.h"
+#include "../helper/bip32_cache.h"
+#include "../transaction/types.h"
+
+#define HARDENED_INDEX 0x80000000
+
+// Derive the records of the next indices of the range, as many as fit in one response
+static int send_addresses(void) {
+    discovery_ctx_t *ctx = &G_context.discovery_info;
+    size_t record_len = ctx->public_keys ? COMPRESSED_PUBKEY_LEN : ADDRESS_LEN;
+    uint8_t resp[DISCOVERY_RESPONSE_LEN];
+    uint8_t raw_public_key[65];
+    uint32_t path[MAX_BIP32_PATH];
+    size_t offset = 0;
+
+    // The indices share the parent node of the path, each one only derives its last step
+    memcpy(path, G_context.bip32_path, G_context.bip32_path_len * sizeof(path[0]));
+    while (ctx->next < ctx->end && offset + record_len <= sizeof(resp)) {
+        path[G_context.bip32_path_len] = ctx->next;
+        cx_err_t error =
+            bip32_cache_get_pubkey(path, G_context.bip32_path_len + 1, raw_public_key, NULL);
+        if (error != CX_OK) {
+            explicit_bzero(&G_context, sizeof(G_context));
+            return io_send_sw(error);
+        }
+        if (ctx->public_keys) {
+            compress_public_key(raw_public_key, resp + offset);
+        } else if (!address_from_pubkey(raw_public_key, resp + offset, ADDRESS_LEN)) {
+            explicit_bzero(&G_context, sizeof(G_context));
+            return io_send_sw(SW_ADDRESS_FAIL);
+        }
+        offset += record_len;
+        ctx->next++;
+    }
+    if (ctx->next == ctx->end) {
+        G_context.state = STATE_NONE;
+    }
+
+    return io_send_response_pointer(resp, offset, SW_OK);
+}
+
+int handler_get_addresses(buffer_t *cdata, bool public_keys, bool more) {
+    uint32_t first = 0;
+    uint8_t count = 0;
+
+    if (more) {
+        // The range is sent over several responses, the next ones on request
+        if (G_context.req_type != DISCOVER_ADDRESSES || G_context.state != STATE_PARSED) {
+            return io_send_sw(SW_BAD_STATE);
+        }
+        return send_addresses();
+    }
+
+    explicit_bzero(&G_context, sizeof(G_context));
+    G_context.req_type = DISCOVER_ADDRESSES;
+    G_context.state = STATE_NONE;
+
+    // The index is appended to the path, which leaves room for one more derivation
+    if (!buffer_read_u8(cdata, &G_context.bip32_path_len) ||
+        G_context.bip32_path_len >= MAX_BIP32_PATH ||
+        !buffer_read_bip32_path(cdata, G_context.bip32_path, (size_t) G_context.bip32_path_len) ||
+        !buffer_read_u32(cdata, &first, BE) || !buffer_read_u8(cdata, &count)) {
+        return io_send_sw(SW_WRONG_DATA_LENGTH);
+    }
+
+    // Addresses are normal children of the path
+    if (count == 0 || first >= HARDENED_INDEX || count > HARDENED_INDEX - first) {
+        return io_send_sw(SW_WRONG_INDEX_RANGE);
+    }
+
+    G_context.discovery_info.next = first;
+    G_context.discovery_info.end = first + count;
+    G_context.discovery_info.public_keys = public_keys;
+    G_context.state = STATE_PARSED;
+
+    return send_addresses();
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stdbool.h>  // bool
+
+#include "buffer.h"
+
+#include "../types.h"
+
+/**
+ * Maximum length of the records of one GET_ADDRESSES response.
+ */
+#define DISCOVERY_RESPONSE_LEN 240
+
+/**
+ * Handler for GET_ADDRESSES command. If successfully parse the BIP32 path
+ * and the range of indices, derive the addresses of the first indices and
+ * send APDU response. The following ones are sent on the next requests.
+ *
+ * @see G_context.bip32_path and G_context.discovery_info.
+ *
+ * @param[in,out] cdata
+ *   Command data with BIP32 path, first index and number of indices.
+ * @param[in]     public_keys
+ *   Whether to send compressed public keys instead of addresses.
+ * @param[in]     more
+ *   Whether to send the next addresses of the range already received.
+ *
+ * @return zero or positive integer if success, negative integer otherwise.
+ *
+ */
+int handler_get_addresses(buffer_t *cdata, bool public_keys, bool more);
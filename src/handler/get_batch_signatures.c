@@ -0,0 +1,34 @@
+/*****************************************************************************
+ *   Ledger App Kaia.
+ *   (c) 2024 Blooo SAS.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *****************************************************************************/
+
+#include "io.h"
+
+#include "get_batch_signatures.h"
+#include "../globals.h"
+#include "../sw.h"
+#include "../types.h"
+#include "../ui/action/validate.h"
+
+int handler_get_batch_signatures() {
+    // The signatures of the first transactions are sent on approval, the others on request
+    if (G_context.req_type != CONFIRM_TRANSACTION || G_context.state != STATE_APPROVED ||
+        G_context.tx_info.batch.count == 0) {
+        return io_send_sw(SW_BAD_STATE);
+    }
+
+    return validate_batch_signatures();
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "os.h"
+
+/**
+ * Handler for GET_BATCH_SIGNATURES command. Once a batch is approved, sign
+ * its next transactions and send APDU response with their signatures.
+ *
+ * @see G_context.tx_info.batch.
+ *
+ * @return zero or positive integer if success, negative integer otherwise.
+ *
+ */
+int handler_get_batch_signatures(void);
@@ -24,16 +24,68 @@
 #include "cx.h"
 #include "io.h"
 #include "buffer.h"
-#include "crypto_helpers.h"
 
 #include "get_public_key.h"
 #include "../globals.h"
 #include "../types.h"
 #include "../sw.h"
 #include "../ui/display.h"
+#include "../helper/bip32_cache.h"
 #include "../helper/send_response.h"
 
-int handler_get_public_key(buffer_t *cdata, bool display) {
+#define HARDENED_INDEX 0x80000000
+
+// The parent of an account path, derived for its fingerprint, must itself be under the 44'/60'
+// prefix the app is allowed to derive
+#define MIN_ACCOUNT_PATH_LEN 3
+
+// Check whether the path is an account path, of hardened indices below 44'/60'
+static bool is_account_path(void) {
+    for (uint8_t i = 0; i < G_context.bip32_path_len; i++) {
+        if ((G_context.bip32_path[i] & HARDENED_INDEX) == 0) {
+            return false;
+        }
+    }
+    return G_context.bip32_path_len >= MIN_ACCOUNT_PATH_LEN;
+}
+
+// Compute the fingerprint of the parent of the path, the first bytes of the HASH160 of its
+// compressed public key
+static cx_err_t get_parent_fingerprint(uint8_t fingerprint[static 4]) {
+    uint8_t raw_public_key[65];
+    uint8_t public_key[COMPRESSED_PUBKEY_LEN];
+    uint8_t hash[CX_SHA256_SIZE];
+    uint8_t hash160[CX_RIPEMD160_SIZE];
+    cx_sha256_t sha256;
+    cx_ripemd160_t ripemd160;
+    cx_err_t error;
+
+    CX_CHECK(bip32_cache_get_pubkey(G_context.bip32_path,
+                                    G_context.bip32_path_len - 1,
+                                    raw_public_key,
+                                    NULL));
+    compress_public_key(raw_public_key, public_key);
+    CX_CHECK(cx_sha256_init_no_throw(&sha256));
+    CX_CHECK(cx_hash_no_throw((cx_hash_t *) &sha256,
+                              CX_LAST,
+                              public_key,
+                              sizeof(public_key),
+                              hash,
+                              sizeof(hash)));
+    CX_CHECK(cx_ripemd160_init_no_throw(&ripemd160));
+    CX_CHECK(cx_hash_no_throw((cx_hash_t *) &ripemd160,
+                              CX_LAST,
+                              hash,
+                              sizeof(hash),
+                              hash160,
+                              sizeof(hash160)));
+    memmove(fingerprint, hash160, 4);
+
+end:
+    return error;
+}
+
+int handler_get_public_key(buffer_t *cdata, bool display, bool extended) {
     explicit_bzero(&G_context, sizeof(G_context));
     G_context.req_type = CONFIRM_ADDRESS;
     G_context.state = STATE_NONE;
@@ -43,17 +95,31 @@ int handler_get_public_key(buffer_t *cdata, bool display) {
         return io_send_sw(SW_WRONG_DATA_LENGTH);
     }
 
-    cx_err_t error = bip32_derive_get_pubkey_256(CX_CURVE_256K1,
-                                                 G_context.bip32_path,
-                                                 G_context.bip32_path_len,
-                                                 G_context.pk_info.raw_public_key,
-                                                 G_context.pk_info.chain_code,
-                                                 CX_SHA512);
+    // Normal children of an account are derived by the host, its own path is hardened
+    if (extended && !is_account_path()) {
+        return io_send_sw(SW_WRONG_ACCOUNT_PATH);
+    }
+
+    // The parent is derived first, the cache is then left with the account node
+    cx_err_t error = CX_OK;
+    if (extended) {
+        error = get_parent_fingerprint(G_context.pk_info.parent_fingerprint);
+    }
+    if (error == CX_OK) {
+        error = bip32_cache_get_pubkey(G_context.bip32_path,
+                                       G_context.bip32_path_len,
+                                       G_context.pk_info.raw_public_key,
+                                       G_context.pk_info.chain_code);
+    }
 
     if (error != CX_OK) {
         return io_send_sw(error);
     }
 
+    if (extended) {
+        return helper_send_response_xpub();
+    }
+
     if (display) {
         return ui_display_address();
     }
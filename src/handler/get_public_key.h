@@ -19,8 +19,11 @@
  *   Command data with BIP32 path.
  * @param[in]     display
  *   Whether to display address on screen or not.
+ * @param[in]     extended
+ *   Whether to send the extended public key of an account path instead, of at least 3
+ *   hardened indices.
  *
  * @return zero or positive integer if success, negative integer otherwise.
  *
  */
-int handler_get_public_key(buffer_t *cdata, bool display);
+int handler_get_public_key(buffer_t *cdata, bool display, bool extended);
@@ -30,72 +30,164 @@
 #include "../ui/display.h"
 #include "../transaction/types.h"
 #include "../transaction/deserialize.h"
+#include "../transaction/batch.h"
 
-int handler_sign_tx(buffer_t *cdata, uint8_t chunk, bool more) {
-    if (chunk == 0) {  // first APDU, parse BIP32 path
+// Read the BIP32 paths signing the transaction, a single one unless preceded by their number
+static bool readPaths(buffer_t *cdata, bool multi_path) {
+    transaction_ctx_t *tx_info = &G_context.tx_info;
+
+    tx_info->paths_count = 1;
+    if (multi_path && (!buffer_read_u8(cdata, &tx_info->paths_count) ||
+                       tx_info->paths_count == 0 || tx_info->paths_count > MAX_SIGN_PATHS)) {
+        return false;
+    }
+    for (uint8_t i = 0; i < tx_info->paths_count; i++) {
+        sign_path_t *path = &tx_info->paths[i];
+        if (!buffer_read_u8(cdata, &path->path_len) ||
+            !buffer_read_bip32_path(cdata, path->path, (size_t) path->path_len)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Start the parsing and the hash of a transaction, before its first chunk
+static bool startTransaction(bool fee_payer) {
+    G_context.tx_info.raw_tx_len = 0;
+    transaction_deserialize_init(&G_context.tx_info.parser_ctx, &G_context.tx_info.transaction);
+    if (fee_payer) {
+        transaction_deserialize_set_fee_payer(&G_context.tx_info.parser_ctx);
+    }
+#ifdef HAVE_STREAMING_SIGN_TX
+    transaction_deserialize_set_staging(&G_context.tx_info.parser_ctx,
+                                        G_context.tx_info.staging,
+                                        sizeof(G_context.tx_info.staging));
+#endif
+    return cx_keccak_init_no_throw(&G_context.tx_info.sha3, 256) == CX_OK;
+}
+
+// Keep the summary of a transaction of a batch, then expect the next one or review the batch
+static int processBatchTransaction(void) {
+    batch_ctx_t *batch = &G_context.tx_info.batch;
+
+    if (!batch_add(batch, &G_context.tx_info.transaction, G_context.tx_info.m_hash)) {
+        explicit_bzero(&G_context, sizeof(G_context));
+        return io_send_sw(SW_TX_NOT_BATCHABLE);
+    }
+    if (batch->received < batch->count) {
+        if (!startTransaction(false)) {
+            explicit_bzero(&G_context, sizeof(G_context));
+            return io_send_sw(SW_TX_HASH_FAIL);
+        }
+        return io_send_sw(SW_OK);
+    }
+    G_context.state = STATE_PARSED;
+    return ui_display_batch();
+}
+
+int handler_sign_tx(buffer_t *cdata,
+                    uint8_t chunk,
+                    bool more,
+                    bool fee_payer,
+                    bool multi_path,
+                    bool batch) {
+    if (chunk == 0) {  // first APDU, parse BIP32 paths
+        // A batch is kept from the start of its review until its last signature is sent
+        if (G_context.req_type == CONFIRM_TRANSACTION && G_context.tx_info.batch.count != 0 &&
+            G_context.state != STATE_NONE) {
+            return io_send_sw(SW_BAD_STATE);
+        }
         explicit_bzero(&G_context, sizeof(G_context));
         G_context.req_type = CONFIRM_TRANSACTION;
         G_context.state = STATE_NONE;
 
-        if (!buffer_read_u8(cdata, &G_context.bip32_path_len) ||
-            !buffer_read_bip32_path(cdata,
-                                    G_context.bip32_path,
-                                    (size_t) G_context.bip32_path_len)) {
+        uint8_t count = 0;
+        if (batch && (!buffer_read_u8(cdata, &count) ||
+                      !batch_init(&G_context.tx_info.batch, count))) {
+            return io_send_sw(SW_WRONG_DATA_LENGTH);
+        }
+        if (!readPaths(cdata, multi_path)) {
             return io_send_sw(SW_WRONG_DATA_LENGTH);
         }
 
+        if (!startTransaction(fee_payer)) {
+            return io_send_sw(SW_TX_HASH_FAIL);
+        }
+
         return io_send_sw(SW_OK);
 
     } else {  // parse transaction
 
-        if (G_context.req_type != CONFIRM_TRANSACTION) {
+        // Once the last chunk is received the hash is final and reviewed, no chunk may follow
+        if (G_context.req_type != CONFIRM_TRANSACTION || G_context.state != STATE_NONE ||
+            G_context.tx_info.parser_ctx.complete) {
             return io_send_sw(SW_BAD_STATE);
         }
-        if (G_context.tx_info.raw_tx_len + cdata->size > sizeof(G_context.tx_info.raw_tx)) {
+        PRINTF("TX CHUNK: %.*H\n", cdata->size, cdata->ptr);
+#ifdef HAVE_STREAMING_SIGN_TX
+        // The chunk is parsed and hashed in place then dropped, only the parser state is kept
+        if (G_context.tx_info.raw_tx_len + cdata->size < G_context.tx_info.raw_tx_len) {
+            explicit_bzero(&G_context, sizeof(G_context));
             return io_send_sw(SW_WRONG_TX_LENGTH);
         }
-        PRINTF("TX CHUNK: %.*H\n", cdata->size, cdata->ptr);
-        if (!buffer_move(cdata,
-                         G_context.tx_info.raw_tx + G_context.tx_info.raw_tx_len,
-                         cdata->size)) {
-            return io_send_sw(SW_TX_PARSING_FAIL);
+        buffer_t buf = {.ptr = cdata->ptr, .size = cdata->size, .offset = 0};
+        G_context.tx_info.raw_tx_len += buf.size;
+#else
+        buffer_t buf = {.ptr = cdata->ptr, .size = cdata->size, .offset = 0};
+        // The access list and the hashed data are skipped, their chunks are parsed in place and
+        // not retained
+        if (transaction_deserialize_retains_chunk(&G_context.tx_info.parser_ctx, cdata->size)) {
+            if (G_context.tx_info.raw_tx_len + cdata->size > sizeof(G_context.tx_info.raw_tx)) {
+                explicit_bzero(&G_context, sizeof(G_context));
+                return io_send_sw(SW_WRONG_TX_LENGTH);
+            }
+            buf.ptr = G_context.tx_info.raw_tx + G_context.tx_info.raw_tx_len;
+            if (!buffer_move(cdata, (uint8_t *) buf.ptr, cdata->size)) {
+                explicit_bzero(&G_context, sizeof(G_context));
+                return io_send_sw(SW_TX_PARSING_FAIL);
+            }
+            G_context.tx_info.raw_tx_len += buf.size;
         }
-        G_context.tx_info.raw_tx_len += cdata->size;
+#endif
         PRINTF("Raw TX Len: %d\n", G_context.tx_info.raw_tx_len);
 
+        // Hash the chunk while the next one is in transit, the digest is produced with the last
+        if (cx_hash_no_throw((cx_hash_t *) &G_context.tx_info.sha3,
+                             more ? 0 : CX_LAST,
+                             buf.ptr,
+                             buf.size,
+                             more ? NULL : G_context.tx_info.m_hash,
+                             more ? 0 : sizeof(G_context.tx_info.m_hash)) != CX_OK) {
+            explicit_bzero(&G_context, sizeof(G_context));
+            return io_send_sw(SW_TX_HASH_FAIL);
+        }
+
+        // Resume the parsing with this chunk so that a malformed transaction is rejected
+        // as soon as the faulty field is received.
+        parser_status_e status =
+            transaction_deserialize_chunk(&G_context.tx_info.parser_ctx, &buf, !more);
+        PRINTF("Parsing status: %d.\n", status);
+        if (status != PARSING_OK && status != PARSING_PROCESSING) {
+            // Drop the context so that the following chunks are refused
+            explicit_bzero(&G_context, sizeof(G_context));
+            return io_send_sw(SW_TX_PARSING_FAIL);
+        }
+
         if (more) {
             // more APDUs with transaction part are expected.
             // Send a SW_OK to signal that we have received the chunk
             return io_send_sw(SW_OK);
 
         } else {
-            // last APDU for this transaction, let's parse, display and request a sign confirmation
-
-            buffer_t buf = {.ptr = G_context.tx_info.raw_tx,
-                            .size = G_context.tx_info.raw_tx_len,
-                            .offset = 0};
-
-            // print buffer
-            PRINTF("Raw TX: %.*H\n", buf.size, buf.ptr);
-            // print buffer size
-            PRINTF("Raw TX size: %d\n", buf.size);
+            // last APDU for this transaction, the parsing is complete,
+            // let's display and request a sign confirmation
+            PRINTF("Hash: %.*H\n", sizeof(G_context.tx_info.m_hash), G_context.tx_info.m_hash);
 
-            parser_status_e status = transaction_deserialize(&buf, &G_context.tx_info.transaction);
-            PRINTF("Parsing status: %d.\n", status);
-            if (status != PARSING_OK) {
-                return io_send_sw(SW_TX_PARSING_FAIL);
+            if (G_context.tx_info.batch.count != 0) {
+                return processBatchTransaction();
             }
-
             G_context.state = STATE_PARSED;
 
-            if (cx_keccak_256_hash(G_context.tx_info.raw_tx,
-                                   G_context.tx_info.raw_tx_len,
-                                   G_context.tx_info.m_hash) != CX_OK) {
-                return io_send_sw(SW_TX_HASH_FAIL);
-            }
-
-            PRINTF("Hash: %.*H\n", sizeof(G_context.tx_info.m_hash), G_context.tx_info.m_hash);
-
             return ui_display_transaction();
         }
     }
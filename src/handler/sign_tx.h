@@ -6,11 +6,11 @@
 #include "buffer.h"
 
 /**
- * Handler for SIGN_TX command. If successfully parse BIP32 path
- * and transaction, sign transaction and send APDU response.
+ * Handler for SIGN_TX command. If successfully parse BIP32 paths
+ * and transaction, sign transaction with each path and send APDU response.
  *
- * @see G_context.bip32_path, G_context.tx_info.raw_transaction,
- * G_context.tx_info.signature and G_context.tx_info.v.
+ * @see G_context.tx_info.paths, G_context.tx_info.raw_transaction,
+ * G_context.tx_info.r, G_context.tx_info.s and G_context.tx_info.v.
  *
  * @param[in,out] cdata
  *   Command data with BIP32 path and raw transaction serialized.
@@ -18,8 +18,21 @@
  *   Index number of the APDU chunk.
  * @param[in]       more
  *   Whether more APDU chunk to be received or not.
+ * @param[in]       fee_payer
+ *   Whether the fee payer signature preimage is signed, only read on the first chunk.
+ * @param[in]       multi_path
+ *   Whether the first chunk holds a list of BIP32 paths, preceded by their number.
+ * @param[in]       batch
+ *   Whether the first chunk starts a batch, with its number of transactions before the BIP32
+ *   path. The transactions follow one after the other, more is false on the last chunk of
+ *   each one, and the batch is reviewed once all are received.
  *
  * @return zero or positive integer if success, negative integer otherwise.
  *
  */
-int handler_sign_tx(buffer_t *cdata, uint8_t chunk, bool more);
+int handler_sign_tx(buffer_t *cdata,
+                    uint8_t chunk,
+                    bool more,
+                    bool fee_payer,
+                    bool multi_path,
+                    bool batch);
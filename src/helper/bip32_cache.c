@@ -0,0 +1,299 @@
+/*****************************************************************************
+ *   Ledger App Kaia.
+ *   (c) 2024 Blooo SAS.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *****************************************************************************/
+
+#include <stdbool.h>  // bool
+#include <stdint.h>   // uint*_t
+#include <string.h>   // memcmp, memcpy, explicit_bzero
+
+#include "os.h"
+#include "cx.h"
+#include "bip32.h"
+
+#include "bip32_cache.h"
+
+#define HARDENED_INDEX       0x80000000
+#define UNCOMPRESSED_KEY_LEN 65
+
+/**
+ * Extended node cached between derivations.
+ */
+typedef struct {
+    uint32_t path[MAX_BIP32_PATH];              /// path of the node
+    uint8_t path_len;                           /// length of the path, 0 if the node is empty
+    uint8_t private_key[BIP32_KEY_LEN];         /// private key of the node
+    uint8_t chain_code[BIP32_KEY_LEN];          /// chain code of the node
+    uint8_t public_key[COMPRESSED_PUBKEY_LEN];  /// compressed public key of the node
+} bip32_node_t;
+
+// Kept between APDUs, out of G_context which every command resets: the node of the hardened
+// prefix of the last path, and the parent node of the last path when it has normal indices
+static bip32_node_t G_hardened_node;
+static bip32_node_t G_parent_node;
+
+// Order of the secp256k1 group
+static const uint8_t SECP256K1_N[BIP32_KEY_LEN] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfe,
+    0xba, 0xae, 0xdc, 0xe6, 0xaf, 0x48, 0xa0, 0x3b, 0xbf, 0xd2, 0x5e, 0x8c, 0xd0, 0x36, 0x41, 0x41};
+
+void bip32_cache_wipe(void) {
+    explicit_bzero(&G_hardened_node, sizeof(G_hardened_node));
+    explicit_bzero(&G_parent_node, sizeof(G_parent_node));
+}
+
+// Check whether a node is the one of the first indices of a path
+static bool node_matches(const bip32_node_t *node, const uint32_t *path, size_t len) {
+    return node->path_len == len && memcmp(node->path, path, len * sizeof(path[0])) == 0;
+}
+
+// Keep a node in the cache
+static void store_node(bip32_node_t *node,
+                       const uint32_t *path,
+                       size_t len,
+                       const uint8_t private_key[static BIP32_KEY_LEN],
+                       const uint8_t chain_code[static BIP32_KEY_LEN],
+                       const uint8_t public_key[static COMPRESSED_PUBKEY_LEN]) {
+    memcpy(node->path, path, len * sizeof(path[0]));
+    node->path_len = len;
+    memcpy(node->private_key, private_key, BIP32_KEY_LEN);
+    memcpy(node->chain_code, chain_code, BIP32_KEY_LEN);
+    memcpy(node->public_key, public_key, COMPRESSED_PUBKEY_LEN);
+}
+
+// Number of leading hardened indices of a path, 0 if a hardened index follows a normal one
+static size_t hardened_prefix_len(const uint32_t *path, size_t path_len) {
+    size_t len = 0;
+
+    while (len < path_len && (path[len] & HARDENED_INDEX) != 0) {
+        len++;
+    }
+    for (size_t i = len; i < path_len; i++) {
+        if ((path[i] & HARDENED_INDEX) != 0) {
+            return 0;
+        }
+    }
+    return len;
+}
+
+// Compute the public key of a private key, uncompressed
+static cx_err_t public_key_of(const uint8_t *private_key,
+                              uint8_t public_key[static UNCOMPRESSED_KEY_LEN]) {
+    cx_ecfp_private_key_t private;
+    cx_ecfp_public_key_t public;
+    cx_err_t error;
+
+    CX_CHECK(cx_ecfp_init_private_key_no_throw(CX_CURVE_256K1,
+                                               private_key,
+                                               BIP32_KEY_LEN,
+                                               &private));
+    CX_CHECK(cx_ecfp_generate_pair_no_throw(CX_CURVE_256K1, &public, &private, true));
+    memcpy(public_key, public.W, UNCOMPRESSED_KEY_LEN);
+
+end:
+    explicit_bzero(&private, sizeof(private));
+    return error;
+}
+
+void compress_public_key(const uint8_t raw_public_key[static 65],
+                         uint8_t out[static COMPRESSED_PUBKEY_LEN]) {
+    out[0] = (raw_public_key[UNCOMPRESSED_KEY_LEN - 1] & 1) ? 0x03 : 0x02;
+    memcpy(out + 1, raw_public_key + 1, BIP32_KEY_LEN);
+}
+
+// Derive a path from the seed with the SDK, every step included
+static cx_err_t derive_from_seed(const uint32_t *path,
+                                 size_t path_len,
+                                 uint8_t private_key[static BIP32_KEY_LEN],
+                                 uint8_t chain_code[static BIP32_KEY_LEN]) {
+    uint8_t raw_private_key[64];
+    cx_err_t error;
+
+    CX_CHECK(os_derive_bip32_no_throw(CX_CURVE_256K1,
+                                      path,
+                                      path_len,
+                                      raw_private_key,
+                                      chain_code));
+    memcpy(private_key, raw_private_key, BIP32_KEY_LEN);
+
+end:
+    explicit_bzero(raw_private_key, sizeof(raw_private_key));
+    return error;
+}
+
+// Derive the node of a hardened prefix and keep it in the cache
+static cx_err_t fill_hardened_node(const uint32_t *path, size_t prefix_len) {
+    uint8_t private_key[BIP32_KEY_LEN];
+    uint8_t chain_code[BIP32_KEY_LEN];
+    uint8_t public_key[UNCOMPRESSED_KEY_LEN];
+    uint8_t compressed[COMPRESSED_PUBKEY_LEN];
+    cx_err_t error;
+
+    explicit_bzero(&G_hardened_node, sizeof(G_hardened_node));
+    CX_CHECK(derive_from_seed(path, prefix_len, private_key, chain_code));
+    CX_CHECK(public_key_of(private_key, public_key));
+    compress_public_key(public_key, compressed);
+    store_node(&G_hardened_node, path, prefix_len, private_key, chain_code, compressed);
+
+end:
+    explicit_bzero(private_key, sizeof(private_key));
+    return error;
+}
+
+// Private derivation of one non-hardened child, in place (BIP32 CKDpriv)
+static cx_err_t derive_child(uint8_t private_key[static BIP32_KEY_LEN],
+                             uint8_t chain_code[static BIP32_KEY_LEN],
+                             const uint8_t public_key[static COMPRESSED_PUBKEY_LEN],
+                             uint32_t index) {
+    cx_hmac_sha512_t hmac;
+    uint8_t data[COMPRESSED_PUBKEY_LEN + 4];
+    uint8_t digest[2 * BIP32_KEY_LEN];
+    int diff = 0;
+    cx_err_t error;
+
+    memcpy(data, public_key, COMPRESSED_PUBKEY_LEN);
+    U4BE_ENCODE(data, COMPRESSED_PUBKEY_LEN, index);
+    CX_CHECK(cx_hmac_sha512_init_no_throw(&hmac, chain_code, BIP32_KEY_LEN));
+    CX_CHECK(cx_hmac_no_throw((cx_hmac_t *) &hmac,
+                              CX_LAST,
+                              data,
+                              sizeof(data),
+                              digest,
+                              sizeof(digest)));
+
+    // The index is invalid if the left half is not below the group order, or if the key is zero
+    CX_CHECK(cx_math_cmp_no_throw(digest, SECP256K1_N, BIP32_KEY_LEN, &diff));
+    if (diff >= 0) {
+        error = CX_INVALID_PARAMETER;
+        goto end;
+    }
+    CX_CHECK(cx_math_addm_no_throw(private_key, private_key, digest, SECP256K1_N, BIP32_KEY_LEN));
+    if (cx_math_is_zero(private_key, BIP32_KEY_LEN)) {
+        error = CX_INVALID_PARAMETER;
+        goto end;
+    }
+    memcpy(chain_code, digest + BIP32_KEY_LEN, BIP32_KEY_LEN);
+
+end:
+    explicit_bzero(&hmac, sizeof(hmac));
+    explicit_bzero(digest, sizeof(digest));
+    return error;
+}
+
+// Derive the private key and chain code of a path from the closest cached node
+static cx_err_t derive_path(const uint32_t *path,
+                           size_t path_len,
+                           uint8_t private_key[static BIP32_KEY_LEN],
+                           uint8_t chain_code[static BIP32_KEY_LEN]) {
+    uint8_t public_key[UNCOMPRESSED_KEY_LEN];
+    uint8_t compressed[COMPRESSED_PUBKEY_LEN];
+    size_t prefix_len = hardened_prefix_len(path, path_len);
+    size_t parent_len = path_len - 1;
+    const bip32_node_t *start = &G_parent_node;
+    cx_err_t error = CX_OK;
+
+    if (path_len > MAX_BIP32_PATH) {
+        return CX_INVALID_PARAMETER;
+    }
+    // The OS does not notify the app of a lock, the node is only used while the PIN is validated
+    if (os_global_pin_is_validated() != BOLOS_TRUE) {
+        bip32_cache_wipe();
+        return CX_INTERNAL_ERROR;
+    }
+    // Nothing to share without a hardened prefix followed by normal indices only
+    if (prefix_len == 0) {
+        return derive_from_seed(path, path_len, private_key, chain_code);
+    }
+    // Consecutive indices under one parent only derive their last step
+    if (parent_len <= prefix_len || !node_matches(&G_parent_node, path, parent_len)) {
+        if (!node_matches(&G_hardened_node, path, prefix_len)) {
+            CX_CHECK(fill_hardened_node(path, prefix_len));
+        }
+        start = &G_hardened_node;
+    }
+
+    memcpy(private_key, start->private_key, BIP32_KEY_LEN);
+    memcpy(chain_code, start->chain_code, BIP32_KEY_LEN);
+    memcpy(compressed, start->public_key, COMPRESSED_PUBKEY_LEN);
+    for (size_t i = start->path_len; i < path_len; i++) {
+        // Normal derivation hashes the parent public key, the cached one for the first step
+        if (i > start->path_len) {
+            CX_CHECK(public_key_of(private_key, public_key));
+            compress_public_key(public_key, compressed);
+        }
+        if (i == parent_len && start != &G_parent_node) {
+            store_node(&G_parent_node, path, parent_len, private_key, chain_code, compressed);
+        }
+        CX_CHECK(derive_child(private_key, chain_code, compressed, path[i]));
+    }
+
+end:
+    if (error != CX_OK) {
+        explicit_bzero(private_key, BIP32_KEY_LEN);
+    }
+    return error;
+}
+
+cx_err_t bip32_cache_get_pubkey(const uint32_t *path,
+                                size_t path_len,
+                                uint8_t raw_public_key[static 65],
+                                uint8_t *chain_code) {
+    uint8_t private_key[BIP32_KEY_LEN];
+    uint8_t child_chain_code[BIP32_KEY_LEN];
+    cx_err_t error;
+
+    CX_CHECK(derive_path(path, path_len, private_key, child_chain_code));
+    CX_CHECK(public_key_of(private_key, raw_public_key));
+    if (chain_code != NULL) {
+        memcpy(chain_code, child_chain_code, BIP32_KEY_LEN);
+    }
+
+end:
+    explicit_bzero(private_key, sizeof(private_key));
+    return error;
+}
+
+cx_err_t bip32_cache_sign_hash(const uint32_t *path,
+                               size_t path_len,
+                               const uint8_t *hash,
+                               size_t hash_len,
+                               uint8_t r[static BIP32_KEY_LEN],
+                               uint8_t s[static BIP32_KEY_LEN],
+                               uint32_t *info) {
+    uint8_t raw_private_key[BIP32_KEY_LEN];
+    uint8_t chain_code[BIP32_KEY_LEN];
+    cx_ecfp_private_key_t private_key;
+    cx_err_t error;
+
+    CX_CHECK(derive_path(path, path_len, raw_private_key, chain_code));
+    CX_CHECK(cx_ecfp_init_private_key_no_throw(CX_CURVE_256K1,
+                                               raw_private_key,
+                                               BIP32_KEY_LEN,
+                                               &private_key));
+    CX_CHECK(cx_ecdsa_sign_rs_no_throw(&private_key,
+                                       CX_RND_RFC6979 | CX_LAST,
+                                       CX_SHA256,
+                                       hash,
+                                       hash_len,
+                                       BIP32_KEY_LEN,
+                                       r,
+                                       s,
+                                       info));
+
+end:
+    explicit_bzero(raw_private_key, sizeof(raw_private_key));
+    explicit_bzero(&private_key, sizeof(private_key));
+    return error;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <stddef.h>  // size_t
+#include <stdint.h>  // uint*_t
+
+#include "cx.h"
+
+/**
+ * Length of a secp256k1 private key and of a BIP32 chain code.
+ */
+#define BIP32_KEY_LEN 32
+
+/**
+ * Length of a compressed secp256k1 public key.
+ */
+#define COMPRESSED_PUBKEY_LEN 33
+
+/**
+ * Derive the public key and chain code of a BIP32 path on secp256k1.
+ *
+ * The extended node of the longest hardened prefix of the path is kept in RAM, so that the
+ * following paths sharing this prefix only derive their non-hardened steps. The parent node of
+ * the path is kept as well, consecutive indices under one parent only derive their last step.
+ *
+ * @param[in] path BIP32 path.
+ * @param[in] path_len Number of indices of the path.
+ * @param[out] raw_public_key Uncompressed public key, 65 bytes.
+ * @param[out] chain_code Chain code, 32 bytes, may be NULL.
+ * @return CX_OK on success, an error code otherwise.
+ */
+cx_err_t bip32_cache_get_pubkey(const uint32_t *path,
+                                size_t path_len,
+                                uint8_t raw_public_key[static 65],
+                                uint8_t *chain_code);
+
+/**
+ * Sign a hash with ECDSA on secp256k1 with the key of a BIP32 path.
+ *
+ * The key is derived as in bip32_cache_get_pubkey(), the signature is deterministic (RFC 6979).
+ *
+ * @param[in] path BIP32 path.
+ * @param[in] path_len Number of indices of the path.
+ * @param[in] hash Hash to sign.
+ * @param[in] hash_len Length of the hash.
+ * @param[out] r r value of the signature, 32 bytes big endian.
+ * @param[out] s s value of the signature, 32 bytes big endian.
+ * @param[out] info Parity of the signature point (CX_ECCINFO_*).
+ * @return CX_OK on success, an error code otherwise.
+ */
+cx_err_t bip32_cache_sign_hash(const uint32_t *path,
+                               size_t path_len,
+                               const uint8_t *hash,
+                               size_t hash_len,
+                               uint8_t r[static BIP32_KEY_LEN],
+                               uint8_t s[static BIP32_KEY_LEN],
+                               uint32_t *info);
+
+/**
+ * Compress a public key.
+ *
+ * @param[in] raw_public_key Uncompressed public key, 65 bytes.
+ * @param[out] out Compressed public key: 02 or 03 from the parity of y, then x.
+ */
+void compress_public_key(const uint8_t raw_public_key[static 65],
+                         uint8_t out[static COMPRESSED_PUBKEY_LEN]);
+
+/**
+ * Wipe the cached node, on app exit or when the device is no longer unlocked.
+ */
+void bip32_cache_wipe(void);
@@ -18,236 +18,135 @@
 #include <stdbool.h>  // bool
 #include <stddef.h>   // size_t
 #include <stdint.h>   // uint*_t
-#include <string.h>   // memcpy
-#include <stdio.h>    // snprintf
-
-#ifndef strlcpy
-#include "strlcpy.h"
-#endif
+#include <string.h>   // memmove
 
 #include "format.h"
+#include "uint256.h"
 #include "../transaction/types.h"
 
-bool format_transaction_type(transaction_type_e txType, char *out, size_t out_len) {
-    switch (txType) {
-        case VALUE_TRANSFER:
-            if (snprintf(out, out_len, "Value Transfer")) {
-                return false;
-            };
-            break;
-        case FEE_DELEGATED_VALUE_TRANSFER:
-            if (snprintf(out, out_len, "Fee Delegated Value Transfer")) {
-                return false;
-            };
-            break;
-        case PARTIAL_FEE_DELEGATED_VALUE_TRANSFER:
-            if (snprintf(out, out_len, "Partial Fee Delegated Value Transfer")) {
-                return false;
-            };
-            break;
-        case VALUE_TRANSFER_MEMO:
-            if (snprintf(out, out_len, "Value Transfer Memo")) {
-                return false;
-            };
-            break;
-        case FEE_DELEGATED_VALUE_TRANSFER_MEMO:
-            if (snprintf(out, out_len, "Fee Delegated Value Transfer Memo")) {
-                return false;
-            };
-            break;
-        case PARTIAL_FEE_DELEGATED_VALUE_TRANSFER_MEMO:
-            if (snprintf(out, out_len, "Partial Fee Delegated Value Transfer Memo")) {
-                return false;
-            };
-            break;
-        case SMART_CONTRACT_DEPLOY:
-            if (snprintf(out, out_len, "Smart Contract Deploy")) {
-                return false;
-            };
-            break;
-        case FEE_DELEGATED_SMART_CONTRACT_DEPLOY:
-            if (snprintf(out, out_len, "Fee Delegated Smart Contract Deploy")) {
-                return false;
-            };
-            break;
-        case PARTIAL_FEE_DELEGATED_SMART_CONTRACT_DEPLOY:
-            if (snprintf(out, out_len, "Partial Fee Delegated Smart Contract Deploy")) {
-                return false;
-            };
-            break;
-        case SMART_CONTRACT_EXECUTION:
-            if (snprintf(out, out_len, "Smart Contract Execution")) {
-                return false;
-            };
-            break;
-        case FEE_DELEGATED_SMART_CONTRACT_EXECUTION:
-            if (snprintf(out, out_len, "Fee Delegated Smart Contract Execution")) {
-                return false;
-            };
-            break;
-        case PARTIAL_FEE_DELEGATED_SMART_CONTRACT_EXECUTION:
-            if (snprintf(out, out_len, "Partial Fee Delegated Smart Contract Execution")) {
-                return false;
-            };
-            break;
-        case CANCEL:
-            if (snprintf(out, out_len, "Cancel")) {
-                return false;
-            };
-            break;
-        case FEE_DELEGATED_CANCEL:
-            if (snprintf(out, out_len, "Fee Delegated Cancel")) {
-                return false;
-            };
-            break;
-        case PARTIAL_FEE_DELEGATED_CANCEL:
-            if (snprintf(out, out_len, "Partial Fee Delegated Cancel")) {
-                return false;
-            };
-            break;
-        case LEGACY:
-            if (snprintf(out, out_len, "Legacy")) {
-                return false;
-            };
-            break;
-        default:
-            return false;
+// Decimal string written backwards from the end of the caller's buffer, the least significant
+// digit first. The trailing zeroes of the fraction are skipped, and the decimal point is inserted
+// once the fraction is written.
+typedef struct {
+    char *pos;          // first character written
+    const char *start;  // start of the buffer
+    uint32_t digits;    // digits received, including the skipped zeroes
+    uint8_t decimals;   // digits of the fraction
+    bool fraction;      // a non-zero digit of the fraction was written
+} decimal_writer_t;
+
+static bool put_char(decimal_writer_t *writer, char c) {
+    if (writer->pos == writer->start) {
+        return false;
     }
+    *--writer->pos = c;
     return true;
 }
 
-bool amount_to_string(const uint256_t amount,
-                      uint8_t decimals,
-                      char *out_buffer,
-                      size_t out_buffer_size) {
-    char tmp_buffer[100] = {0};
-
-    if (uint256_to_decimal(amount, tmp_buffer, sizeof(tmp_buffer)) == false) {
-        return false;
+static bool put_digit(decimal_writer_t *writer, uint32_t digit) {
+    if (writer->digits < writer->decimals) {
+        writer->digits++;
+        if (digit == 0 && !writer->fraction) {
+            return true;
+        }
+        writer->fraction = true;
+        return put_char(writer, '0' + digit);
     }
-
-    uint8_t amount_len = strnlen(tmp_buffer, sizeof(tmp_buffer));
-
-    if (adjustDecimals(tmp_buffer, amount_len, out_buffer, out_buffer_size - 1, decimals) ==
-        false) {
+    if (writer->digits == writer->decimals && writer->fraction && !put_char(writer, '.')) {
         return false;
     }
+    writer->digits++;
+    return put_char(writer, '0' + digit);
+}
 
-    out_buffer[out_buffer_size - 1] = '\0';
-    return true;
-};
-
-bool adjustDecimals(const char *src,
-                    size_t srcLength,
-                    char *target,
-                    size_t targetLength,
-                    uint8_t decimals) {
-    uint32_t startOffset;
-    uint32_t lastZeroOffset = 0;
-    uint32_t offset = 0;
-    if ((srcLength == 1) && (*src == '0')) {
-        if (targetLength < 2) {
+// Write the 9 digits of a chunk, or only its significant ones for the most significant chunk
+static bool put_chunk(decimal_writer_t *writer, uint32_t chunk, bool last) {
+    for (int i = 0; i < 9; i++) {
+        if (last && chunk == 0 && i != 0) {
+            return true;
+        }
+        if (!put_digit(writer, chunk % 10)) {
             return false;
         }
-        target[0] = '0';
-        target[1] = '\0';
-        return true;
+        chunk /= 10;
     }
-    if (srcLength <= decimals) {
-        uint32_t delta = decimals - srcLength;
-        if (targetLength < srcLength + 1 + 2 + delta) {
+    return true;
+}
+
+static bool put_u64(decimal_writer_t *writer, uint64_t value) {
+    while (value >= UINT256_1E9) {
+        if (!put_chunk(writer, value % UINT256_1E9, false)) {
             return false;
         }
-        target[offset++] = '0';
-        target[offset++] = '.';
-        for (uint32_t i = 0; i < delta; i++) {
-            target[offset++] = '0';
+        value /= UINT256_1E9;
+    }
+    return put_chunk(writer, (uint32_t) value, true);
+}
+
+// Write an integer then complete its fraction and integer part, and move it to the start of the
+// buffer. Fields of up to 8 bytes are converted with 64 bits arithmetic, larger ones are divided
+// by 10^9 until they fit in 64 bits.
+static bool write_decimal(const uint256_view_t *value,
+                          uint8_t decimals,
+                          char *out,
+                          size_t out_len) {
+    decimal_writer_t writer = {.pos = out + out_len - 1, .start = out, .decimals = decimals};
+
+    if (out_len == 0 || value->length > MAX_INT256) {
+        return false;
+    }
+    *writer.pos = '\0';
+
+    if (value->length <= sizeof(uint64_t)) {
+        uint64_t small = 0;
+        for (uint8_t i = 0; i < value->length; i++) {
+            small = (small << 8) | value->value[i];
         }
-        startOffset = offset;
-        for (uint32_t i = 0; i < srcLength; i++) {
-            target[offset++] = src[i];
+        if (!put_u64(&writer, small)) {
+            return false;
         }
-        target[offset] = '\0';
     } else {
-        uint32_t sourceOffset = 0;
-        uint32_t delta = srcLength - decimals;
-        if (targetLength < srcLength + 1 + 1) {
+        u256_t large;
+        uint8_t limbs;
+        if (!u256_from_view(&large, value)) {
             return false;
         }
-        while (offset < delta) {
-            target[offset++] = src[sourceOffset++];
-        }
-        if (decimals != 0) {
-            target[offset++] = '.';
-        }
-        startOffset = offset;
-        while (sourceOffset < srcLength) {
-            target[offset++] = src[sourceOffset++];
-        }
-        target[offset] = '\0';
-    }
-    for (uint32_t i = startOffset; i < offset; i++) {
-        if (target[i] == '0') {
-            if (lastZeroOffset == 0) {
-                lastZeroOffset = i;
+        limbs = u256_limbs(&large);
+        while (limbs > 2) {
+            if (!put_chunk(&writer, u256_divmod_1e9_limbs(&large, &limbs), false)) {
+                return false;
             }
-        } else {
-            lastZeroOffset = 0;
         }
-    }
-    if (lastZeroOffset != 0) {
-        target[lastZeroOffset] = '\0';
-        if (target[lastZeroOffset - 1] == '.') {
-            target[lastZeroOffset - 1] = '\0';
-        }
-    }
-    return true;
-}
-
-bool uint256_to_decimal(const uint256_t value, char *out, size_t out_len) {
-    if (value.length > MAX_INT256) {
-        // value length is bigger than MAX_INT256 ?!
-        return false;
-    }
-
-    uint16_t n[16] = {0};
-    // Copy and right-align the number
-    memcpy((uint8_t *) n + MAX_INT256 - value.length, value.value, value.length);
-
-    // Special case when value is 0
-    if (allzeroes(n, MAX_INT256)) {
-        if (out_len < 2) {
-            // Not enough space to hold "0" and \0.
+        if (!put_u64(&writer, ((uint64_t) large.limbs[1] << 32) | large.limbs[0])) {
             return false;
         }
-        strlcpy(out, "0", out_len);
-        return true;
     }
 
-    uint16_t *p = n;
-    for (int i = 0; i < 16; i++) {
-        n[i] = __builtin_bswap16(*p++);
-    }
-    int pos = out_len;
-    while (!allzeroes(n, sizeof(n))) {
-        if (pos == 0) {
+    // Leading zeroes of the fraction, then the integer part of an amount lower than 1
+    while (writer.digits < decimals) {
+        if (!put_digit(&writer, 0)) {
             return false;
         }
-        pos -= 1;
-        unsigned int carry = 0;
-        for (int i = 0; i < 16; i++) {
-            int rem = ((carry << 16) | n[i]) % 10;
-            n[i] = ((carry << 16) | n[i]) / 10;
-            carry = rem;
-        }
-        out[pos] = '0' + carry;
     }
-    memmove(out, out + pos, out_len - pos);
-    out[out_len - pos] = 0;
+    if (writer.digits == decimals && !put_digit(&writer, 0)) {
+        return false;
+    }
+    memmove(out, writer.pos, out + out_len - writer.pos);
     return true;
 }
 
-uint64_t convertUint256ToUint64(const uint256_t *bytes) {
+bool amount_to_string(const uint256_view_t amount,
+                      uint8_t decimals,
+                      char *out_buffer,
+                      size_t out_buffer_size) {
+    return write_decimal(&amount, decimals, out_buffer, out_buffer_size);
+}
+
+bool uint256_to_decimal(const uint256_view_t value, char *out, size_t out_len) {
+    return write_decimal(&value, 0, out, out_len);
+}
+
+uint64_t convertUint256ToUint64(const uint256_view_t *bytes) {
     uint64_t result = 0;
     for (int i = 0; i < bytes->length && i < 8; i++) {
         result <<= 8;  // Shift existing value left by 8 bits
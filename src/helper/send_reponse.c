@@ -24,6 +24,7 @@
 #include "cx.h"
 
 #include "send_response.h"
+#include "bip32_cache.h"
 #include "../constants.h"
 #include "../globals.h"
 #include "../address.h"
@@ -110,37 +111,51 @@ int helper_send_response_pubkey() {
     return io_send_response_pointer(resp, offset, SW_OK);
 }
 
-void format_signature_out(const uint8_t *signature, uint8_t *out) {
-    uint8_t offset = 1;
-    uint8_t xoffset = 4;  // point to r value
-    // copy r
-    uint8_t xlength = signature[xoffset - 1];
-    if (xlength == 33) {
-        xlength = 32;
-        xoffset++;
-    }
-    memmove(out + offset + 32 - xlength, signature + xoffset, xlength);
-    offset += 32;
-    xoffset += xlength + 2;  // move over rvalue and TagLEn
-    // copy s value
-    xlength = signature[xoffset - 1];
-    if (xlength == 33) {
-        xlength = 32;
-        xoffset++;
-    }
-    memmove(out + offset + 32 - xlength, signature + xoffset, xlength);
+int helper_send_response_xpub() {
+    uint8_t resp[XPUB_RESPONSE_LEN] = {0};
+    uint32_t child_number = G_context.bip32_path[G_context.bip32_path_len - 1];
+    size_t offset = 0;
+
+    resp[offset++] = G_context.bip32_path_len;
+    memmove(resp + offset, G_context.pk_info.parent_fingerprint, 4);
+    offset += 4;
+    U4BE_ENCODE(resp, offset, child_number);
+    offset += 4;
+    memmove(resp + offset, G_context.pk_info.chain_code, CHAINCODE_LEN);
+    offset += CHAINCODE_LEN;
+    compress_public_key(G_context.pk_info.raw_public_key, resp + offset);
+    offset += COMPRESSED_PUBKEY_LEN;
+
+    return io_send_response_pointer(resp, offset, SW_OK);
 }
 
-int helper_send_response_sig() {
-    uint8_t resp[1 + MAX_DER_SIG_LEN + 1] = {0};
-    size_t offset = 0;
+size_t helper_format_sig(uint8_t *out, size_t out_len) {
+    uint8_t v[MAX_V_LEN];
+    uint8_t v_len;
+
+    if (G_context.tx_info.transaction.txType == EIP2930 ||
+        G_context.tx_info.transaction.txType == EIP1559) {
+        // Typed transactions carry the y parity alone (EIP-2930)
+        v[0] = G_context.tx_info.v;
+        v_len = 1;
+    } else {
+        v_len = transaction_utils_eip155_v(&G_context.tx_info.transaction.chainID,
+                                           G_context.tx_info.v,
+                                           v);
+    }
+    if (v_len == 0 || out_len < 1 + (size_t) v_len + 64) {
+        return 0;
+    }
 
-    uint32_t v_out = u32_from_BE(G_context.tx_info.transaction.chainID.value,
-                                 MIN(4, G_context.tx_info.transaction.chainID.length));
-    resp[offset++] = (v_out * 2) + 35 + G_context.tx_info.v;
+    out[0] = v_len;
+    memmove(out + 1, v, v_len);
+    memmove(out + 1 + v_len, G_context.tx_info.r, 32);
+    memmove(out + 1 + v_len + 32, G_context.tx_info.s, 32);
+    PRINTF("Signature out: %.*H\n", 1 + v_len + 64, out);
 
-    format_signature_out(G_context.tx_info.signature, resp);
-    PRINTF("Signature out: %.*H\n", 64, resp + 1);
+    return 1 + v_len + 64;
+}
 
-    return io_send_response_pointer(resp, 65, SW_OK);
+int helper_send_response_sig(const uint8_t *records, size_t len) {
+    return io_send_response_pointer(records, len, SW_OK);
 }
@@ -44,17 +44,63 @@
 int helper_send_response_pubkey(void);
 
 /**
- * Helper to send APDU response with signature and v (parity of
- * y-coordinate of R).
+ * Length of an extended public key response.
+ */
+#define XPUB_RESPONSE_LEN (1 + 4 + 4 + CHAINCODE_LEN + 33)
+
+/**
+ * Helper to send APDU response with the extended public key of a hardened path, serialized as
+ * in BIP32 without its version and checksum.
+ *
+ * response = depth (1) ||
+ *            G_context.pk_info.parent_fingerprint (4) ||
+ *            child number (4) ||
+ *            G_context.pk_info.chain_code (CHAINCODE_LEN) ||
+ *            compressed public key (33)
+ *
+ * @return zero or positive integer if success, -1 otherwise.
+ *
+ */
+int helper_send_response_xpub(void);
+
+/**
+ * Maximum number of signature records in one response.
+ */
+#define MAX_RESPONSE_SIGS 3
+
+/**
+ * Helper to write the signature record of the last signing path, with v and the r and s values
+ * of G_context.tx_info. v is chainId * 2 + 35 + parity of y-coordinate of R (EIP-155), or the
+ * parity alone on typed transactions, big endian without leading zeroes.
+ *
+ * record = len(v) (1) || v (len(v)) || r (32) || s (32)
+ *
+ * @param[out] out
+ *   Output buffer.
+ * @param[in] out_len
+ *   Size of the output buffer.
+ *
+ * @return length of the record, 0 if it does not fit in the output buffer.
+ *
+ */
+size_t helper_format_sig(uint8_t *out, size_t out_len);
+
+/**
+ * Helper to send APDU response with the signature records of every signing path.
+ *
+ * response = record of the first path ||
+ *            ... ||
+ *            record of the last path
  *
- * response = G_context.tx_info.signature_len (1) ||
- *            G_context.tx_info.signature (G_context.tx_info.signature_len) ||
- *            G_context.tx_info.v (1)
+ * @param[in] records
+ *   Signature records, in the order of the paths.
+ * @param[in] len
+ *   Length of the records.
  *
  * @return zero or positive integer if success, -1 otherwise.
  *
  */
-int helper_send_response_sig(void);
+int helper_send_response_sig(const uint8_t *records, size_t len);
 
 /**
  * Converts a binary Ethereum address to a string representation.
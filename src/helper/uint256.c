@@ -0,0 +1,126 @@
+/*****************************************************************************
+ *   Ledger App Kaia.
+ *   (c) 2024 Blooo SAS.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *****************************************************************************/
+
+#include <stdbool.h>  // bool
+#include <stdint.h>   // uint*_t
+#include <string.h>   // memcpy, memset
+
+#include "uint256.h"
+
+bool u256_from_view(u256_t *out, const uint256_view_t *view) {
+    memset(out, 0, sizeof(*out));
+    if (view->length > MAX_INT256) {
+        return false;
+    }
+    // The last byte of the field is the least significant one
+    for (uint32_t i = 0; i < view->length; i++) {
+        uint32_t bit = 8 * (view->length - 1 - i);
+        out->limbs[bit / 32] |= (uint32_t) view->value[i] << (bit % 32);
+    }
+    return true;
+}
+
+void u256_to_bytes(const u256_t *in, uint8_t *out) {
+    for (uint32_t i = 0; i < MAX_INT256; i++) {
+        uint32_t bit = 8 * (MAX_INT256 - 1 - i);
+        out[i] = (uint8_t) (in->limbs[bit / 32] >> (bit % 32));
+    }
+}
+
+bool u256_is_zero(const u256_t *a) {
+    uint32_t bits = 0;
+    for (int i = 0; i < UINT256_LIMBS; i++) {
+        bits |= a->limbs[i];
+    }
+    return bits == 0;
+}
+
+uint8_t u256_limbs(const u256_t *a) {
+    uint8_t limbs = UINT256_LIMBS;
+    while (limbs != 0 && a->limbs[limbs - 1] == 0) {
+        limbs--;
+    }
+    return limbs;
+}
+
+int u256_cmp(const u256_t *a, const u256_t *b) {
+    for (int i = UINT256_LIMBS - 1; i >= 0; i--) {
+        if (a->limbs[i] != b->limbs[i]) {
+            return a->limbs[i] < b->limbs[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+bool u256_add(u256_t *r, const u256_t *a, const u256_t *b) {
+    uint64_t carry = 0;
+    for (int i = 0; i < UINT256_LIMBS; i++) {
+        carry += (uint64_t) a->limbs[i] + b->limbs[i];
+        r->limbs[i] = (uint32_t) carry;
+        carry >>= 32;
+    }
+    return carry == 0;
+}
+
+bool u256_mul(u256_t *r, const u256_t *a, const u256_t *b) {
+    uint32_t product[UINT256_LIMBS] = {0};
+
+    // Schoolbook, each partial product and its carries fit in 64 bits
+    for (int i = 0; i < UINT256_LIMBS; i++) {
+        if (a->limbs[i] == 0) {
+            continue;
+        }
+        uint64_t carry = 0;
+        for (int j = 0; j < UINT256_LIMBS; j++) {
+            if (i + j >= UINT256_LIMBS) {
+                if (b->limbs[j] != 0) {
+                    return false;
+                }
+                continue;
+            }
+            carry += (uint64_t) a->limbs[i] * b->limbs[j] + product[i + j];
+            product[i + j] = (uint32_t) carry;
+            carry >>= 32;
+        }
+        if (carry != 0) {
+            return false;
+        }
+    }
+    memcpy(r->limbs, product, sizeof(product));
+    return true;
+}
+
+uint32_t u256_divmod_1e9(u256_t *q, const u256_t *a) {
+    uint8_t limbs = u256_limbs(a);
+
+    *q = *a;
+    return u256_divmod_1e9_limbs(q, &limbs);
+}
+
+uint32_t u256_divmod_1e9_limbs(u256_t *a, uint8_t *limbs) {
+    uint64_t remainder = 0;
+    for (int i = *limbs - 1; i >= 0; i--) {
+        remainder = (remainder << 32) | a->limbs[i];
+        a->limbs[i] = (uint32_t) (remainder / UINT256_1E9);
+        remainder %= UINT256_1E9;
+    }
+    // The quotient loses at most one limb
+    if (*limbs != 0 && a->limbs[*limbs - 1] == 0) {
+        (*limbs)--;
+    }
+    return (uint32_t) remainder;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <stdbool.h>  // bool
+#include <stdint.h>   // uint*_t
+
+#include "../transaction/types.h"
+
+/**
+ * Number of 32 bits limbs of a 256 bits integer.
+ */
+#define UINT256_LIMBS 8
+
+/**
+ * Largest power of 10 that fits in a limb, the divisor of u256_divmod_1e9().
+ */
+#define UINT256_1E9 1000000000U
+
+/**
+ * 256 bits unsigned integer for the arithmetic of the review, as native 32 bits limbs.
+ */
+typedef struct {
+    uint32_t limbs[UINT256_LIMBS];  /// limbs, least significant first
+} u256_t;
+
+/**
+ * Loads a big endian integer field.
+ *
+ * @param out The loaded integer.
+ * @param view The big endian field, up to MAX_INT256 bytes.
+ * @return Returns true if the field fits, false otherwise.
+ */
+bool u256_from_view(u256_t *out, const uint256_view_t *view);
+
+/**
+ * Stores an integer as MAX_INT256 big endian bytes.
+ *
+ * @param in The integer to store.
+ * @param out The output buffer, of MAX_INT256 bytes.
+ */
+void u256_to_bytes(const u256_t *in, uint8_t *out);
+
+/**
+ * Checks if an integer is zero.
+ *
+ * @param a The integer to check.
+ * @return Returns true if the integer is zero, false otherwise.
+ */
+bool u256_is_zero(const u256_t *a);
+
+/**
+ * Counts the significant limbs of an integer.
+ *
+ * @param a The integer.
+ * @return Returns the index of its most significant non-zero limb plus one, 0 for zero.
+ */
+uint8_t u256_limbs(const u256_t *a);
+
+/**
+ * Compares two integers.
+ *
+ * @param a The first integer.
+ * @param b The second integer.
+ * @return Returns -1, 0 or 1 if a is lower than, equal to or greater than b.
+ */
+int u256_cmp(const u256_t *a, const u256_t *b);
+
+/**
+ * Adds two integers, r may alias a or b.
+ *
+ * @param r The sum, undefined on overflow.
+ * @param a The first integer.
+ * @param b The second integer.
+ * @return Returns true if the sum fits in 256 bits, false otherwise.
+ */
+bool u256_add(u256_t *r, const u256_t *a, const u256_t *b);
+
+/**
+ * Multiplies two integers, r may alias a or b.
+ *
+ * @param r The product, undefined on overflow.
+ * @param a The first integer.
+ * @param b The second integer.
+ * @return Returns true if the product fits in 256 bits, false otherwise.
+ */
+bool u256_mul(u256_t *r, const u256_t *a, const u256_t *b);
+
+/**
+ * Divides an integer by 10^9, the largest power of 10 that fits in a limb. q may alias a.
+ *
+ * @param q The quotient.
+ * @param a The dividend.
+ * @return Returns the remainder, lower than 10^9.
+ */
+uint32_t u256_divmod_1e9(u256_t *q, const u256_t *a);
+
+/**
+ * Divides an integer by 10^9 in place, over its significant limbs only, for the repeated
+ * divisions of a decimal conversion whose cost shrinks along with the number.
+ *
+ * @param a The dividend, replaced by the quotient.
+ * @param limbs The significant limbs of the dividend, from u256_limbs(), lowered to those of
+ * the quotient.
+ * @return Returns the remainder, lower than 10^9.
+ */
+uint32_t u256_divmod_1e9_limbs(u256_t *a, uint8_t *limbs);
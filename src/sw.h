@@ -56,6 +56,26 @@
  * Status word for fail to display fee ratio.
  */
 #define SW_DISPLAY_FEERATIO_FAIL 0xB00D
+/**
+ * Status word for fail to display the access list.
+ */
+#define SW_DISPLAY_ACCESS_LIST_FAIL 0xB00F
+/**
+ * Status word for fail to display the token call.
+ */
+#define SW_DISPLAY_TOKEN_FAIL 0xB010
+/**
+ * Status word for fail to display the data size or hash.
+ */
+#define SW_DISPLAY_DATA_FAIL 0xB011
+/**
+ * Status word for fail to display the memo.
+ */
+#define SW_DISPLAY_MEMO_FAIL 0xB012
+/**
+ * Status word for fail to display the network fee or total cost.
+ */
+#define SW_DISPLAY_FEE_FAIL 0xB013
 /**
  * Status word for fail to display amount.
  */
@@ -84,3 +104,16 @@
  * Status word for fail to compute address.
  */
 #define SW_ADDRESS_FAIL 0xB009
+/**
+ * Status word for a transaction refused in a batch.
+ */
+#define SW_TX_NOT_BATCHABLE 0xB014
+/**
+ * Status word for a range of address indices out of the normal indices.
+ */
+#define SW_WRONG_INDEX_RANGE 0xB015
+/**
+ * Status word for an extended public key requested for a path with normal indices, or for a
+ * path of less than 3 indices whose parent cannot be derived.
+ */
+#define SW_WRONG_ACCOUNT_PATH 0xB016
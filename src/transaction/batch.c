@@ -0,0 +1,111 @@
+/*****************************************************************************
+ *   Ledger App Kaia.
+ *   (c) 2024 Blooo SAS.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *****************************************************************************/
+
+#include <string.h>  // memcmp, memcpy, memset
+
+#include "batch.h"
+
+bool batch_init(batch_ctx_t *batch, uint8_t count) {
+    memset(batch, 0, sizeof(*batch));
+    if (count == 0 || count > MAX_BATCH_TXS) {
+        return false;
+    }
+    batch->count = count;
+    return true;
+}
+
+// The review of the batch only shows amounts, recipients and fees, nothing else may be signed
+static bool isBatchable(const transaction_t *tx) {
+    static const uint8_t ZERO_ADDRESS[ADDRESS_LEN] = {0};
+
+    switch (tx->txType) {
+        case LEGACY:
+        case EIP2930:
+        case EIP1559:
+        case VALUE_TRANSFER:
+            break;
+        default:
+            return false;
+    }
+    return !tx->feePayerSignature && tx->dataSize == 0 && tx->accessListCount == 0 &&
+           tx->nonce.length <= sizeof(uint64_t) && tx->toLength == ADDRESS_LEN &&
+           memcmp(tx->to, ZERO_ADDRESS, ADDRESS_LEN) != 0;
+}
+
+// Add the value and the network fee of a transaction to the totals of the batch
+static bool addTotals(batch_ctx_t *batch, const transaction_t *tx, batch_entry_t *entry) {
+    u256_t gasPrice;
+    u256_t gasLimit;
+    u256_t value;
+
+    if (!u256_from_view(&gasPrice, &tx->gasprice) || !u256_from_view(&gasLimit, &tx->startgas) ||
+        !u256_from_view(&value, &tx->value)) {
+        return false;
+    }
+    if (!u256_mul(&gasPrice, &gasPrice, &gasLimit) ||
+        !u256_add(&batch->totalFee, &batch->totalFee, &gasPrice) ||
+        !u256_add(&batch->totalValue, &batch->totalValue, &value)) {
+        return false;
+    }
+    u256_to_bytes(&value, entry->value);
+    return true;
+}
+
+bool batch_add(batch_ctx_t *batch, const transaction_t *tx, const uint8_t *hash) {
+    if (batch->received >= batch->count || !isBatchable(tx)) {
+        return false;
+    }
+    if (batch->received == 0) {
+        batch->txType = tx->txType;
+        batch->chainIDLength = tx->chainID.length;
+        if (tx->chainID.length != 0) {
+            memcpy(batch->chainID, tx->chainID.value, tx->chainID.length);
+        }
+    } else if (tx->txType != batch->txType || tx->chainID.length != batch->chainIDLength ||
+               (tx->chainID.length != 0 &&
+                memcmp(tx->chainID.value, batch->chainID, tx->chainID.length) != 0)) {
+        return false;
+    }
+
+    batch_entry_t *entry = &batch->entries[batch->received];
+    if (!addTotals(batch, tx, entry)) {
+        return false;
+    }
+    memcpy(entry->to, tx->to, ADDRESS_LEN);
+    entry->nonce = 0;
+    for (uint8_t i = 0; i < tx->nonce.length; i++) {
+        entry->nonce = (entry->nonce << 8) | tx->nonce.value[i];
+    }
+    memcpy(entry->hash, hash, BATCH_HASH_LEN);
+    batch->received++;
+    return true;
+}
+
+uint8_t batch_recipients(const batch_ctx_t *batch) {
+    uint8_t recipients = 0;
+
+    for (uint8_t i = 0; i < batch->received; i++) {
+        uint8_t j = 0;
+        while (j < i && memcmp(batch->entries[j].to, batch->entries[i].to, ADDRESS_LEN) != 0) {
+            j++;
+        }
+        if (j == i) {
+            recipients++;
+        }
+    }
+    return recipients;
+}
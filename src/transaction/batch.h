@@ -0,0 +1,83 @@
+/**
+ * @file batch.h
+ * @brief Summaries of the transactions of a batch, reviewed and approved together.
+ *
+ * The transactions of a batch are parsed and hashed one after the other. Only the summary and
+ * the hash of each one are kept, and the batch is reviewed once from its totals.
+ */
+
+#pragma once
+
+#include <stdbool.h>  // bool
+#include <stdint.h>   // uint*_t
+
+#include "types.h"
+#include "../helper/uint256.h"
+
+/**
+ * Maximum number of transactions of a batch.
+ */
+#define MAX_BATCH_TXS 20
+
+/**
+ * Length of the hash of a transaction.
+ */
+#define BATCH_HASH_LEN 32
+
+/**
+ * @brief Summary of a transaction of a batch.
+ */
+typedef struct {
+    uint8_t to[ADDRESS_LEN];       /// recipient address
+    uint8_t value[MAX_INT256];     /// value, big endian
+    uint64_t nonce;                /// nonce
+    uint8_t hash[BATCH_HASH_LEN];  /// hash of the transaction, signed once the batch is approved
+} batch_entry_t;
+
+/**
+ * @brief State of a batch, kept across its transactions.
+ */
+typedef struct {
+    batch_entry_t entries[MAX_BATCH_TXS];  /// summaries of the transactions received
+    uint8_t count;                         /// number of transactions, 0 outside of a batch
+    uint8_t received;                      /// number of transactions received
+    uint8_t sent;                          /// number of signatures sent
+    transaction_type_e txType;             /// type of every transaction
+    uint8_t chainID[MAX_INT256];           /// chain ID of every transaction, big endian
+    uint8_t chainIDLength;                 /// length of the chain ID
+    u256_t totalValue;                     /// sum of the values
+    u256_t totalFee;                       /// sum of the gas prices times the gas limits
+} batch_ctx_t;
+
+/**
+ * Start a batch.
+ *
+ * @param[out] batch Batch state.
+ * @param[in] count Number of transactions, from 1 to MAX_BATCH_TXS.
+ * @return True on success, false if the number of transactions is out of range.
+ */
+bool batch_init(batch_ctx_t *batch, uint8_t count);
+
+/**
+ * Add a parsed transaction to the batch.
+ *
+ * Only value transfers without data are accepted: legacy, EIP-2930 and EIP-1559 transactions
+ * with an empty access list, and Kaia value transfers. Every transaction of the batch has the
+ * type and the chain ID of the first one, a recipient of 20 bytes other than the zero address
+ * (a contract creation has an empty recipient), and a nonce of at most 64 bits.
+ *
+ * @param[in, out] batch Batch state.
+ * @param[in] tx Parsed transaction, in sender signing mode.
+ * @param[in] hash Hash of the transaction, of BATCH_HASH_LEN bytes.
+ * @return True on success, false if the transaction is not accepted, the batch is complete, or
+ * the totals overflow 256 bits.
+ */
+bool batch_add(batch_ctx_t *batch, const transaction_t *tx, const uint8_t *hash);
+
+/**
+ * Count the distinct recipients of the transactions received.
+ *
+ * @param[in] batch Batch state.
+ * @return Number of distinct recipients.
+ */
+uint8_t batch_recipients(const batch_ctx_t *batch);
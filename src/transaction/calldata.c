@@ -0,0 +1,188 @@
+/*****************************************************************************
+ *   Ledger App Kaia.
+ *   (c) 2024 Blooo SAS.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *****************************************************************************/
+
+#include <stddef.h>  // NULL
+
+#include "calldata.h"
+
+// Bytes of zero padding before an address in its 32 bytes word
+#define ADDRESS_PADDING (CALLDATA_WORD_LEN - ADDRESS_LEN)
+
+// Sorted by selector for the binary search
+static const calldata_method_t METHODS[] = {
+    // approve(address spender, uint256 amount)
+    {0x095ea7b3, TOKEN_APPROVE, 2, false, {CALLDATA_ARG_TO, CALLDATA_ARG_VALUE}},
+    // transferFrom(address from, address to, uint256 amount)
+    {0x23b872dd,
+     TOKEN_TRANSFER_FROM,
+     3,
+     false,
+     {CALLDATA_ARG_FROM, CALLDATA_ARG_TO, CALLDATA_ARG_VALUE}},
+    // safeTransfer(address to, uint256 amount)
+    {0x423f6cef, TOKEN_SAFE_TRANSFER, 2, false, {CALLDATA_ARG_TO, CALLDATA_ARG_VALUE}},
+    // safeTransferFrom(address from, address to, uint256 amountOrTokenId)
+    {0x42842e0e,
+     TOKEN_SAFE_TRANSFER_FROM,
+     3,
+     false,
+     {CALLDATA_ARG_FROM, CALLDATA_ARG_TO, CALLDATA_ARG_VALUE}},
+    // transfer(address to, uint256 amount)
+    {0xa9059cbb, TOKEN_TRANSFER, 2, false, {CALLDATA_ARG_TO, CALLDATA_ARG_VALUE}},
+    // safeTransferFrom(address from, address to, uint256 amountOrTokenId, bytes data)
+    {0xb88d4fde,
+     TOKEN_SAFE_TRANSFER_FROM,
+     4,
+     true,
+     {CALLDATA_ARG_FROM, CALLDATA_ARG_TO, CALLDATA_ARG_VALUE, CALLDATA_ARG_OFFSET}},
+    // safeTransfer(address to, uint256 amount, bytes data)
+    {0xeb795549,
+     TOKEN_SAFE_TRANSFER,
+     3,
+     true,
+     {CALLDATA_ARG_TO, CALLDATA_ARG_VALUE, CALLDATA_ARG_OFFSET}},
+};
+
+const calldata_method_t *calldata_lookup(uint32_t selector) {
+    size_t low = 0;
+    size_t high = sizeof(METHODS) / sizeof(METHODS[0]);
+
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        const calldata_method_t *method = &METHODS[middle];
+        if (method->selector == selector) {
+            return method;
+        }
+        if (method->selector < selector) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return NULL;
+}
+
+// Decode one byte of a static argument, return false if the calldata is not a token call
+static bool decodeArgByte(const calldata_method_t *method,
+                          transaction_t *tx,
+                          uint32_t argPos,
+                          uint8_t byte) {
+    uint32_t word = argPos / CALLDATA_WORD_LEN;
+    uint32_t offset = argPos % CALLDATA_WORD_LEN;
+
+    switch (method->args[word]) {
+        case CALLDATA_ARG_FROM:
+        case CALLDATA_ARG_TO:
+            // Addresses are left padded with zeroes
+            if (offset < ADDRESS_PADDING) {
+                return byte == 0;
+            }
+            if (method->args[word] == CALLDATA_ARG_FROM) {
+                tx->tokenFrom[offset - ADDRESS_PADDING] = byte;
+            } else {
+                tx->tokenTo[offset - ADDRESS_PADDING] = byte;
+            }
+            return true;
+        case CALLDATA_ARG_VALUE:
+            tx->tokenValue[offset] = byte;
+            return true;
+        case CALLDATA_ARG_OFFSET:
+            // The bytes argument is the only dynamic one, its length word follows the static ones
+            if (offset < CALLDATA_WORD_LEN - 1) {
+                return byte == 0;
+            }
+            return byte == method->words * CALLDATA_WORD_LEN;
+        default:
+            return false;
+    }
+}
+
+// Decode one byte of the length word of the bytes argument, return false if it is too large
+static bool decodeBytesLengthByte(calldata_decoder_t *decoder, uint32_t offset, uint8_t byte) {
+    if (offset < CALLDATA_WORD_LEN - sizeof(decoder->bytesLength)) {
+        return byte == 0;
+    }
+    decoder->bytesLength = (decoder->bytesLength << 8) | byte;
+    return true;
+}
+
+void calldata_feed(calldata_decoder_t *decoder,
+                   transaction_t *tx,
+                   const uint8_t *data,
+                   uint32_t length) {
+    uint32_t pos = decoder->pos;
+
+    decoder->pos += length;
+    for (uint32_t i = 0; i < length && !decoder->invalid; i++, pos++) {
+        if (pos < CALLDATA_SELECTOR_LEN) {
+            decoder->selector = (decoder->selector << 8) | data[i];
+            if (pos == CALLDATA_SELECTOR_LEN - 1) {
+                decoder->method = calldata_lookup(decoder->selector);
+                decoder->invalid = decoder->method == NULL;
+            }
+            continue;
+        }
+        uint32_t argPos = pos - CALLDATA_SELECTOR_LEN;
+        uint32_t staticSize = decoder->method->words * CALLDATA_WORD_LEN;
+        if (argPos < staticSize) {
+            decoder->invalid = !decodeArgByte(decoder->method, tx, argPos, data[i]);
+        } else if (!decoder->method->dynamic) {
+            // Nothing may follow the static arguments
+            decoder->invalid = true;
+        } else if (argPos - staticSize < CALLDATA_WORD_LEN) {
+            decoder->invalid = !decodeBytesLengthByte(decoder, argPos - staticSize, data[i]);
+        } else {
+            // The content of the bytes argument is only hashed, its size is checked at the end
+            break;
+        }
+    }
+}
+
+void calldata_finish(const calldata_decoder_t *decoder, transaction_t *tx) {
+    tx->tokenCall = TOKEN_CALL_NONE;
+    tx->tokenBytes = false;
+    if (decoder->invalid || decoder->method == NULL) {
+        return;
+    }
+    uint64_t length = CALLDATA_SELECTOR_LEN + decoder->method->words * CALLDATA_WORD_LEN;
+    if (decoder->method->dynamic) {
+        // Length word, then the content padded to a whole word
+        length += CALLDATA_WORD_LEN + ((uint64_t) decoder->bytesLength + CALLDATA_WORD_LEN - 1) /
+                                          CALLDATA_WORD_LEN * CALLDATA_WORD_LEN;
+    }
+    if (decoder->pos != length) {
+        return;
+    }
+    tx->tokenCall = decoder->method->call;
+    tx->tokenBytes = decoder->method->dynamic;
+}
+
+const char *calldata_method_name(token_call_e call) {
+    switch (call) {
+        case TOKEN_TRANSFER:
+            return "transfer";
+        case TOKEN_APPROVE:
+            return "approve";
+        case TOKEN_TRANSFER_FROM:
+            return "transferFrom";
+        case TOKEN_SAFE_TRANSFER:
+            return "safeTransfer";
+        case TOKEN_SAFE_TRANSFER_FROM:
+            return "safeTransferFrom";
+        default:
+            return NULL;
+    }
+}
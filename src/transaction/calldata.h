@@ -0,0 +1,92 @@
+/**
+ * @file calldata.h
+ * @brief Streaming decoding of the token calls of smart contract executions.
+ *
+ * The calldata is decoded as its bytes pass through the parser, the selector and the static
+ * arguments are written to transaction_t without buffering the field.
+ */
+
+#pragma once
+
+#include <stdbool.h>  // bool
+#include <stdint.h>   // uint*_t
+
+#include "types.h"
+
+#define CALLDATA_SELECTOR_LEN 4
+#define CALLDATA_WORD_LEN     32
+#define CALLDATA_MAX_WORDS    4
+
+/**
+ * @brief Role of a 32 bytes argument of a token call.
+ */
+typedef enum {
+    CALLDATA_ARG_FROM,   /// address, token owner
+    CALLDATA_ARG_TO,     /// address, token recipient or spender
+    CALLDATA_ARG_VALUE,  /// uint256, token amount or ID
+    CALLDATA_ARG_OFFSET  /// offset of the bytes argument, right after the static arguments
+} calldata_arg_e;
+
+/**
+ * @brief Known token method, selected by the first 4 bytes of the calldata.
+ */
+typedef struct {
+    uint32_t selector;                 /// selector, big endian
+    token_call_e call;                 /// token call
+    uint8_t words;                     /// number of static arguments
+    bool dynamic;                      /// a dynamic argument follows the static ones
+    uint8_t args[CALLDATA_MAX_WORDS];  /// calldata_arg_e role of each static argument
+} calldata_method_t;
+
+/**
+ * @brief State of the calldata decoding, kept in the parser context between chunks.
+ */
+typedef struct {
+    uint32_t pos;                     /// calldata bytes received
+    uint32_t selector;                /// selector received so far
+    const calldata_method_t *method;  /// method of the selector, NULL until it is known
+    uint32_t bytesLength;             /// length of the bytes argument of a dynamic method
+    bool invalid;                     /// calldata is not a known token call
+} calldata_decoder_t;
+
+/**
+ * Look up a token method by its selector.
+ *
+ * @param[in] selector Selector, big endian.
+ * @return Known method, NULL if the selector is unknown.
+ */
+const calldata_method_t *calldata_lookup(uint32_t selector);
+
+/**
+ * Decode the next bytes of the calldata.
+ *
+ * @param[in, out] decoder Decoding state, zeroed before the first bytes.
+ * @param[out] tx Transaction receiving the arguments.
+ * @param[in] data Calldata bytes.
+ * @param[in] length Number of bytes.
+ */
+void calldata_feed(calldata_decoder_t *decoder,
+                   transaction_t *tx,
+                   const uint8_t *data,
+                   uint32_t length);
+
+/**
+ * Complete the decoding once the whole calldata is received.
+ *
+ * tx->tokenCall is set when the calldata is a known token call of the expected length whose
+ * address arguments are well formed, TOKEN_CALL_NONE otherwise. The bytes argument of a dynamic
+ * method must be ABI encoded right after the static arguments, its content padded to a whole
+ * word being the end of the calldata, tx->tokenBytes is then set.
+ *
+ * @param[in] decoder Decoding state.
+ * @param[out] tx Transaction receiving the token call.
+ */
+void calldata_finish(const calldata_decoder_t *decoder, transaction_t *tx);
+
+/**
+ * Get the method name of a token call, as displayed.
+ *
+ * @param[in] call Token call.
+ * @return Method name, NULL for TOKEN_CALL_NONE.
+ */
+const char *calldata_method_name(token_call_e call);
@@ -0,0 +1,31 @@
+/*****************************************************************************
+ *   Ledger App Kaia.
+ *   (c) 2024 Blooo SAS.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *****************************************************************************/
+
+#include "data_hash.h"
+
+bool data_hash_init(data_hash_t *hash) {
+    return cx_keccak_init_no_throw(hash, 256) == CX_OK;
+}
+
+bool data_hash_update(data_hash_t *hash, const uint8_t *data, uint32_t length) {
+    return cx_hash_no_throw((cx_hash_t *) hash, 0, data, length, NULL, 0) == CX_OK;
+}
+
+bool data_hash_final(data_hash_t *hash, uint8_t *digest) {
+    return cx_hash_no_throw((cx_hash_t *) hash, CX_LAST, NULL, 0, digest, DATA_HASH_LEN) ==
+           CX_OK;
+}
@@ -0,0 +1,56 @@
+/**
+ * @file data_hash.h
+ * @brief Streaming Keccak-256 of the data field of a transaction.
+ *
+ * The data is hashed as its chunks pass through the parser, so that its digest can be displayed
+ * without retaining it. The device uses the cx Keccak-256, the host builds link the portable one
+ * of unit-tests/keccak.c.
+ */
+
+#pragma once
+
+#include <stdbool.h>  // bool
+#include <stdint.h>   // uint*_t
+
+#include "types.h"
+
+#if defined(TEST)
+/**
+ * @brief Keccak-256 sponge state of the host build, see unit-tests/keccak.c.
+ */
+typedef struct {
+    uint64_t state[25];  /// Keccak-f[1600] state, as 64 bits little endian lanes
+    uint32_t pos;        /// bytes absorbed in the current block
+} data_hash_t;
+#else
+#include "cx.h"
+
+typedef cx_sha3_t data_hash_t;
+#endif
+
+/**
+ * Start a new hash.
+ *
+ * @param[out] hash Hash state.
+ * @return True on success, false otherwise.
+ */
+bool data_hash_init(data_hash_t *hash);
+
+/**
+ * Absorb the next bytes of the data.
+ *
+ * @param[in, out] hash Hash state.
+ * @param[in] data Data bytes.
+ * @param[in] length Number of bytes.
+ * @return True on success, false otherwise.
+ */
+bool data_hash_update(data_hash_t *hash, const uint8_t *data, uint32_t length);
+
+/**
+ * Produce the digest of the data absorbed since data_hash_init().
+ *
+ * @param[in, out] hash Hash state.
+ * @param[out] digest Keccak-256 digest, of DATA_HASH_LEN bytes.
+ * @return True on success, false otherwise.
+ */
+bool data_hash_final(data_hash_t *hash, uint8_t *digest);
@@ -21,285 +21,406 @@
 #include "deserialize.h"
 #include "utils.h"
 #include "types.h"
-#include "process_txs.h"
-#include "process_rlp_fields.h"
+#include "registry.h"
 
 #if defined(TEST)
 #include "assert.h"
-#include <stdio.h>  // printf
 #define LEDGER_ASSERT(x, y) assert(x)
-#define PRINTF              printf
+// Host builds trace on stdout, unless built as the I/O free parser core
+#if defined(TX_PARSER_NO_TRACE)
+#define PRINTF(...)
+#else
+#include <stdio.h>  // printf
+#define PRINTF printf
+#endif
 #else
 #include "ledger_assert.h"
 #endif
 
-#ifndef PRINTF
-#endif
 // RLP related
 
-bool rlpDecodeLength(uint8_t *buffer, uint32_t *fieldLength, uint32_t *offset, bool *list) {
-    if (*buffer <= 0x7f) {
-        *offset = 0;
-        *fieldLength = 1;
-        *list = false;
-    } else if (*buffer <= 0xb7) {
-        *offset = 1;
-        *fieldLength = *buffer - 0x80;
-        *list = false;
-    } else if (*buffer <= 0xbf) {
-        *offset = 1 + (*buffer - 0xb7);
-        *list = false;
-        switch (*buffer) {
-            case 0xb8:
-                *fieldLength = *(buffer + 1);
-                break;
-            case 0xb9:
-                *fieldLength = (*(buffer + 1) << 8) + *(buffer + 2);
-                break;
-            case 0xba:
-                *fieldLength = (*(buffer + 1) << 16) + (*(buffer + 2) << 8) + *(buffer + 3);
-                break;
-            case 0xbb:
-                *fieldLength = (*(buffer + 1) << 24) + (*(buffer + 2) << 16) +
-                               (*(buffer + 3) << 8) + *(buffer + 4);
-                break;
-            default:
-                return false;  // arbitrary 32 bits length limitation
-        }
-    } else if (*buffer <= 0xf7) {
-        *offset = 1;
-        *fieldLength = *buffer - 0xc0;
-        *list = true;
-    } else {
-        *offset = 1 + (*buffer - 0xf7);
-        *list = true;
-        switch (*buffer) {
-            case 0xf8:
-                *fieldLength = *(buffer + 1);
-                break;
-            case 0xf9:
-                *fieldLength = (*(buffer + 1) << 8) + *(buffer + 2);
-                break;
-            case 0xfa:
-                *fieldLength = (*(buffer + 1) << 16) + (*(buffer + 2) << 8) + *(buffer + 3);
-                break;
-            case 0xfb:
-                *fieldLength = (*(buffer + 1) << 24) + (*(buffer + 2) << 16) +
-                               (*(buffer + 3) << 8) + *(buffer + 4);
-                break;
-            default:
-                return false;  // arbitrary 32 bits length limitation
-        }
+/**
+ * Decoding of an RLP prefix byte.
+ */
+typedef struct {
+    uint8_t headerLength;  /// prefix and length bytes, 0 when the byte encodes itself
+    uint8_t lengthBytes;   /// number of big endian length bytes after the prefix
+    uint8_t immediate;     /// length encoded in the prefix byte itself
+    uint8_t flags;         /// RLP_PREFIX_* flags
+} rlp_prefix_t;
+
+#define RLP_PREFIX_LIST    0x01
+#define RLP_PREFIX_INVALID 0x02  // arbitrary 32 bits length limitation
+
+#define RLP_SINGLE(b)      {0, 0, 1, 0}
+#define RLP_SHORT_STR(b)   {1, 0, (b) - 0x80, 0}
+#define RLP_LONG_STR(b)    {1 + (b) - 0xb7, (b) - 0xb7, 0, 0}
+#define RLP_SHORT_LIST(b)  {1, 0, (b) - 0xc0, RLP_PREFIX_LIST}
+#define RLP_LONG_LIST(b)   {1 + (b) - 0xf7, (b) - 0xf7, 0, RLP_PREFIX_LIST}
+#define RLP_TOO_LONG(b)    {0, 0, 0, RLP_PREFIX_INVALID}
+#define RLP_X4(m, b)       m(b), m((b) + 1), m((b) + 2), m((b) + 3)
+#define RLP_X8(m, b)       RLP_X4(m, b), RLP_X4(m, (b) + 4)
+#define RLP_X16(m, b)      RLP_X8(m, b), RLP_X8(m, (b) + 8)
+#define RLP_X32(m, b)      RLP_X16(m, b), RLP_X16(m, (b) + 16)
+#define RLP_X64(m, b)      RLP_X32(m, b), RLP_X32(m, (b) + 32)
+#define RLP_X56(m, b)      RLP_X32(m, b), RLP_X16(m, (b) + 32), RLP_X8(m, (b) + 48)
+
+// Class of every prefix byte, indexed by the byte value
+static const rlp_prefix_t RLP_PREFIX[256] = {RLP_X64(RLP_SINGLE, 0x00),
+                                             RLP_X64(RLP_SINGLE, 0x40),
+                                             RLP_X56(RLP_SHORT_STR, 0x80),
+                                             RLP_X4(RLP_LONG_STR, 0xb8),
+                                             RLP_X4(RLP_TOO_LONG, 0xbc),
+                                             RLP_X56(RLP_SHORT_LIST, 0xc0),
+                                             RLP_X4(RLP_LONG_LIST, 0xf8),
+                                             RLP_X4(RLP_TOO_LONG, 0xfc)};
+
+// Decode a complete header, the prefix class has already been checked
+static uint32_t rlpHeaderLength(const rlp_prefix_t *prefix, const uint8_t *header) {
+    uint32_t length = prefix->immediate;
+    for (uint8_t i = 1; i <= prefix->lengthBytes; i++) {
+        length = (length << 8) | header[i];
     }
+    return length;
+}
 
+bool rlpDecodeLength(uint8_t *buffer, uint32_t *fieldLength, uint32_t *offset, bool *list) {
+    const rlp_prefix_t *prefix = &RLP_PREFIX[*buffer];
+    if ((prefix->flags & RLP_PREFIX_INVALID) != 0) {
+        return false;
+    }
+    *offset = prefix->headerLength;
+    *fieldLength = rlpHeaderLength(prefix, buffer);
+    *list = (prefix->flags & RLP_PREFIX_LIST) != 0;
     return true;
 }
 
 bool rlpCanDecode(uint8_t *buffer, uint32_t bufferLength, bool *valid) {
-    if (*buffer <= 0x7f) {
-    } else if (*buffer <= 0xb7) {
-    } else if (*buffer <= 0xbf) {
-        if (bufferLength < (1 + (*buffer - 0xb7))) {
-            return false;
-        }
-        if (*buffer > 0xbb) {
-            *valid = false;  // arbitrary 32 bits length limitation
-            return true;
-        }
-    } else if (*buffer <= 0xf7) {
-    } else {
-        if (bufferLength < (1 + (*buffer - 0xf7))) {
-            return false;
-        }
-        if (*buffer > 0xfb) {
-            *valid = false;  // arbitrary 32 bits length limitation
-            return true;
-        }
-    }
-    *valid = true;
-    return true;
+    const rlp_prefix_t *prefix = &RLP_PREFIX[*buffer];
+    *valid = (prefix->flags & RLP_PREFIX_INVALID) == 0;
+    return !*valid || bufferLength >= prefix->headerLength;
 }
 
-parser_status_e parseRLP(parser_context_t *parser_ctx) {
-    bool canDecode = false;
-    uint32_t offset;
-    while (parser_ctx->commandLength != 0) {
-        bool valid;
-        // Feed the RLP buffer until the length can be decoded
-        parser_ctx->rlpBuffer[parser_ctx->rlpBufferPos++] = readTxByte(parser_ctx);
-        if (rlpCanDecode(parser_ctx->rlpBuffer, parser_ctx->rlpBufferPos, &valid)) {
-            // Can decode now, if valid
-            if (!valid) {
-                PRINTF("RLP pre-decode error\n");
-                return PARSING_ERROR;
-            }
-            canDecode = true;
-            break;
-        }
-        // Cannot decode yet
-        // Sanity check
-        if (parser_ctx->rlpBufferPos == sizeof(parser_ctx->rlpBuffer)) {
-            PRINTF("RLP pre-decode logic error\n");
-            return PARSING_ERROR;
+// Accumulate in rlpBuffer a header straddling chunks, out of the parseRLP() fast path
+static parser_status_e rlpCarryHeader(parser_context_t *parser_ctx) {
+    if (parser_ctx->rlpBufferPos == 0) {
+        if (parser_ctx->commandLength == 0) {
+            PRINTF("Can't decode\n");
+            return PARSING_PROCESSING;
         }
+        parser_ctx->rlpBuffer[parser_ctx->rlpBufferPos++] = *parser_ctx->workBuffer++;
+        parser_ctx->commandLength--;
     }
-    if (!canDecode) {
+    const rlp_prefix_t *prefix = &RLP_PREFIX[parser_ctx->rlpBuffer[0]];
+    uint32_t missing = MIN(parser_ctx->commandLength,
+                           (uint32_t) prefix->headerLength - parser_ctx->rlpBufferPos);
+    memmove(parser_ctx->rlpBuffer + parser_ctx->rlpBufferPos, parser_ctx->workBuffer, missing);
+    parser_ctx->rlpBufferPos += missing;
+    parser_ctx->workBuffer += missing;
+    parser_ctx->commandLength -= missing;
+    if (parser_ctx->rlpBufferPos < prefix->headerLength) {
         PRINTF("Can't decode\n");
         return PARSING_PROCESSING;
     }
-    // Ready to process this field
-    if (!rlpDecodeLength(parser_ctx->rlpBuffer,
-                         &parser_ctx->currentFieldLength,
-                         &offset,
-                         &parser_ctx->currentFieldIsList)) {
-        PRINTF("RLP decode error\n");
-        return PARSING_ERROR;
+    parser_ctx->rlpBufferPos = 0;
+    return PARSING_CONTINUE;
+}
+
+parser_status_e readRLPHeader(parser_context_t *parser_ctx,
+                              uint32_t *length,
+                              bool *list,
+                              bool *singleByte) {
+    const rlp_prefix_t *prefix;
+    const uint8_t *header;
+
+    if (parser_ctx->rlpBufferPos == 0 && parser_ctx->commandLength != 0) {
+        prefix = &RLP_PREFIX[parser_ctx->workBuffer[0]];
+        if ((prefix->flags & RLP_PREFIX_INVALID) != 0) {
+            PRINTF("RLP pre-decode error\n");
+            return PARSING_ERROR;
+        }
+    } else {
+        prefix = NULL;
     }
-    if (offset == 0) {
-        // Hack for single byte, self encoded
-        parser_ctx->workBuffer--;
-        parser_ctx->commandLength++;
-        parser_ctx->fieldSingleByte = true;
+    if (prefix != NULL && parser_ctx->commandLength >= prefix->headerLength) {
+        // The whole header is in this chunk, decode it in place. A self encoded byte is
+        // left in the buffer as the field content.
+        header = parser_ctx->workBuffer;
+        parser_ctx->workBuffer += prefix->headerLength;
+        parser_ctx->commandLength -= prefix->headerLength;
     } else {
-        parser_ctx->fieldSingleByte = false;
+        // The header straddles the chunk boundary
+        parser_status_e status = rlpCarryHeader(parser_ctx);
+        if (status != PARSING_CONTINUE) {
+            return status;
+        }
+        header = parser_ctx->rlpBuffer;
+        prefix = &RLP_PREFIX[header[0]];
     }
-    parser_ctx->rlpBufferPos = 0;
 
-    if (parser_ctx->outerRLP) {
-        parser_ctx->processingOuterRLPField = true;
-    } else {
-        parser_ctx->currentFieldPos = 0;
-        parser_ctx->processingField = true;
+    *length = rlpHeaderLength(prefix, header);
+    *list = (prefix->flags & RLP_PREFIX_LIST) != 0;
+    *singleByte = prefix->headerLength == 0;
+    return PARSING_CONTINUE;
+}
+
+parser_status_e parseRLP(parser_context_t *parser_ctx) {
+    parser_status_e status = readRLPHeader(parser_ctx,
+                                           &parser_ctx->currentFieldLength,
+                                           &parser_ctx->currentFieldIsList,
+                                           &parser_ctx->fieldSingleByte);
+    if (status != PARSING_CONTINUE) {
+        return status;
     }
+
+    // Ready to process this field
+    parser_ctx->currentFieldPos = 0;
+    parser_ctx->processingField = true;
     return PARSING_CONTINUE;
 }
 
-static void parseNestedRlp(parser_context_t *parser_ctx) {
-    parseRLP(parser_ctx);
-    parseRLP(parser_ctx);
-    parser_ctx->outerRLP = false;
+static bool parsing_is_done(const parser_context_t *parser_ctx) {
+    return parser_ctx->descriptor != NULL &&
+           parser_ctx->currentField == parser_ctx->descriptor->field_count;
 }
 
-parser_status_e transaction_deserialize(buffer_t *buf, transaction_t *tx) {
-    LEDGER_ASSERT(buf != NULL, "NULL buf");
+// Check if a field is absent from the detected transaction flavor and signing mode
+static bool field_is_absent(const parser_context_t *parser_ctx, const tx_field_t *field) {
+    return ((field->flags & TX_FIELD_PARTIAL_ONLY) != 0 &&
+            parser_ctx->descriptor->flavor != PARTIAL_FEE_DELEGATED) ||
+           ((field->flags & TX_FIELD_FEE_PAYER_ONLY) != 0 && !parser_ctx->tx->feePayerSignature);
+}
+
+// Skip the fields that are not part of the detected transaction flavor
+static void skip_absent_fields(parser_context_t *parser_ctx) {
+    const tx_field_t *field;
+    while ((field = tx_registry_field(parser_ctx->descriptor, parser_ctx->currentField)) != NULL &&
+           field_is_absent(parser_ctx, field)) {
+        parser_ctx->currentField++;
+    }
+}
+
+// Decode the transaction envelope in a single forward pass, one RLP header at a time:
+// - legacy: rlp([nonce, gasPrice, gas, to, value, data, chainId, 0, 0])
+// - Kaia:   rlp([encode(rlp([type, nonce, gasPrice, gas, ...])), chainId, 0, 0])
+// - typed:  type || rlp([chainId, nonce, ...]) for EIP-2930 and EIP-1559 (EIP-2718)
+// The legacy nonce is at most 8 bytes (EIP-2681) while the encoded Kaia transaction holds at
+// least its type, nonce, gas price, gas and sender, so the first field length tells them apart.
+// An EIP-2718 type is below 0x80, it reads as a self encoded byte instead of the outer list.
+// Only the fee delegated Kaia transactions have a fee payer preimage.
+static bool processEnvelope(parser_context_t *parser_ctx) {
+    switch (parser_ctx->envelope) {
+        case ENVELOPE_OUTER_LIST:
+            if (parser_ctx->fieldSingleByte && parser_ctx->tx->feePayerSignature) {
+                PRINTF("Typed transactions have no fee payer\n");
+                return true;
+            }
+            if (parser_ctx->fieldSingleByte) {
+                parser_ctx->tx->txType = readTxByte(parser_ctx);
+                PRINTF("Transaction type: %d\n", parser_ctx->tx->txType);
+                if (parser_ctx->tx->txType != EIP2930 && parser_ctx->tx->txType != EIP1559) {
+                    PRINTF("Transaction type %d is not supported\n", parser_ctx->tx->txType);
+                    return true;
+                }
+                parser_ctx->descriptor = tx_registry_lookup(parser_ctx->tx->txType);
+                parser_ctx->envelope = ENVELOPE_TYPED_LIST;
+                break;
+            }
+            if (!parser_ctx->currentFieldIsList) {
+                PRINTF("Invalid transaction envelope\n");
+                return true;
+            }
+            parser_ctx->envelope = ENVELOPE_FIRST_FIELD;
+            break;
+        case ENVELOPE_FIRST_FIELD:
+            if (parser_ctx->currentFieldIsList) {
+                PRINTF("Invalid transaction envelope\n");
+                return true;
+            }
+            if (parser_ctx->currentFieldLength <= MAX_LEGACY_NONCE_LEN &&
+                parser_ctx->tx->feePayerSignature) {
+                PRINTF("Legacy transactions have no fee payer\n");
+                return true;
+            }
+            if (parser_ctx->currentFieldLength <= MAX_LEGACY_NONCE_LEN) {
+                // Legacy nonce, processed as the first field of the transaction
+                parser_ctx->tx->txType = LEGACY;
+                parser_ctx->descriptor = tx_registry_lookup(LEGACY);
+                parser_ctx->envelope = ENVELOPE_DONE;
+                PRINTF("Transaction type: %d\n", parser_ctx->tx->txType);
+                return false;
+            }
+            parser_ctx->dataLength = parser_ctx->currentFieldLength;
+            parser_ctx->envelope = ENVELOPE_KAIA_LIST;
+            break;
+        case ENVELOPE_KAIA_LIST:
+            if (!parser_ctx->currentFieldIsList ||
+                parser_ctx->currentFieldLength >= parser_ctx->dataLength) {
+                PRINTF("Invalid Kaia transaction envelope\n");
+                return true;
+            }
+            // Keep the full length for sanity checks
+            parser_ctx->dataLength = parser_ctx->currentFieldLength;
+            parser_ctx->envelope = ENVELOPE_KAIA_TYPE;
+            break;
+        case ENVELOPE_KAIA_TYPE:
+            // Every Kaia type is below 0x80, it is encoded as a single byte
+            if (!parser_ctx->fieldSingleByte) {
+                PRINTF("Invalid transaction type\n");
+                return true;
+            }
+            parser_ctx->tx->txType = readTxByte(parser_ctx);
+            PRINTF("Transaction type: %d\n", parser_ctx->tx->txType);
+            parser_ctx->descriptor = tx_registry_lookup(parser_ctx->tx->txType);
+            // The Ethereum typed transactions have their own envelope
+            if (parser_ctx->descriptor == NULL || parser_ctx->tx->txType == EIP2930 ||
+                parser_ctx->tx->txType == EIP1559) {
+                PRINTF("Transaction type %d is not supported\n", parser_ctx->tx->txType);
+                return true;
+            }
+            if (parser_ctx->tx->feePayerSignature && parser_ctx->descriptor->flavor == BASIC) {
+                PRINTF("Transaction type %d has no fee payer\n", parser_ctx->tx->txType);
+                return true;
+            }
+            parser_ctx->envelope = ENVELOPE_DONE;
+            break;
+        case ENVELOPE_TYPED_LIST:
+            if (!parser_ctx->currentFieldIsList) {
+                PRINTF("Invalid typed transaction envelope\n");
+                return true;
+            }
+            parser_ctx->envelope = ENVELOPE_DONE;
+            break;
+        default:
+            return true;
+    }
+    // The header was part of the envelope, the next one starts a new field
+    parser_ctx->processingField = false;
+    return false;
+}
+
+void transaction_deserialize_init(parser_context_t *parser_ctx, transaction_t *tx) {
+    LEDGER_ASSERT(parser_ctx != NULL, "NULL parser_ctx");
     LEDGER_ASSERT(tx != NULL, "NULL tx");
 
-    if (buf->size > MAX_TRANSACTION_LEN) {
-        return WRONG_LENGTH_ERROR;
+    // The fields a transaction leaves empty must not keep the values of the previous one
+    memset(parser_ctx, 0, sizeof(*parser_ctx));
+    memset(tx, 0, sizeof(*tx));
+    parser_ctx->currentField = 0;
+    parser_ctx->processingField = false;
+    parser_ctx->envelope = ENVELOPE_OUTER_LIST;
+    parser_ctx->tx = tx;
+}
+
+void transaction_deserialize_set_staging(parser_context_t *parser_ctx,
+                                         uint8_t *staging,
+                                         uint32_t staging_len) {
+    LEDGER_ASSERT(parser_ctx != NULL, "NULL parser_ctx");
+    LEDGER_ASSERT(staging != NULL, "NULL staging");
+
+    parser_ctx->staging = staging;
+    parser_ctx->stagingLength = staging_len;
+    parser_ctx->stagingPos = 0;
+}
+
+void transaction_deserialize_set_fee_payer(parser_context_t *parser_ctx) {
+    LEDGER_ASSERT(parser_ctx != NULL, "NULL parser_ctx");
+
+    parser_ctx->tx->feePayerSignature = true;
+}
+
+bool transaction_deserialize_retains_chunk(const parser_context_t *parser_ctx,
+                                           uint32_t chunk_len) {
+    LEDGER_ASSERT(parser_ctx != NULL, "NULL parser_ctx");
+
+    const tx_field_t *field = tx_registry_field(parser_ctx->descriptor, parser_ctx->currentField);
+    if (field == NULL) {
+        return true;
+    }
+    if ((field->flags & TX_FIELD_UNRETAINED) != 0) {
+        return false;
+    }
+    // The retained chunks stay consecutive: no viewed field spans the dropped one
+    return (field->flags & TX_FIELD_HASHED) == 0 || !parser_ctx->processingField ||
+           parser_ctx->currentFieldLength - parser_ctx->currentFieldPos < chunk_len;
+}
+
+parser_status_e transaction_deserialize_chunk(parser_context_t *parser_ctx,
+                                              buffer_t *buf,
+                                              bool last) {
+    LEDGER_ASSERT(parser_ctx != NULL, "NULL parser_ctx");
+    LEDGER_ASSERT(buf != NULL, "NULL buf");
+
+    if (parser_ctx->complete) {
+        PRINTF("Chunk after the last one\n");
+        return PARSING_ERROR;
     }
-    parser_context_t parser_ctx = {
-        .currentField = RLP_NONE + 1,
-        .processingField = false,
-        .commandLength = buf->size,
-        .workBuffer = buf->ptr,
-        .outerRLP = true,
-        .tx = tx,
-    };
+    parser_ctx->workBuffer = buf->ptr + buf->offset;
+    parser_ctx->commandLength = buf->size - buf->offset;
+    buf->offset = buf->size;
+
     for (;;) {
-        if (PARSING_IS_DONE(parser_ctx)) {
-            return PARSING_OK;
-        }
-        // Old style transaction (pre EIP-155). Transactions could just skip `v,r,s` so we
-        // needed to cut parsing here. commandLength == 0 could happen in two cases :
-        // 1. We are in an old style transaction : just return `PARSING_OK`.
-        // 2. We are at the end of an APDU in a multi-apdu process. This would make us return
-        // `PARSING_OK` preemptively. Case number 2 should NOT happen as it is up to
-        // `ledgerjs` to correctly decrease the size of the APDU (`commandLength`) so that this
-        // situation doesn't happen.
-        if ((parser_ctx.tx->txType == LEGACY && parser_ctx.currentField == LEGACY_RLP_CHAIN_ID) &&
-            (parser_ctx.commandLength == 0)) {
-            tx->chainID.length = 0;
+        if (parsing_is_done(parser_ctx)) {
+            if (parser_ctx->commandLength != 0) {
+                PRINTF("Unexpected data after the transaction\n");
+                return PARSING_ERROR;
+            }
+            parser_ctx->complete = last;
             return PARSING_OK;
         }
-        if (parser_ctx.commandLength == 0) {
-            PRINTF("Command length done\n");
-            return PARSING_PROCESSING;
-        }
-        if (parser_ctx.outerRLP && !parser_ctx.processingOuterRLPField) {
-            parseNestedRlp(&parser_ctx);
-            // Hack to detect the tx type
-            // If the last field parsed was a fieldSingleByte it means the transaction is a Legacy
-            // transaction
-            if (parser_ctx.fieldSingleByte) {
-                parser_ctx.tx->txType = LEGACY;
-            } else {
-                // Save commandLength before calling parseRLP
-                uint32_t rlpStartCommandLength = parser_ctx.commandLength;
-                // The byte after the nested rlp is the tx type,
-                parseRLP(&parser_ctx);
-                parser_ctx.tx->txType = parser_ctx.workBuffer[0];
-                // Return to the start of the nested RLP
-                parser_ctx.workBuffer -= rlpStartCommandLength - parser_ctx.commandLength;
-                parser_ctx.commandLength += rlpStartCommandLength - parser_ctx.commandLength;
-                parser_ctx.processingField = false;
+        if (parser_ctx->commandLength == 0) {
+            if (!last) {
+                // Wait for the next chunk, the parser state is kept in the context.
+                return PARSING_PROCESSING;
             }
-            PRINTF("Transaction type: %d\n", parser_ctx.tx->txType);
-
-            continue;
+            // Old style transaction (pre EIP-155). Transactions could just skip `v,r,s` so we
+            // needed to cut parsing here.
+            const tx_field_t *field =
+                tx_registry_field(parser_ctx->descriptor, parser_ctx->currentField);
+            if (field != NULL && (field->flags & TX_FIELD_END_ALLOWED) != 0 &&
+                !parser_ctx->processingField && parser_ctx->rlpBufferPos == 0) {
+                parser_ctx->tx->chainID.length = 0;
+                parser_ctx->complete = true;
+                return PARSING_OK;
+            }
+            PRINTF("Transaction truncated\n");
+            return PARSING_ERROR;
         }
-        if (!parser_ctx.processingField) {
-            parser_status_e status = parseRLP(&parser_ctx);
+        if (!parser_ctx->processingField) {
+            parser_status_e status = parseRLP(parser_ctx);
             if (status != PARSING_CONTINUE) {
                 return status;
             }
-        }
-
-        PRINTF("Current field: %d\n", parser_ctx.currentField);
-        switch (parser_ctx.tx->txType) {
-            bool fault;
-            case LEGACY:
-                fault = processTxLegacy(&parser_ctx);
-                if (fault) {
-                    return PARSING_ERROR;
-                }
-                break;
-            case VALUE_TRANSFER:
-            case FEE_DELEGATED_VALUE_TRANSFER:
-            case PARTIAL_FEE_DELEGATED_VALUE_TRANSFER:
-                fault = processTxValueTransfer(&parser_ctx);
-                if (fault) {
-                    return PARSING_ERROR;
-                }
-                break;
-            case VALUE_TRANSFER_MEMO:
-            case FEE_DELEGATED_VALUE_TRANSFER_MEMO:
-            case PARTIAL_FEE_DELEGATED_VALUE_TRANSFER_MEMO:
-                fault = processTxValueTransferMemo(&parser_ctx);
-                if (fault) {
-                    return PARSING_ERROR;
-                }
-                break;
-            case SMART_CONTRACT_DEPLOY:
-            case FEE_DELEGATED_SMART_CONTRACT_DEPLOY:
-            case PARTIAL_FEE_DELEGATED_SMART_CONTRACT_DEPLOY:
-                fault = processTxSmartContractDeploy(&parser_ctx);
-                if (fault) {
-                    return PARSING_ERROR;
-                }
-                break;
-            case SMART_CONTRACT_EXECUTION:
-            case FEE_DELEGATED_SMART_CONTRACT_EXECUTION:
-            case PARTIAL_FEE_DELEGATED_SMART_CONTRACT_EXECUTION:
-                fault = processTxSmartContractExecution(&parser_ctx);
-                if (fault) {
-                    return PARSING_ERROR;
-                }
-                break;
-            case CANCEL:
-            case FEE_DELEGATED_CANCEL:
-            case PARTIAL_FEE_DELEGATED_CANCEL:
-                fault = processTxCancel(&parser_ctx);
-                if (fault) {
+            if (parser_ctx->envelope != ENVELOPE_DONE) {
+                if (processEnvelope(parser_ctx)) {
                     return PARSING_ERROR;
                 }
-                break;
-            default:
-                PRINTF("Transaction type %d is not supported\n", parser_ctx.tx->txType);
-                return PARSING_ERROR;
+                continue;
+            }
         }
+
+        const tx_field_t *field =
+            tx_registry_field(parser_ctx->descriptor, parser_ctx->currentField);
+        if (tx_registry_process_field(field, parser_ctx)) {
+            return PARSING_ERROR;
+        }
+        skip_absent_fields(parser_ctx);
     }
 }
 
+parser_status_e transaction_deserialize(buffer_t *buf, transaction_t *tx) {
+    LEDGER_ASSERT(buf != NULL, "NULL buf");
+    LEDGER_ASSERT(tx != NULL, "NULL tx");
+
+    if (buf->size > MAX_TRANSACTION_LEN) {
+        return WRONG_LENGTH_ERROR;
+    }
+    parser_context_t parser_ctx;
+    transaction_deserialize_init(&parser_ctx, tx);
+
+    return transaction_deserialize_chunk(&parser_ctx, buf, true);
+}
+
 uint8_t readTxByte(parser_context_t *parser_ctx) {
     uint8_t data;
     if (parser_ctx->commandLength < 1) {
@@ -330,3 +451,26 @@ bool copyTxData(parser_context_t *parser_ctx, uint8_t *out, uint32_t length) {
     }
     return true;
 }
+
+bool viewTxData(parser_context_t *parser_ctx, uint256_view_t *view, uint32_t length) {
+    if (parser_ctx->currentFieldPos == 0) {
+        if (parser_ctx->staging == NULL) {
+            // Read in place, the following chunks are consecutive in the retained buffer
+            view->value = parser_ctx->workBuffer;
+        } else {
+            if (parser_ctx->stagingLength - parser_ctx->stagingPos <
+                parser_ctx->currentFieldLength) {
+                PRINTF("viewTxData staging overflow\n");
+                return false;
+            }
+            view->value = parser_ctx->staging + parser_ctx->stagingPos;
+            parser_ctx->stagingPos += parser_ctx->currentFieldLength;
+        }
+    }
+    if (parser_ctx->staging == NULL) {
+        return copyTxData(parser_ctx, NULL, length);
+    }
+    return copyTxData(parser_ctx,
+                      (uint8_t *) view->value + parser_ctx->currentFieldPos,
+                      length);
+}
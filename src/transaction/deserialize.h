@@ -1,153 +1,83 @@
 /**
  * @file deserialize.h
  * @brief Contains functions for deserializing and parsing transactions.
+ *
+ * The parser keeps its whole state in parser_context_t and only reads the const transaction
+ * registry: distinct contexts can parse transactions concurrently.
  */
 
 #pragma once
 
 #include "buffer.h"
 #include "types.h"
+#include "calldata.h"
+#include "data_hash.h"
 
 #ifndef MIN
 #define MIN(x, y) ((x) < (y) ? (x) : (y))
 #endif
 
-#define RLP_NONE 0
+/**
+ * Staging storage needed when the chunks are not retained: every integer field viewed by
+ * transaction_t (nonce, gas price, priority fee, gas limit, value and chain ID) at its maximum
+ * length.
+ */
+#define TX_STAGING_LEN (6 * MAX_INT256)
 
 /**
- * @brief Enumeration of legacy RLP transaction fields.
+ * @brief Enumeration of transaction fee payer types.
  */
-typedef enum {
-    LEGACY_RLP_NONE = RLP_NONE,
-    LEGACY_RLP_NONCE,
-    LEGACY_RLP_GASPRICE,
-    LEGACY_RLP_STARTGAS,
-    LEGACY_RLP_TO,
-    LEGACY_RLP_VALUE,
-    LEGACY_RLP_DATA,
-    LEGACY_RLP_CHAIN_ID,
-    LEGACY_RLP_ZERO1,
-    LEGACY_RLP_ZERO2,
-    LEGACY_RLP_DONE
-} rlpLegacyTxField_e;
-
-typedef enum rlpValueTransferTxField_e {
-    VALUE_TRANSFER_RLP_NONE = RLP_NONE,
-    VALUE_TRANSFER_RLP_CONTENT,
-    VALUE_TRANSFER_RLP_TYPE,
-    VALUE_TRANSFER_RLP_NONCE,
-    VALUE_TRANSFER_RLP_GASPRICE,
-    VALUE_TRANSFER_RLP_GASLIMIT,
-    VALUE_TRANSFER_RLP_TO,
-    VALUE_TRANSFER_RLP_VALUE,
-    VALUE_TRANSFER_RLP_FROM,
-    VALUE_TRANSFER_RLP_RATIO,
-    VALUE_TRANSFER_RLP_CHAIN_ID,
-    VALUE_TRANSFER_RLP_ZERO1,
-    VALUE_TRANSFER_RLP_ZERO2,
-    VALUE_TRANSFER_RLP_DONE
-} rlpValueTransferTxField_e;
-
-typedef enum rlpValueTransferMemoTxField_e {
-    VALUE_TRANSFER_MEMO_RLP_NONE = RLP_NONE,
-    VALUE_TRANSFER_MEMO_RLP_CONTENT,
-    VALUE_TRANSFER_MEMO_RLP_TYPE,
-    VALUE_TRANSFER_MEMO_RLP_NONCE,
-    VALUE_TRANSFER_MEMO_RLP_GASPRICE,
-    VALUE_TRANSFER_MEMO_RLP_GASLIMIT,
-    VALUE_TRANSFER_MEMO_RLP_TO,
-    VALUE_TRANSFER_MEMO_RLP_VALUE,
-    VALUE_TRANSFER_MEMO_RLP_FROM,
-    VALUE_TRANSFER_MEMO_RLP_DATA,
-    VALUE_TRANSFER_MEMO_RLP_RATIO,
-    VALUE_TRANSFER_MEMO_RLP_CHAIN_ID,
-    VALUE_TRANSFER_MEMO_RLP_ZERO1,
-    VALUE_TRANSFER_MEMO_RLP_ZERO2,
-    VALUE_TRANSFER_MEMO_RLP_DONE
-} rlpValueTransferMemoTxField_e;
-
-typedef enum rlpSmartContractDeployTxField_e {
-    SMART_CONTRACT_DEPLOY_RLP_NONE = RLP_NONE,
-    SMART_CONTRACT_DEPLOY_RLP_CONTENT,
-    SMART_CONTRACT_DEPLOY_RLP_TYPE,
-    SMART_CONTRACT_DEPLOY_RLP_NONCE,
-    SMART_CONTRACT_DEPLOY_RLP_GASPRICE,
-    SMART_CONTRACT_DEPLOY_RLP_GASLIMIT,
-    SMART_CONTRACT_DEPLOY_RLP_TO,
-    SMART_CONTRACT_DEPLOY_RLP_VALUE,
-    SMART_CONTRACT_DEPLOY_RLP_FROM,
-    SMART_CONTRACT_DEPLOY_RLP_DATA,
-    SMART_CONTRACT_DEPLOY_RLP_HUMAN_READABLE,
-    SMART_CONTRACT_DEPLOY_RLP_RATIO,
-    SMART_CONTRACT_DEPLOY_RLP_CODE_FORMAT,
-    SMART_CONTRACT_DEPLOY_RLP_CHAIN_ID,
-    SMART_CONTRACT_DEPLOY_RLP_ZERO1,
-    SMART_CONTRACT_DEPLOY_RLP_ZERO2,
-    SMART_CONTRACT_DEPLOY_RLP_DONE
-} rlpSmartContractDeployTxField_e;
-
-typedef enum rlpSmartContractExecutionTxField_e {
-    SMART_CONTRACT_EXECUTION_RLP_NONE = RLP_NONE,
-    SMART_CONTRACT_EXECUTION_RLP_CONTENT,
-    SMART_CONTRACT_EXECUTION_RLP_TYPE,
-    SMART_CONTRACT_EXECUTION_RLP_NONCE,
-    SMART_CONTRACT_EXECUTION_RLP_GASPRICE,
-    SMART_CONTRACT_EXECUTION_RLP_GASLIMIT,
-    SMART_CONTRACT_EXECUTION_RLP_TO,
-    SMART_CONTRACT_EXECUTION_RLP_VALUE,
-    SMART_CONTRACT_EXECUTION_RLP_FROM,
-    SMART_CONTRACT_EXECUTION_RLP_DATA,
-    SMART_CONTRACT_EXECUTION_RLP_RATIO,
-    SMART_CONTRACT_EXECUTION_RLP_CHAIN_ID,
-    SMART_CONTRACT_EXECUTION_RLP_ZERO1,
-    SMART_CONTRACT_EXECUTION_RLP_ZERO2,
-    SMART_CONTRACT_EXECUTION_RLP_DONE
-
-} rlpSmartContractExecutionTxField_e;
-
-/**
- * @brief Enumeration of cancel RLP transaction fields.
+typedef enum { BASIC = 0, FEE_DELEGATED = 1, PARTIAL_FEE_DELEGATED = 2 } txFeePayerType_e;
+
+/**
+ * Maximum length of a legacy transaction nonce (EIP-2681), shorter than any encoded Kaia
+ * transaction.
+ */
+#define MAX_LEGACY_NONCE_LEN 8
+
+/**
+ * @brief Enumeration of the transaction envelope decoding steps.
  */
 typedef enum {
-    CANCEL_RLP_NONE = RLP_NONE,
-    CANCEL_RLP_CONTENT,
-    CANCEL_RLP_TYPE,
-    CANCEL_RLP_NONCE,
-    CANCEL_RLP_GASPRICE,
-    CANCEL_RLP_GASLIMIT,
-    CANCEL_RLP_FROM,
-    CANCEL_RLP_RATIO,
-    CANCEL_RLP_CHAIN_ID,
-    CANCEL_RLP_ZERO1,
-    CANCEL_RLP_ZERO2,
-    CANCEL_RLP_DONE
-} rlpCancelTxField_e;
+    ENVELOPE_OUTER_LIST,   /// outer list of the signature preimage, or EIP-2718 type
+    ENVELOPE_FIRST_FIELD,  /// legacy nonce or encoded Kaia transaction
+    ENVELOPE_KAIA_LIST,    /// list of the encoded Kaia transaction
+    ENVELOPE_KAIA_TYPE,    /// Kaia transaction type
+    ENVELOPE_TYPED_LIST,   /// list of an EIP-2718 typed transaction
+    ENVELOPE_DONE          /// fields of the detected transaction type
+} envelope_state_e;
 
 /**
- * @brief Enumeration of transaction fee payer types.
+ * @brief Description of a transaction type, see registry.h.
  */
-typedef enum { BASIC = 0, FEE_DELEGATED = 1, PARTIAL_FEE_DELEGATED = 2 } txFeePayerType_e;
+typedef struct tx_descriptor_s tx_descriptor_t;
 
 /**
  * @brief Structure representing the parsing context.
  */
 typedef struct {
-    uint8_t txType;                /// transaction type
-    uint8_t currentField;          /// current field being parsed
+    uint8_t txType;                    /// transaction type
+    const tx_descriptor_t *descriptor; /// description of the transaction type, once detected
+    uint8_t currentField;              /// index of the field being parsed in the descriptor
     uint32_t currentFieldPos;      /// position in the current field
     uint32_t currentFieldLength;   /// length of the current field
     bool currentFieldIsList;       /// flag to indicate if the current field is a list
     uint8_t processingField;       /// flag to indicate if a field is being processed
     bool fieldSingleByte;          /// flag to indicate if the field is a single byte
-    bool outerRLP;                 /// flag to indicate if the outer RLP is being processed
-    bool processingOuterRLPField;  /// flag to indicate if a field in the outer RLP is being
-                                   /// processed
+    uint8_t envelope;              /// envelope_state_e decoding step
     uint32_t commandLength;        /// length of the command
     uint32_t dataLength;           /// length of the data
     uint8_t rlpBuffer[5];          /// buffer to store RLP data
     uint32_t rlpBufferPos;         /// position in the RLP buffer
     const uint8_t *workBuffer;     /// pointer to the buffer being parsed
     transaction_t *tx;             /// pointer to the transaction structure
+    uint8_t *staging;              /// storage for the viewed fields, NULL if chunks are retained
+    uint32_t stagingLength;        /// size of the staging storage
+    uint32_t stagingPos;           /// bytes of the staging storage in use
+    uint32_t accessListSkip;       /// bytes left in the access list entry being skipped
+    calldata_decoder_t calldata;   /// decoding of the token call of a smart contract execution
+    data_hash_t dataHash;          /// hash of the data field, updated as it is received
+    bool complete;                 /// flag set once the last chunk is parsed, no chunk follows
 } parser_context_t;
 
 /**
@@ -162,6 +92,76 @@ typedef struct {
  */
 parser_status_e transaction_deserialize(buffer_t *buf, transaction_t *tx);
 
+/**
+ * @brief Initialize a parsing context for a chunked deserialization.
+ *
+ * The context keeps the parser state between calls to transaction_deserialize_chunk()
+ * so that a transaction received over several APDUs is parsed as it arrives. The transaction
+ * structure is cleared, so that it can be reused for the next transaction.
+ *
+ * @param[out] parser_ctx Pointer to the parsing context to initialize.
+ * @param[out] tx Pointer to the transaction structure to populate.
+ */
+void transaction_deserialize_init(parser_context_t *parser_ctx, transaction_t *tx);
+
+/**
+ * @brief Stage the viewed fields for chunks that are not retained.
+ *
+ * By default the integer fields of the transaction are views into the parsed buffer, so the
+ * chunks have to be consecutive parts of one buffer kept until the transaction is no longer
+ * used. When each chunk is dropped once parsed, the viewed fields are copied to the staging
+ * storage instead.
+ *
+ * @param[in, out] parser_ctx Pointer to the parsing context, after transaction_deserialize_init().
+ * @param[in] staging Storage for the viewed fields, of at least TX_STAGING_LEN bytes.
+ * @param[in] staging_len Size of the staging storage.
+ */
+void transaction_deserialize_set_staging(parser_context_t *parser_ctx,
+                                         uint8_t *staging,
+                                         uint32_t staging_len);
+
+/**
+ * @brief Parse the signature preimage of the fee payer instead of the sender's.
+ *
+ * The fee payer of a fee delegated or partial fee delegated Kaia transaction signs
+ * rlp([encode(rlp([type, ..., from, ...])), feePayer, chainId, 0, 0]): its address is inserted
+ * before the chain ID of the sender preimage. The other transaction types are rejected.
+ *
+ * @param[in, out] parser_ctx Pointer to the parsing context, after transaction_deserialize_init().
+ */
+void transaction_deserialize_set_fee_payer(parser_context_t *parser_ctx);
+
+/**
+ * @brief Check if the next chunk has to be retained until the transaction is reviewed.
+ *
+ * Once the parser has reached the fields that are only skipped (the access list of a typed
+ * transaction), the following chunks are not viewed by the transaction and can be parsed in
+ * place and dropped, even when the chunks are otherwise retained. So can a chunk that lies
+ * within a data field that is only hashed, such as the bytecode of a smart contract deploy.
+ *
+ * @param[in] parser_ctx Pointer to the parsing context.
+ * @param[in] chunk_len Length of the next chunk.
+ * @return True if the next chunk has to be retained, false otherwise.
+ */
+bool transaction_deserialize_retains_chunk(const parser_context_t *parser_ctx,
+                                           uint32_t chunk_len);
+
+/**
+ * @brief Resume the deserialization with the next chunk of the raw transaction.
+ *
+ * The chunk is fully consumed. A malformed field is reported on the first chunk that
+ * contains it, an RLP header split between two chunks is carried over in the context.
+ *
+ * @param[in, out] parser_ctx Pointer to the parsing context.
+ * @param[in, out] buf Pointer to the buffer with the chunk.
+ * @param[in] last True if this is the last chunk of the transaction.
+ * @return PARSING_PROCESSING if more chunks are expected, PARSING_OK if the transaction is
+ * complete, error status otherwise, also on a chunk following the last one.
+ */
+parser_status_e transaction_deserialize_chunk(parser_context_t *parser_ctx,
+                                              buffer_t *buf,
+                                              bool last);
+
 /**
  * @brief Parse RLP fields.
  *
@@ -174,36 +174,22 @@ parser_status_e transaction_deserialize(buffer_t *buf, transaction_t *tx);
 parser_status_e parseRLP(parser_context_t *parsing_ctx);
 
 /**
- * @def PARSING_IS_DONE(parsing_ctx)
- * @brief Macro to check if parsing is done.
- *
- * This macro checks if parsing is complete by evaluating the current parsing context and
- * transaction type. It returns true if parsing is done, and false otherwise.
- *
- * @param parsing_ctx The parsing context.
- * @return True if parsing is done, false otherwise.
- */
-#define PARSING_IS_DONE(parsing_ctx)                                                         \
-    ((parsing_ctx.tx->txType == LEGACY && parsing_ctx.currentField == LEGACY_RLP_DONE) ||    \
-     ((parsing_ctx.tx->txType == CANCEL || parsing_ctx.tx->txType == FEE_DELEGATED_CANCEL || \
-       parsing_ctx.tx->txType == PARTIAL_FEE_DELEGATED_CANCEL) &&                            \
-      parsing_ctx.currentField == CANCEL_RLP_DONE) ||                                        \
-     ((parsing_ctx.tx->txType == VALUE_TRANSFER ||                                           \
-       parsing_ctx.tx->txType == FEE_DELEGATED_VALUE_TRANSFER ||                             \
-       parsing_ctx.tx->txType == PARTIAL_FEE_DELEGATED_VALUE_TRANSFER) &&                    \
-      parsing_ctx.currentField == VALUE_TRANSFER_RLP_DONE) ||                                \
-     ((parsing_ctx.tx->txType == VALUE_TRANSFER_MEMO ||                                      \
-       parsing_ctx.tx->txType == FEE_DELEGATED_VALUE_TRANSFER_MEMO ||                        \
-       parsing_ctx.tx->txType == PARTIAL_FEE_DELEGATED_VALUE_TRANSFER_MEMO) &&               \
-      parsing_ctx.currentField == VALUE_TRANSFER_MEMO_RLP_DONE) ||                           \
-     ((parsing_ctx.tx->txType == SMART_CONTRACT_DEPLOY ||                                    \
-       parsing_ctx.tx->txType == FEE_DELEGATED_SMART_CONTRACT_DEPLOY ||                      \
-       parsing_ctx.tx->txType == PARTIAL_FEE_DELEGATED_SMART_CONTRACT_DEPLOY) &&             \
-      parsing_ctx.currentField == SMART_CONTRACT_DEPLOY_RLP_DONE) ||                         \
-     ((parsing_ctx.tx->txType == SMART_CONTRACT_EXECUTION ||                                 \
-       parsing_ctx.tx->txType == FEE_DELEGATED_SMART_CONTRACT_EXECUTION ||                   \
-       parsing_ctx.tx->txType == PARTIAL_FEE_DELEGATED_SMART_CONTRACT_EXECUTION) &&          \
-      parsing_ctx.currentField == SMART_CONTRACT_EXECUTION_RLP_DONE))
+ * @brief Read an RLP header, possibly split between chunks.
+ *
+ * The header bytes are consumed, a self encoded byte is left in the buffer as the content.
+ * A partial header is carried over in the parsing context until the next call.
+ *
+ * @param[in, out] parser_ctx Pointer to the parsing context.
+ * @param[out] length Length of the content.
+ * @param[out] list True if the header starts a list, false if it starts a string.
+ * @param[out] singleByte True if the byte encodes itself.
+ * @return PARSING_CONTINUE once the header is decoded, PARSING_PROCESSING if more data is
+ * needed, error status otherwise.
+ */
+parser_status_e readRLPHeader(parser_context_t *parser_ctx,
+                              uint32_t *length,
+                              bool *list,
+                              bool *singleByte);
 
 /**
  * @brief Copy transaction data to the output buffer.
@@ -218,6 +204,20 @@ parser_status_e parseRLP(parser_context_t *parsing_ctx);
  */
 bool copyTxData(parser_context_t *parser_ctx, uint8_t *out, uint32_t length);
 
+/**
+ * @brief Consume transaction data viewed by a transaction field.
+ *
+ * The view is set on the first bytes of the field: in place in the parsed buffer, or in the
+ * staging storage where the data is then copied. The caller sets the view length once the
+ * field is complete.
+ *
+ * @param[in] parser_ctx Pointer to the parser context.
+ * @param[out] view Pointer to the view on the field.
+ * @param[in] length Length of the data to consume.
+ * @return True if the data was consumed successfully, false otherwise.
+ */
+bool viewTxData(parser_context_t *parser_ctx, uint256_view_t *view, uint32_t length);
+
 /**
  * @brief Read a byte from the transaction buffer.
  *
@@ -16,57 +16,86 @@
  *****************************************************************************/
 
 #include "process_rlp_fields.h"
+#include "utils.h"
 #if defined(TEST)
 #include "assert.h"
-#include <stdio.h>  // printf
 #define LEDGER_ASSERT(x, y) assert(x)
-#define PRINTF              printf
+#if defined(TX_PARSER_NO_TRACE)
+#define PRINTF(...)
+#else
+#include <stdio.h>  // printf
+#define PRINTF printf
+#endif
 #else
 #include "ledger_assert.h"
 #endif
 
-bool processContent(parser_context_t *parser_ctx) {
-    // Keep the full length for sanity checks, move to the next field
-    if (!parser_ctx->currentFieldIsList) {
-        PRINTF("Invalid type for RLP_CONTENT\n");
-        return true;
-    }
-    parser_ctx->dataLength = parser_ctx->currentFieldLength;
-    parser_ctx->currentField++;
-    parser_ctx->processingField = false;
-    return false;
-}
-
-bool processAccessList(parser_context_t *parser_ctx) {
-    if (!parser_ctx->currentFieldIsList) {
-        PRINTF("Invalid type for RLP_ACCESS_LIST\n");
-        return true;
-    }
+// Consume an integer field, viewed by the transaction once complete
+static bool processIntegerView(parser_context_t *parser_ctx, uint256_view_t *view) {
     if (parser_ctx->currentFieldPos < parser_ctx->currentFieldLength) {
         uint32_t copySize = MIN(parser_ctx->commandLength,
                                 parser_ctx->currentFieldLength - parser_ctx->currentFieldPos);
-        copyTxData(parser_ctx, NULL, copySize);
+        // The view is set on the first bytes received, possibly in the next chunk
+        if (copySize != 0 && !viewTxData(parser_ctx, view, copySize)) {
+            return true;
+        }
     }
     if (parser_ctx->currentFieldPos == parser_ctx->currentFieldLength) {
+        if (parser_ctx->currentFieldLength == 0) {
+            view->value = NULL;
+        }
+        view->length = parser_ctx->currentFieldLength;
         parser_ctx->currentField++;
         parser_ctx->processingField = false;
     }
     return false;
 }
 
-bool processType(parser_context_t *parser_ctx) {
-    if (parser_ctx->currentFieldIsList) {
-        PRINTF("Invalid type for RLP_TYPE\n");
+// Read the header of the next access list entry, return true if it is invalid
+static bool readAccessListEntry(parser_context_t *parser_ctx) {
+    uint32_t entryLength;
+    bool entryIsList;
+    bool entrySingleByte;
+    uint32_t available = parser_ctx->commandLength;
+    parser_status_e status =
+        readRLPHeader(parser_ctx, &entryLength, &entryIsList, &entrySingleByte);
+    // The header bytes are part of the access list
+    parser_ctx->currentFieldPos += available - parser_ctx->commandLength;
+    if (parser_ctx->currentFieldPos > parser_ctx->currentFieldLength) {
+        PRINTF("Invalid RLP_ACCESS_LIST entry header\n");
         return true;
     }
-    if (parser_ctx->currentFieldLength > MAX_INT256) {
-        PRINTF("Invalid length for RLP_TYPE\n");
+    if (status == PARSING_PROCESSING) {
+        // The header continues in the next chunk, within the list
+        return parser_ctx->currentFieldPos == parser_ctx->currentFieldLength;
+    }
+    if (status != PARSING_CONTINUE || !entryIsList ||
+        parser_ctx->currentFieldLength - parser_ctx->currentFieldPos < entryLength) {
+        PRINTF("Invalid RLP_ACCESS_LIST entry\n");
         return true;
     }
-    if (parser_ctx->currentFieldPos < parser_ctx->currentFieldLength) {
-        uint32_t copySize = MIN(parser_ctx->commandLength,
-                                parser_ctx->currentFieldLength - parser_ctx->currentFieldPos);
-        copyTxData(parser_ctx, (uint8_t *) &parser_ctx->tx->txType, copySize);
+    parser_ctx->tx->accessListCount++;
+    parser_ctx->accessListSkip = entryLength;
+    return false;
+}
+
+// The entries are counted and skipped as they arrive, nothing is kept from the chunks
+bool processAccessList(parser_context_t *parser_ctx) {
+    if (!parser_ctx->currentFieldIsList) {
+        PRINTF("Invalid type for RLP_ACCESS_LIST\n");
+        return true;
+    }
+    while (parser_ctx->commandLength != 0 &&
+           parser_ctx->currentFieldPos < parser_ctx->currentFieldLength) {
+        if (parser_ctx->accessListSkip == 0) {
+            if (readAccessListEntry(parser_ctx)) {
+                return true;
+            }
+            continue;
+        }
+        uint32_t copySize = MIN(parser_ctx->commandLength, parser_ctx->accessListSkip);
+        copyTxData(parser_ctx, NULL, copySize);
+        parser_ctx->accessListSkip -= copySize;
     }
     if (parser_ctx->currentFieldPos == parser_ctx->currentFieldLength) {
         parser_ctx->currentField++;
@@ -84,18 +113,7 @@ bool processChainID(parser_context_t *parser_ctx) {
         PRINTF("Invalid length for RLP_CHAINID\n");
         return true;
     }
-    if (parser_ctx->currentFieldPos < parser_ctx->currentFieldLength) {
-        uint32_t copySize = MIN(parser_ctx->commandLength,
-                                parser_ctx->currentFieldLength - parser_ctx->currentFieldPos);
-        copyTxData(parser_ctx, parser_ctx->tx->chainID.value, copySize);
-    }
-    if (parser_ctx->currentFieldPos == parser_ctx->currentFieldLength) {
-        parser_ctx->tx->chainID.length = parser_ctx->currentFieldLength;
-
-        parser_ctx->currentField++;
-        parser_ctx->processingField = false;
-    }
-    return false;
+    return processIntegerView(parser_ctx, &parser_ctx->tx->chainID);
 }
 
 bool processNonce(parser_context_t *parser_ctx) {
@@ -107,17 +125,7 @@ bool processNonce(parser_context_t *parser_ctx) {
         PRINTF("Invalid length for RLP_NONCE\n");
         return true;
     }
-    if (parser_ctx->currentFieldPos < parser_ctx->currentFieldLength) {
-        uint32_t copySize = MIN(parser_ctx->commandLength,
-                                parser_ctx->currentFieldLength - parser_ctx->currentFieldPos);
-        copyTxData(parser_ctx, parser_ctx->tx->nonce.value, copySize);
-    }
-    if (parser_ctx->currentFieldPos == parser_ctx->currentFieldLength) {
-        parser_ctx->tx->nonce.length = parser_ctx->currentFieldLength;
-        parser_ctx->currentField++;
-        parser_ctx->processingField = false;
-    }
-    return false;
+    return processIntegerView(parser_ctx, &parser_ctx->tx->nonce);
 }
 
 bool processStartGas(parser_context_t *parser_ctx) {
@@ -129,19 +137,7 @@ bool processStartGas(parser_context_t *parser_ctx) {
         PRINTF("Invalid length for RLP_STARTGAS %d\n", parser_ctx->currentFieldLength);
         return true;
     }
-    if (parser_ctx->currentFieldPos < parser_ctx->currentFieldLength) {
-        uint32_t copySize = MIN(parser_ctx->commandLength,
-                                parser_ctx->currentFieldLength - parser_ctx->currentFieldPos);
-        copyTxData(parser_ctx,
-                   parser_ctx->tx->startgas.value + parser_ctx->currentFieldPos,
-                   copySize);
-    }
-    if (parser_ctx->currentFieldPos == parser_ctx->currentFieldLength) {
-        parser_ctx->tx->startgas.length = parser_ctx->currentFieldLength;
-        parser_ctx->currentField++;
-        parser_ctx->processingField = false;
-    }
-    return false;
+    return processIntegerView(parser_ctx, &parser_ctx->tx->startgas);
 }
 
 // Alias over `processStartGas()`.
@@ -158,19 +154,19 @@ bool processGasprice(parser_context_t *parser_ctx) {
         PRINTF("Invalid length for RLP_GASPRICE\n");
         return true;
     }
-    if (parser_ctx->currentFieldPos < parser_ctx->currentFieldLength) {
-        uint32_t copySize = MIN(parser_ctx->commandLength,
-                                parser_ctx->currentFieldLength - parser_ctx->currentFieldPos);
-        copyTxData(parser_ctx,
-                   parser_ctx->tx->gasprice.value + parser_ctx->currentFieldPos,
-                   copySize);
+    return processIntegerView(parser_ctx, &parser_ctx->tx->gasprice);
+}
+
+bool processPriorityFee(parser_context_t *parser_ctx) {
+    if (parser_ctx->currentFieldIsList) {
+        PRINTF("Invalid type for RLP_PRIORITY_FEE\n");
+        return true;
     }
-    if (parser_ctx->currentFieldPos == parser_ctx->currentFieldLength) {
-        parser_ctx->tx->gasprice.length = parser_ctx->currentFieldLength;
-        parser_ctx->currentField++;
-        parser_ctx->processingField = false;
+    if (parser_ctx->currentFieldLength > MAX_INT256) {
+        PRINTF("Invalid length for RLP_PRIORITY_FEE\n");
+        return true;
     }
-    return false;
+    return processIntegerView(parser_ctx, &parser_ctx->tx->priorityFee);
 }
 
 bool processValue(parser_context_t *parser_ctx) {
@@ -182,17 +178,20 @@ bool processValue(parser_context_t *parser_ctx) {
         PRINTF("Invalid length for RLP_VALUE\n");
         return true;
     }
+    return processIntegerView(parser_ctx, &parser_ctx->tx->value);
+}
+
+// Copy an address field to the transaction as it passes, its length has been checked
+static void processAddress(parser_context_t *parser_ctx, uint8_t *address) {
     if (parser_ctx->currentFieldPos < parser_ctx->currentFieldLength) {
         uint32_t copySize = MIN(parser_ctx->commandLength,
                                 parser_ctx->currentFieldLength - parser_ctx->currentFieldPos);
-        copyTxData(parser_ctx, parser_ctx->tx->value.value + parser_ctx->currentFieldPos, copySize);
+        copyTxData(parser_ctx, address + parser_ctx->currentFieldPos, copySize);
     }
     if (parser_ctx->currentFieldPos == parser_ctx->currentFieldLength) {
-        parser_ctx->tx->value.length = parser_ctx->currentFieldLength;
         parser_ctx->currentField++;
         parser_ctx->processingField = false;
     }
-    return false;
 }
 
 bool processTo(parser_context_t *parser_ctx) {
@@ -204,11 +203,69 @@ bool processTo(parser_context_t *parser_ctx) {
         PRINTF("Invalid length for RLP_TO\n");
         return true;
     }
-    if (parser_ctx->currentFieldPos < parser_ctx->currentFieldLength) {
-        uint32_t copySize = MIN(parser_ctx->commandLength,
-                                parser_ctx->currentFieldLength - parser_ctx->currentFieldPos);
-        copyTxData(parser_ctx, parser_ctx->tx->to + parser_ctx->currentFieldPos, copySize);
+    parser_ctx->tx->toLength = parser_ctx->currentFieldLength;
+    processAddress(parser_ctx, parser_ctx->tx->to);
+    return false;
+}
+
+bool processFrom(parser_context_t *parser_ctx) {
+    if (parser_ctx->currentFieldIsList) {
+        PRINTF("Invalid type for RLP_FROM\n");
+        return true;
+    }
+    // Unlike the recipient, the sender of a Kaia transaction is never empty
+    if (parser_ctx->currentFieldLength != ADDRESS_LEN) {
+        PRINTF("Invalid length for RLP_FROM\n");
+        return true;
+    }
+    processAddress(parser_ctx, parser_ctx->tx->from);
+    return false;
+}
+
+bool processFeePayer(parser_context_t *parser_ctx) {
+    if (parser_ctx->currentFieldIsList) {
+        PRINTF("Invalid type for RLP_FEE_PAYER\n");
+        return true;
+    }
+    if (parser_ctx->currentFieldLength != ADDRESS_LEN) {
+        PRINTF("Invalid length for RLP_FEE_PAYER\n");
+        return true;
+    }
+    processAddress(parser_ctx, parser_ctx->tx->feePayer);
+    return false;
+}
+
+// Hash and count the data as it passes, return true if the hash fails
+static bool hashData(parser_context_t *parser_ctx, uint32_t length) {
+    if (parser_ctx->currentFieldPos == 0 && !data_hash_init(&parser_ctx->dataHash)) {
+        return true;
+    }
+    if (!data_hash_update(&parser_ctx->dataHash, parser_ctx->workBuffer, length)) {
+        return true;
+    }
+    if (parser_ctx->currentFieldPos + length == parser_ctx->currentFieldLength) {
+        parser_ctx->tx->dataSize = parser_ctx->currentFieldLength;
+        return !data_hash_final(&parser_ctx->dataHash, parser_ctx->tx->dataHash);
     }
+    return false;
+}
+
+bool processData(parser_context_t *parser_ctx) {
+    if (parser_ctx->currentFieldIsList) {
+        PRINTF("Invalid type for RLP_DATA\n");
+        return true;
+    }
+    uint32_t copySize = MIN(parser_ctx->commandLength,
+                            parser_ctx->currentFieldLength - parser_ctx->currentFieldPos);
+    // If there is no data, set dataPresent to false.
+    if (copySize == 1 && *parser_ctx->workBuffer == 0x00) {
+        parser_ctx->tx->dataPresent = false;
+    }
+    if (hashData(parser_ctx, copySize)) {
+        PRINTF("RLP_DATA hash failed\n");
+        return true;
+    }
+    copyTxData(parser_ctx, NULL, copySize);
     if (parser_ctx->currentFieldPos == parser_ctx->currentFieldLength) {
         parser_ctx->currentField++;
         parser_ctx->processingField = false;
@@ -216,23 +273,51 @@ bool processTo(parser_context_t *parser_ctx) {
     return false;
 }
 
-bool processData(parser_context_t *parser_ctx) {
-    PRINTF("PROCESS DATA\n");
+// The calldata is decoded and hashed as it passes, nothing is kept from the chunks
+bool processCalldata(parser_context_t *parser_ctx) {
     if (parser_ctx->currentFieldIsList) {
         PRINTF("Invalid type for RLP_DATA\n");
         return true;
     }
-    if (parser_ctx->currentFieldPos < parser_ctx->currentFieldLength) {
-        uint32_t copySize = MIN(parser_ctx->commandLength,
-                                parser_ctx->currentFieldLength - parser_ctx->currentFieldPos);
-        // If there is no data, set dataPresent to false.
-        if (copySize == 1 && *parser_ctx->workBuffer == 0x00) {
-            parser_ctx->tx->dataPresent = false;
-        }
+    uint32_t copySize = MIN(parser_ctx->commandLength,
+                            parser_ctx->currentFieldLength - parser_ctx->currentFieldPos);
+    calldata_feed(&parser_ctx->calldata, parser_ctx->tx, parser_ctx->workBuffer, copySize);
+    if (hashData(parser_ctx, copySize)) {
+        PRINTF("RLP_DATA hash failed\n");
+        return true;
+    }
+    copyTxData(parser_ctx, NULL, copySize);
+    if (parser_ctx->currentFieldPos == parser_ctx->currentFieldLength) {
+        calldata_finish(&parser_ctx->calldata, parser_ctx->tx);
+        parser_ctx->currentField++;
+        parser_ctx->processingField = false;
+    }
+    return false;
+}
+
+// The memo is copied to the transaction as it passes, a longer one is only hashed
+bool processMemo(parser_context_t *parser_ctx) {
+    if (parser_ctx->currentFieldIsList) {
+        PRINTF("Invalid type for RLP_MEMO\n");
+        return true;
+    }
+    uint32_t copySize = MIN(parser_ctx->commandLength,
+                            parser_ctx->currentFieldLength - parser_ctx->currentFieldPos);
+    if (hashData(parser_ctx, copySize)) {
+        PRINTF("RLP_MEMO hash failed\n");
+        return true;
+    }
+    if (parser_ctx->currentFieldLength <= MAX_MEMO_LEN) {
+        copyTxData(parser_ctx, parser_ctx->tx->memo + parser_ctx->currentFieldPos, copySize);
+    } else {
         copyTxData(parser_ctx, NULL, copySize);
     }
     if (parser_ctx->currentFieldPos == parser_ctx->currentFieldLength) {
-        PRINTF("incrementing field\n");
+        if (parser_ctx->currentFieldLength <= MAX_MEMO_LEN &&
+            transaction_utils_check_encoding(parser_ctx->tx->memo,
+                                             parser_ctx->currentFieldLength)) {
+            parser_ctx->tx->memoLength = parser_ctx->currentFieldLength;
+        }
         parser_ctx->currentField++;
         parser_ctx->processingField = false;
     }
@@ -261,7 +346,8 @@ bool processRatio(parser_context_t *parser_ctx) {
         PRINTF("Invalid type for RLP_RATIO\n");
         return true;
     }
-    if (parser_ctx->currentFieldLength > MAX_INT256) {
+    // The fee ratio is a percentage, it fits in tx->ratio
+    if (parser_ctx->currentFieldLength > sizeof(parser_ctx->tx->ratio)) {
         PRINTF("Invalid length for RLP_RATIO\n");
         return true;
     }
@@ -1,39 +1,19 @@
 #pragma once
 #include "deserialize.h"
 
-/**
- * @brief Processes the RLP_CONTENT field.
- *
- * This function keeps the full length for sanity checks and moves to the next field.
- *
- * @param parser_ctx The parser context.
- * @return Returns true if the type is invalid for RLP_CONTENT, otherwise false.
- */
-bool processContent(parser_context_t *parser_ctx);
-
 /**
  * @brief Processes the RLP_ACCESS_LIST field.
  *
- * This function checks the type of the field and copies the data if necessary.
- * It also moves to the next field when the current field is fully processed.
+ * This function checks the type of the field, counts its entries and skips them as they are
+ * received, without retaining any data. It also moves to the next field when the current field
+ * is fully processed.
  *
  * @param parser_ctx The parser context.
- * @return Returns true if the type is invalid for RLP_ACCESS_LIST, otherwise false.
+ * @return Returns true if the type is invalid or an entry is invalid for RLP_ACCESS_LIST,
+ * otherwise false.
  */
 bool processAccessList(parser_context_t *parser_ctx);
 
-/**
- * @brief Processes the RLP_TYPE field.
- *
- * This function checks the type of the field, validates the length, and copies the data if
- * necessary. It also moves to the next field when the current field is fully processed.
- *
- * @param parser_ctx The parser context.
- * @return Returns true if the type is invalid or the length is invalid for RLP_TYPE, otherwise
- * false.
- */
-bool processType(parser_context_t *parser_ctx);
-
 /**
  * @brief Processes the RLP_CHAINID field.
  *
@@ -96,6 +76,18 @@ bool processGasLimit(parser_context_t *parser_ctx);
  */
 bool processGasprice(parser_context_t *parser_ctx);
 
+/**
+ * @brief Processes the RLP_PRIORITY_FEE field.
+ *
+ * This function checks the type of the field, validates the length, and copies the data if
+ * necessary. It also moves to the next field when the current field is fully processed.
+ *
+ * @param parser_ctx The parser context.
+ * @return Returns true if the type is invalid or the length is invalid for RLP_PRIORITY_FEE,
+ * otherwise false.
+ */
+bool processPriorityFee(parser_context_t *parser_ctx);
+
 /**
  * @brief Processes the RLP_VALUE field.
  *
@@ -119,17 +111,67 @@ bool processValue(parser_context_t *parser_ctx);
  */
 bool processTo(parser_context_t *parser_ctx);
 
+/**
+ * @brief Processes the RLP_FROM field, the sender of a Kaia transaction.
+ *
+ * This function checks the type of the field, validates the length, and copies the data if
+ * necessary. It also moves to the next field when the current field is fully processed.
+ *
+ * @param parser_ctx The parser context.
+ * @return Returns true if the type is invalid or the length is invalid for RLP_FROM, otherwise
+ * false.
+ */
+bool processFrom(parser_context_t *parser_ctx);
+
+/**
+ * @brief Processes the RLP_FEE_PAYER field, only part of the fee payer signature preimage.
+ *
+ * This function checks the type of the field, validates the length, and copies the data if
+ * necessary. It also moves to the next field when the current field is fully processed.
+ *
+ * @param parser_ctx The parser context.
+ * @return Returns true if the type is invalid or the length is invalid for RLP_FEE_PAYER,
+ * otherwise false.
+ */
+bool processFeePayer(parser_context_t *parser_ctx);
+
 /**
  * @brief Processes the RLP_DATA field.
  *
- * This function checks the type of the field and copies the data if necessary.
- * It also moves to the next field when the current field is fully processed.
+ * This function checks the type of the field and hashes the data as it passes, without
+ * retaining it: the transaction gets the size and Keccak-256 hash of the field. It also moves
+ * to the next field when the current field is fully processed.
  *
  * @param parser_ctx The parser context.
- * @return Returns true if the type is invalid for RLP_DATA, otherwise false.
+ * @return Returns true if the type is invalid for RLP_DATA or the hash fails, otherwise false.
  */
 bool processData(parser_context_t *parser_ctx);
 
+/**
+ * @brief Processes the calldata of a smart contract execution.
+ *
+ * This function checks the type of the field and decodes the known token calls as the data
+ * passes, see calldata.h, and hashes it as processData() does. It also moves to the next field
+ * when the current field is fully processed.
+ *
+ * @param parser_ctx The parser context.
+ * @return Returns true if the type is invalid for RLP_DATA or the hash fails, otherwise false.
+ */
+bool processCalldata(parser_context_t *parser_ctx);
+
+/**
+ * @brief Processes the memo of a value transfer with memo.
+ *
+ * This function checks the type of the field, copies the memo to the transaction as it passes
+ * when it fits in MAX_MEMO_LEN bytes, and hashes it as processData() does. The memo is
+ * displayed when it is printable ASCII, otherwise its size and hash are. It also moves to the
+ * next field when the current field is fully processed.
+ *
+ * @param parser_ctx The parser context.
+ * @return Returns true if the type is invalid for RLP_MEMO or the hash fails, otherwise false.
+ */
+bool processMemo(parser_context_t *parser_ctx);
+
 /**
  * @brief Processes a discarded field.
  *
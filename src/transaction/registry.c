@@ -0,0 +1,272 @@
+/*****************************************************************************
+ *   Ledger App Kaia.
+ *   (c) 2024 Blooo SAS.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *****************************************************************************/
+
+#include <stddef.h>  // NULL
+
+#include "registry.h"
+#include "process_rlp_fields.h"
+
+#if defined(TEST)
+#define PIC(x) (x)
+#else
+#include "os_pic.h"
+#endif
+
+#define FIELD(handler)               {.process = handler, .flags = 0}
+#define FIELD_FLAGS(handler, _flags) {.process = handler, .flags = _flags}
+
+// Fields closing every Kaia signature preimage: [feePayer], chainId, 0, 0, the fee payer
+// address being only part of the preimage signed by the fee payer
+#define FIELDS_SIG_TRAILER \
+    FIELD_FEE_PAYER, FIELD(processChainID), FIELD(processAndDiscard), FIELD(processAndDiscard)
+
+// Fields common to every Kaia transaction after its type, decoded with the envelope:
+// nonce, gasPrice, gas
+#define FIELDS_KAIA_HEADER FIELD(processNonce), FIELD(processGasprice), FIELD(processGasLimit)
+
+#define FIELD_RATIO     FIELD_FLAGS(processRatio, TX_FIELD_PARTIAL_ONLY)
+#define FIELD_FEE_PAYER FIELD_FLAGS(processFeePayer, TX_FIELD_FEE_PAYER_ONLY)
+
+// Data that is not viewed by the transaction, only hashed or copied
+#define FIELD_HASHED(handler) FIELD_FLAGS(handler, TX_FIELD_HASHED)
+
+static const tx_field_t LEGACY_FIELDS[] = {FIELD(processNonce),
+                                           FIELD(processGasprice),
+                                           FIELD(processGasLimit),
+                                           FIELD(processTo),
+                                           FIELD(processValue),
+                                           FIELD_HASHED(processData),
+                                           FIELD_FLAGS(processChainID, TX_FIELD_END_ALLOWED),
+                                           FIELD(processAndDiscard),
+                                           FIELD(processAndDiscard)};
+
+// chainId, nonce, gasPrice, gas, to, value, data, accessList
+static const tx_field_t EIP2930_FIELDS[] = {FIELD(processChainID),
+                                            FIELD(processNonce),
+                                            FIELD(processGasprice),
+                                            FIELD(processGasLimit),
+                                            FIELD(processTo),
+                                            FIELD(processValue),
+                                            FIELD_HASHED(processData),
+                                            FIELD_FLAGS(processAccessList, TX_FIELD_UNRETAINED)};
+
+// chainId, nonce, maxPriorityFeePerGas, maxFeePerGas, gas, to, value, data, accessList
+static const tx_field_t EIP1559_FIELDS[] = {FIELD(processChainID),
+                                            FIELD(processNonce),
+                                            FIELD(processPriorityFee),
+                                            FIELD(processGasprice),
+                                            FIELD(processGasLimit),
+                                            FIELD(processTo),
+                                            FIELD(processValue),
+                                            FIELD_HASHED(processData),
+                                            FIELD_FLAGS(processAccessList, TX_FIELD_UNRETAINED)};
+
+// type, nonce, gasPrice, gas, to, value, from, [ratio]
+static const tx_field_t VALUE_TRANSFER_FIELDS[] = {FIELDS_KAIA_HEADER,
+                                                   FIELD(processTo),
+                                                   FIELD(processValue),
+                                                   FIELD(processFrom),
+                                                   FIELD_RATIO,
+                                                   FIELDS_SIG_TRAILER};
+
+// type, nonce, gasPrice, gas, to, value, from, input, [ratio]
+static const tx_field_t VALUE_TRANSFER_MEMO_FIELDS[] = {FIELDS_KAIA_HEADER,
+                                                        FIELD(processTo),
+                                                        FIELD(processValue),
+                                                        FIELD(processFrom),
+                                                        FIELD_HASHED(processMemo),
+                                                        FIELD_RATIO,
+                                                        FIELDS_SIG_TRAILER};
+
+// type, nonce, gasPrice, gas, to, value, from, input, humanReadable, [ratio], codeFormat
+static const tx_field_t SMART_CONTRACT_DEPLOY_FIELDS[] = {FIELDS_KAIA_HEADER,
+                                                          FIELD(processAndDiscard),
+                                                          FIELD(processValue),
+                                                          FIELD(processFrom),
+                                                          FIELD_HASHED(processData),
+                                                          FIELD(processAndDiscard),
+                                                          FIELD_RATIO,
+                                                          FIELD(processAndDiscard),
+                                                          FIELDS_SIG_TRAILER};
+
+// type, nonce, gasPrice, gas, to, value, from, input, [ratio]
+static const tx_field_t SMART_CONTRACT_EXECUTION_FIELDS[] = {FIELDS_KAIA_HEADER,
+                                                             FIELD(processTo),
+                                                             FIELD(processValue),
+                                                             FIELD(processFrom),
+                                                             FIELD_HASHED(processCalldata),
+                                                             FIELD_RATIO,
+                                                             FIELDS_SIG_TRAILER};
+
+// type, nonce, gasPrice, gas, from, [ratio]
+static const tx_field_t CANCEL_FIELDS[] = {FIELDS_KAIA_HEADER,
+                                           FIELD(processFrom),
+                                           FIELD_RATIO,
+                                           FIELDS_SIG_TRAILER};
+
+#define REVIEW_COMMON \
+    (TX_REVIEW_TYPE | TX_REVIEW_NONCE | TX_REVIEW_GAS_PRICE | TX_REVIEW_GAS_LIMIT)
+#define REVIEW_TRANSFER (REVIEW_COMMON | TX_REVIEW_AMOUNT | TX_REVIEW_TO)
+#define REVIEW_LEGACY   (REVIEW_TRANSFER | TX_REVIEW_DATA)
+#define REVIEW_MEMO     (REVIEW_TRANSFER | TX_REVIEW_MEMO | TX_REVIEW_DATA)
+#define REVIEW_DEPLOY   (REVIEW_COMMON | TX_REVIEW_AMOUNT | TX_REVIEW_DATA)
+#define REVIEW_EXECUTE                                                                   \
+    (REVIEW_COMMON | TX_REVIEW_AMOUNT | TX_REVIEW_SMART_CONTRACT | TX_REVIEW_TOKEN_CALL | \
+     TX_REVIEW_DATA)
+#define REVIEW_CANCEL   REVIEW_COMMON
+#define REVIEW_EIP2930  (REVIEW_LEGACY | TX_REVIEW_ACCESS_LIST)
+#define REVIEW_EIP1559                                                                  \
+    (TX_REVIEW_TYPE | TX_REVIEW_AMOUNT | TX_REVIEW_TO | TX_REVIEW_NONCE | TX_REVIEW_MAX_FEE | \
+     TX_REVIEW_PRIORITY_FEE | TX_REVIEW_GAS_LIMIT | TX_REVIEW_ACCESS_LIST | TX_REVIEW_DATA)
+
+// The sender pays the whole fee of basic transactions, shown with the total cost of those that
+// send a value, a share of it on partial fee delegated ones, shown with the fee ratio, and none
+// of it on fee delegated ones
+#define REVIEW_FEES(_flavor, _review)                                                            \
+    ((_flavor) == BASIC                                                                          \
+         ? (TX_REVIEW_NETWORK_FEE | (((_review) & TX_REVIEW_AMOUNT) ? TX_REVIEW_TOTAL_COST : 0)) \
+     : (_flavor) == PARTIAL_FEE_DELEGATED ? (TX_REVIEW_NETWORK_FEE | TX_REVIEW_FEE_RATIO)        \
+                                          : 0)
+
+#define TX_ENTRY(_type, _flavor, _fields, _review, _name)      \
+    {                                                          \
+        .type = _type, .flavor = _flavor,                      \
+        .field_count = sizeof(_fields) / sizeof((_fields)[0]), \
+        .review = (_review) | REVIEW_FEES(_flavor, _review),   \
+        .fields = _fields, .name = _name                       \
+    }
+
+// The first entry is the legacy transaction, it cannot be reached from TX_REGISTRY_INDEX.
+static const tx_descriptor_t TX_REGISTRY[] = {
+    TX_ENTRY(LEGACY, BASIC, LEGACY_FIELDS, REVIEW_LEGACY, "Legacy"),
+    TX_ENTRY(VALUE_TRANSFER, BASIC, VALUE_TRANSFER_FIELDS, REVIEW_TRANSFER, "Value Transfer"),
+    TX_ENTRY(FEE_DELEGATED_VALUE_TRANSFER,
+             FEE_DELEGATED,
+             VALUE_TRANSFER_FIELDS,
+             REVIEW_TRANSFER,
+             "Fee Delegated Value Transfer"),
+    TX_ENTRY(PARTIAL_FEE_DELEGATED_VALUE_TRANSFER,
+             PARTIAL_FEE_DELEGATED,
+             VALUE_TRANSFER_FIELDS,
+             REVIEW_TRANSFER,
+             "Partial Fee Delegated Value Transfer"),
+    TX_ENTRY(VALUE_TRANSFER_MEMO,
+             BASIC,
+             VALUE_TRANSFER_MEMO_FIELDS,
+             REVIEW_MEMO,
+             "Value Transfer Memo"),
+    TX_ENTRY(FEE_DELEGATED_VALUE_TRANSFER_MEMO,
+             FEE_DELEGATED,
+             VALUE_TRANSFER_MEMO_FIELDS,
+             REVIEW_MEMO,
+             "Fee Delegated Value Transfer Memo"),
+    TX_ENTRY(PARTIAL_FEE_DELEGATED_VALUE_TRANSFER_MEMO,
+             PARTIAL_FEE_DELEGATED,
+             VALUE_TRANSFER_MEMO_FIELDS,
+             REVIEW_MEMO,
+             "Partial Fee Delegated Value Transfer Memo"),
+    TX_ENTRY(SMART_CONTRACT_DEPLOY,
+             BASIC,
+             SMART_CONTRACT_DEPLOY_FIELDS,
+             REVIEW_DEPLOY,
+             "Smart Contract Deploy"),
+    TX_ENTRY(FEE_DELEGATED_SMART_CONTRACT_DEPLOY,
+             FEE_DELEGATED,
+             SMART_CONTRACT_DEPLOY_FIELDS,
+             REVIEW_DEPLOY,
+             "Fee Delegated Smart Contract Deploy"),
+    TX_ENTRY(PARTIAL_FEE_DELEGATED_SMART_CONTRACT_DEPLOY,
+             PARTIAL_FEE_DELEGATED,
+             SMART_CONTRACT_DEPLOY_FIELDS,
+             REVIEW_DEPLOY,
+             "Partial Fee Delegated Smart Contract Deploy"),
+    TX_ENTRY(SMART_CONTRACT_EXECUTION,
+             BASIC,
+             SMART_CONTRACT_EXECUTION_FIELDS,
+             REVIEW_EXECUTE,
+             "Smart Contract Execution"),
+    TX_ENTRY(FEE_DELEGATED_SMART_CONTRACT_EXECUTION,
+             FEE_DELEGATED,
+             SMART_CONTRACT_EXECUTION_FIELDS,
+             REVIEW_EXECUTE,
+             "Fee Delegated Smart Contract Execution"),
+    TX_ENTRY(PARTIAL_FEE_DELEGATED_SMART_CONTRACT_EXECUTION,
+             PARTIAL_FEE_DELEGATED,
+             SMART_CONTRACT_EXECUTION_FIELDS,
+             REVIEW_EXECUTE,
+             "Partial Fee Delegated Smart Contract Execution"),
+    TX_ENTRY(CANCEL, BASIC, CANCEL_FIELDS, REVIEW_CANCEL, "Cancel"),
+    TX_ENTRY(FEE_DELEGATED_CANCEL,
+             FEE_DELEGATED,
+             CANCEL_FIELDS,
+             REVIEW_CANCEL,
+             "Fee Delegated Cancel"),
+    TX_ENTRY(PARTIAL_FEE_DELEGATED_CANCEL,
+             PARTIAL_FEE_DELEGATED,
+             CANCEL_FIELDS,
+             REVIEW_CANCEL,
+             "Partial Fee Delegated Cancel"),
+    TX_ENTRY(EIP2930, BASIC, EIP2930_FIELDS, REVIEW_EIP2930, "EIP-2930"),
+    TX_ENTRY(EIP1559, BASIC, EIP1559_FIELDS, REVIEW_EIP1559, "EIP-1559"),
+};
+
+// Position in TX_REGISTRY of each typed transaction, 0 when the type is not supported
+static const uint8_t TX_REGISTRY_INDEX[0x40] = {
+    [EIP2930] = 16,
+    [EIP1559] = 17,
+    [VALUE_TRANSFER] = 1,
+    [FEE_DELEGATED_VALUE_TRANSFER] = 2,
+    [PARTIAL_FEE_DELEGATED_VALUE_TRANSFER] = 3,
+    [VALUE_TRANSFER_MEMO] = 4,
+    [FEE_DELEGATED_VALUE_TRANSFER_MEMO] = 5,
+    [PARTIAL_FEE_DELEGATED_VALUE_TRANSFER_MEMO] = 6,
+    [SMART_CONTRACT_DEPLOY] = 7,
+    [FEE_DELEGATED_SMART_CONTRACT_DEPLOY] = 8,
+    [PARTIAL_FEE_DELEGATED_SMART_CONTRACT_DEPLOY] = 9,
+    [SMART_CONTRACT_EXECUTION] = 10,
+    [FEE_DELEGATED_SMART_CONTRACT_EXECUTION] = 11,
+    [PARTIAL_FEE_DELEGATED_SMART_CONTRACT_EXECUTION] = 12,
+    [CANCEL] = 13,
+    [FEE_DELEGATED_CANCEL] = 14,
+    [PARTIAL_FEE_DELEGATED_CANCEL] = 15,
+};
+
+const tx_descriptor_t *tx_registry_lookup(uint8_t txType) {
+    if (txType == LEGACY) {
+        return &TX_REGISTRY[0];
+    }
+    if (txType >= sizeof(TX_REGISTRY_INDEX) || TX_REGISTRY_INDEX[txType] == 0) {
+        return NULL;
+    }
+    return &TX_REGISTRY[TX_REGISTRY_INDEX[txType]];
+}
+
+const tx_field_t *tx_registry_field(const tx_descriptor_t *descriptor, uint8_t index) {
+    if (descriptor == NULL || index >= descriptor->field_count) {
+        return NULL;
+    }
+    return (const tx_field_t *) PIC(descriptor->fields) + index;
+}
+
+bool tx_registry_process_field(const tx_field_t *field, parser_context_t *parser_ctx) {
+    process_field_cb process = (process_field_cb) PIC(field->process);
+    return process(parser_ctx);
+}
+
+const char *tx_registry_name(const tx_descriptor_t *descriptor) {
+    return (const char *) PIC(descriptor->name);
+}
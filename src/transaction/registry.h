@@ -0,0 +1,127 @@
+/**
+ * @file registry.h
+ * @brief Table describing every supported transaction type.
+ *
+ * Each transaction type is described once by a const entry in flash: the sequence of its
+ * RLP fields with the handler processing each of them, its fee payer flavor, its display
+ * name and the set of fields shown on review. Adding a Kaia type is a matter of adding an
+ * entry to the table. The Ethereum typed transactions (EIP-2930 and EIP-1559) are described
+ * the same way.
+ */
+
+#pragma once
+
+#include <stdbool.h>  // bool
+#include <stdint.h>   // uint*_t
+
+#include "deserialize.h"
+#include "types.h"
+
+/**
+ * @brief Handler processing one RLP field of a transaction.
+ *
+ * @param parser_ctx The parser context.
+ * @return True if the field is invalid, false otherwise.
+ */
+typedef bool (*process_field_cb)(parser_context_t *parser_ctx);
+
+/**
+ * The field is only present in partial fee delegated transactions (fee ratio).
+ */
+#define TX_FIELD_PARTIAL_ONLY 0x01
+/**
+ * The transaction may end right before this field (pre EIP-155 legacy transactions).
+ */
+#define TX_FIELD_END_ALLOWED 0x02
+/**
+ * The field and the following ones are skipped without being viewed by the transaction, the
+ * chunks holding them do not have to be retained (access list).
+ */
+#define TX_FIELD_UNRETAINED 0x04
+/**
+ * The field content is only hashed or copied to the transaction, a chunk that lies within it
+ * does not have to be retained (data and memo).
+ */
+#define TX_FIELD_HASHED 0x08
+/**
+ * The field is only present in the signature preimage of the fee payer (fee payer address).
+ */
+#define TX_FIELD_FEE_PAYER_ONLY 0x10
+
+/**
+ * @brief Description of one RLP field of a transaction.
+ */
+typedef struct {
+    process_field_cb process;  /// handler consuming the field
+    uint8_t flags;             /// TX_FIELD_* flags
+} tx_field_t;
+
+/**
+ * @brief Fields displayed on the transaction review.
+ */
+typedef enum {
+    TX_REVIEW_TYPE = 1 << 0,            /// transaction type name
+    TX_REVIEW_AMOUNT = 1 << 1,          /// value sent
+    TX_REVIEW_TO = 1 << 2,              /// recipient address
+    TX_REVIEW_SMART_CONTRACT = 1 << 3,  /// recipient address, as a smart contract
+    TX_REVIEW_NONCE = 1 << 4,           /// nonce
+    TX_REVIEW_GAS_PRICE = 1 << 5,       /// gas price
+    TX_REVIEW_GAS_LIMIT = 1 << 6,       /// gas limit
+    TX_REVIEW_FEE_RATIO = 1 << 7,       /// fee ratio, when not zero
+    TX_REVIEW_MAX_FEE = 1 << 8,         /// max fee per gas, held by the gas price
+    TX_REVIEW_PRIORITY_FEE = 1 << 9,    /// max priority fee per gas
+    TX_REVIEW_ACCESS_LIST = 1 << 10,    /// number of access list entries
+    TX_REVIEW_TOKEN_CALL = 1 << 11,     /// decoded token call, when the calldata is known
+    TX_REVIEW_DATA = 1 << 12,           /// size and hash of the data, when it is not decoded
+    TX_REVIEW_MEMO = 1 << 13,           /// memo, when it is printable ASCII
+    TX_REVIEW_NETWORK_FEE = 1 << 14,    /// gas price times gas limit, when the sender pays it
+    TX_REVIEW_TOTAL_COST = 1 << 15,     /// value plus network fee, when the sender pays it all
+    TX_REVIEW_SENDER = 1 << 16,         /// sender address, on the fee payer signature
+    TX_REVIEW_FEE_PAYER = 1 << 17       /// fee payer address, on the fee payer signature
+} tx_review_field_e;
+
+/**
+ * @brief Description of a transaction type.
+ */
+struct tx_descriptor_s {
+    uint8_t type;              /// transaction_type_e value
+    uint8_t flavor;            /// txFeePayerType_e value
+    uint8_t field_count;       /// number of entries in fields
+    uint32_t review;           /// tx_review_field_e set displayed on review
+    const tx_field_t *fields;  /// RLP fields of the transaction, in order
+    const char *name;          /// name displayed on review
+};
+
+/**
+ * @brief Get the description of a transaction type.
+ *
+ * @param[in] txType The transaction type.
+ * @return The descriptor, or NULL if the type is not supported.
+ */
+const tx_descriptor_t *tx_registry_lookup(uint8_t txType);
+
+/**
+ * @brief Get the description of a field of a transaction.
+ *
+ * @param[in] descriptor The transaction descriptor.
+ * @param[in] index The index of the field in the transaction.
+ * @return The field, or NULL if the index is past the last field.
+ */
+const tx_field_t *tx_registry_field(const tx_descriptor_t *descriptor, uint8_t index);
+
+/**
+ * @brief Process a field with its handler.
+ *
+ * @param[in] field The field description.
+ * @param[in, out] parser_ctx The parser context.
+ * @return True if the field is invalid, false otherwise.
+ */
+bool tx_registry_process_field(const tx_field_t *field, parser_context_t *parser_ctx);
+
+/**
+ * @brief Get the display name of a transaction type.
+ *
+ * @param[in] descriptor The transaction descriptor.
+ * @return The name of the transaction type.
+ */
+const char *tx_registry_name(const tx_descriptor_t *descriptor);
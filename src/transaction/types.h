@@ -8,9 +8,10 @@
 #include <stddef.h>  // size_t
 #include <stdint.h>  // uint*_t
 
-#define ADDRESS_LEN  20
-#define MAX_INT256   32
-#define MAX_MEMO_LEN 465  // 510 - ADDRESS_LEN - 2*SIZE(U64) - SIZE(MAX_VARINT)
+#define ADDRESS_LEN   20
+#define MAX_INT256    32
+#define MAX_MEMO_LEN  465  // 510 - ADDRESS_LEN - 2*SIZE(U64) - SIZE(MAX_VARINT)
+#define DATA_HASH_LEN 32   // Keccak-256 digest of the data field
 
 /**
  * @brief Enumeration of parser status codes.
@@ -37,6 +38,17 @@ typedef struct uint256_t {
     uint8_t length;             // The length of the integer in bytes.
 } uint256_t;
 
+/**
+ * @brief View on a big endian integer of at most MAX_INT256 bytes.
+ *
+ * The bytes are read in place from the retained raw transaction, or from the parser staging
+ * storage when the chunks are dropped once parsed.
+ */
+typedef struct {
+    const uint8_t *value;  // The big endian bytes of the integer, NULL when length is 0.
+    uint8_t length;        // The length of the integer in bytes.
+} uint256_view_t;
+
 /**
  * @brief Enumeration of transaction types.
  */
@@ -68,17 +80,44 @@ typedef enum {
     PARTIAL_FEE_DELEGATED_CANCEL = 0x3A  // Partial fee-delegated cancel transaction type.
 } transaction_type_e;
 
+/**
+ * @brief Enumeration of the token calls decoded from the calldata of a smart contract execution.
+ */
+typedef enum {
+    TOKEN_CALL_NONE = 0,           // Calldata not decoded.
+    TOKEN_TRANSFER,                // transfer(address,uint256), ERC-20 and KIP-7.
+    TOKEN_APPROVE,                 // approve(address,uint256), ERC-20 and KIP-7.
+    TOKEN_TRANSFER_FROM,           // transferFrom(address,address,uint256), ERC-20 and KIP-7/17.
+    TOKEN_SAFE_TRANSFER,           // safeTransfer(address,uint256[,bytes]), KIP-7.
+    TOKEN_SAFE_TRANSFER_FROM       // safeTransferFrom(address,address,uint256[,bytes]), KIP-7/17.
+} token_call_e;
+
 /**
  * @brief Structure representing a transaction.
  */
 typedef struct {
-    transaction_type_e txType;  // The type of the transaction.
-    uint256_t nonce;            // The nonce of the transaction.
-    uint256_t gasprice;         // The gas price of the transaction.
-    uint256_t startgas;         // The start gas (gas limit) of the transaction.
-    uint8_t to[ADDRESS_LEN];    // The recipient address of the transaction.
-    uint8_t ratio;              // The ratio for partial fee-delegated transactions.
-    uint256_t value;            // The value (amount) of the transaction.
-    uint256_t chainID;          // The chain ID of the transaction.
-    bool dataPresent;           // Flag indicating whether data is present in the transaction.
+    transaction_type_e txType;        // The type of the transaction.
+    uint256_view_t nonce;             // The nonce of the transaction.
+    uint256_view_t gasprice;          // The gas price, or max fee per gas (EIP-1559).
+    uint256_view_t priorityFee;       // The max priority fee per gas (EIP-1559).
+    uint256_view_t startgas;          // The start gas (gas limit) of the transaction.
+    uint8_t to[ADDRESS_LEN];          // The recipient address of the transaction.
+    uint8_t toLength;                 // The length of the recipient, 0 for a contract creation.
+    uint8_t from[ADDRESS_LEN];        // The sender address of a Kaia transaction.
+    uint8_t feePayer[ADDRESS_LEN];    // The fee payer address, in fee payer signing mode.
+    bool feePayerSignature;           // Flag indicating whether the fee payer preimage is signed.
+    uint8_t ratio;                    // The ratio for partial fee-delegated transactions.
+    uint256_view_t value;             // The value (amount) of the transaction.
+    uint256_view_t chainID;           // The chain ID of the transaction.
+    bool dataPresent;                 // Flag indicating whether data is present in the transaction.
+    uint32_t accessListCount;         // The number of access list entries (EIP-2930, EIP-1559).
+    token_call_e tokenCall;           // The token call of a smart contract execution, if known.
+    uint8_t tokenFrom[ADDRESS_LEN];   // The token owner, for the *From token calls.
+    uint8_t tokenTo[ADDRESS_LEN];     // The token recipient, or spender of an approval.
+    uint8_t tokenValue[MAX_INT256];   // The token amount or ID, big endian.
+    bool tokenBytes;                  // Flag indicating whether the token call has bytes data.
+    uint32_t dataSize;                // The length of the data field, bytecode or calldata.
+    uint8_t dataHash[DATA_HASH_LEN];  // The Keccak-256 hash of the data field.
+    uint8_t memo[MAX_MEMO_LEN];       // The memo of a value transfer with memo, not terminated.
+    uint16_t memoLength;              // The length of the memo, 0 if it is not printable ASCII.
 } transaction_t;
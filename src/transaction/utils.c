@@ -17,7 +17,8 @@
 
 #include <stdint.h>   // uint*_t
 #include <stdbool.h>  // bool
-#include <string.h>   // memmove
+#include <stddef.h>   // size_t
+#include <string.h>   // memcpy, memmove
 
 #if defined(TEST)
 #include "assert.h"
@@ -27,12 +28,31 @@
 #endif
 
 #include "types.h"
+#include "utils.h"
+
+// Byte value repeated in every byte of a machine word: 4 bytes on the device, 8 on hosts
+#define BYTES_OF(x) ((size_t) -1 / 0xFF * (x))
+
+// Whether a byte of the word is below 0x20 (control) or above 0x7E (DEL or not ASCII), both tests
+// are exact: a borrow or a carry only crosses a byte already reported
+#define HAS_UNPRINTABLE(word)                                                       \
+    (((((word) - BYTES_OF(0x20)) & ~(word)) | ((word) + BYTES_OF(0x01)) | (word)) & \
+     BYTES_OF(0x80))
 
 bool transaction_utils_check_encoding(const uint8_t *memo, uint64_t memo_len) {
     LEDGER_ASSERT(memo != NULL, "NULL memo");
 
-    for (uint64_t i = 0; i < memo_len; i++) {
-        if (memo[i] > 0x7F) {
+    uint64_t i = 0;
+    // Test a whole word at a time, the memo may be unaligned
+    for (; memo_len - i >= sizeof(size_t); i += sizeof(size_t)) {
+        size_t word;
+        memcpy(&word, memo + i, sizeof(word));
+        if (HAS_UNPRINTABLE(word) != 0) {
+            return false;
+        }
+    }
+    for (; i < memo_len; i++) {
+        if (memo[i] < 0x20 || memo[i] > 0x7e) {
             return false;
         }
     }
@@ -69,3 +89,34 @@ uint32_t u32_from_BE(const uint8_t *in, uint8_t size) {
 
     return res;
 }
+
+uint8_t transaction_utils_eip155_v(const uint256_view_t *chainID, uint8_t parity, uint8_t *out) {
+    uint8_t v[MAX_V_LEN] = {0};
+    uint32_t carry = 35 + parity;
+    uint8_t high = 0;
+    uint8_t start = 0;
+
+    if (chainID->length > MAX_INT256) {
+        return 0;
+    }
+    // Legacy transactions signed without chain ID, before EIP-155
+    if (chainID->length == 0) {
+        out[0] = 27 + parity;
+        return 1;
+    }
+    // The extra leading byte receives the bit shifted out by the doubling of a 256 bits chain ID
+    memcpy(v + MAX_V_LEN - chainID->length, chainID->value, chainID->length);
+    for (int i = MAX_V_LEN - 1; i >= 0; i--) {
+        uint8_t byte = v[i];
+        // The top bit of the less significant byte moves into this one
+        carry += (uint8_t) ((byte << 1) | high);
+        high = byte >> 7;
+        v[i] = (uint8_t) carry;
+        carry >>= 8;
+    }
+    while (start < MAX_V_LEN - 1 && v[start] == 0) {
+        start++;
+    }
+    memcpy(out, v + start, MAX_V_LEN - start);
+    return MAX_V_LEN - start;
+}
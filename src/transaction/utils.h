@@ -6,7 +6,12 @@
 #include "types.h"
 
 /**
- * Checks if the given memo is encoded correctly.
+ * Maximum length of the EIP-155 v of a signature, for a chain ID of MAX_INT256 bytes.
+ */
+#define MAX_V_LEN (MAX_INT256 + 1)
+
+/**
+ * Checks if the given memo is encoded correctly, as printable ASCII (0x20 to 0x7E).
  *
  * @param memo The input memo as a pointer to a uint8_t array.
  * @param memo_len The length of the input memo.
@@ -37,3 +42,14 @@ bool transaction_utils_format_memo(const uint8_t *memo,
  */
 
 uint32_t u32_from_BE(const uint8_t *in, uint8_t size);
+
+/**
+ * Computes the EIP-155 v of a signature, chainId * 2 + 35 + parity, over up to 257 bits, or
+ * 27 + parity for a legacy transaction without chain ID.
+ *
+ * @param chainID The chain ID, big endian, up to MAX_INT256 bytes, empty if there is none.
+ * @param parity The parity of the y-coordinate of R, 0 or 1.
+ * @param out The output buffer of MAX_V_LEN bytes, receiving v big endian without leading zeroes.
+ * @return Returns the length of v, 0 if the chain ID is too long.
+ */
+uint8_t transaction_utils_eip155_v(const uint256_view_t *chainID, uint8_t parity, uint8_t *out);
@@ -1,21 +1,27 @@
 #pragma once
 
-#include <stddef.h>  // size_t
-#include <stdint.h>  // uint*_t
+#include <stdbool.h>  // bool
+#include <stddef.h>   // size_t
+#include <stdint.h>   // uint*_t
 
 #include "bip32.h"
+#include "cx.h"
 
 #include "constants.h"
 #include "transaction/types.h"
+#include "transaction/deserialize.h"
+#include "transaction/batch.h"
 
 /**
  * Enumeration with expected INS of APDU commands.
  */
 typedef enum {
-    GET_VERSION = 0x03,     /// version of the application
-    GET_APP_NAME = 0x04,    /// name of the application
-    GET_PUBLIC_KEY = 0x05,  /// public key of corresponding BIP32 path
-    SIGN_TX = 0x06          /// sign transaction with BIP32 path
+    GET_VERSION = 0x03,           /// version of the application
+    GET_APP_NAME = 0x04,          /// name of the application
+    GET_PUBLIC_KEY = 0x05,        /// public key of corresponding BIP32 path
+    SIGN_TX = 0x06,               /// sign transaction with BIP32 path
+    GET_BATCH_SIGNATURES = 0x07,  /// next signatures of an approved batch
+    GET_ADDRESSES = 0x08          /// addresses of a range of indices under a BIP32 path
 } command_e;
 /**
  * Enumeration with parsing state.
@@ -30,29 +36,57 @@ typedef enum {
  * Enumeration with user request type.
  */
 typedef enum {
-    CONFIRM_ADDRESS,     /// confirm address derived from public key
-    CONFIRM_TRANSACTION  /// confirm transaction information
+    CONFIRM_ADDRESS,      /// confirm address derived from public key
+    CONFIRM_TRANSACTION,  /// confirm transaction information
+    DISCOVER_ADDRESSES    /// send addresses of a range of indices
 } request_type_e;
 
 /**
  * Structure for public key context information.
  */
 typedef struct {
-    uint8_t raw_public_key[65];  /// format (1), x-coordinate (32), y-coodinate (32)
-    uint8_t chain_code[32];      /// for public key derivation
+    uint8_t raw_public_key[65];     /// format (1), x-coordinate (32), y-coodinate (32)
+    uint8_t chain_code[32];         /// for public key derivation
+    uint8_t parent_fingerprint[4];  /// HASH160 of the parent public key, for an extended key
 } pubkey_ctx_t;
 
+/**
+ * Structure for address discovery context information.
+ */
+typedef struct {
+    uint32_t next;     /// index of the next address to send
+    uint32_t end;      /// index after the last address requested
+    bool public_keys;  /// send compressed public keys instead of addresses
+} discovery_ctx_t;
+
+/**
+ * Structure for a BIP32 path signing a transaction.
+ */
+typedef struct {
+    uint32_t path[MAX_BIP32_PATH];  /// BIP32 path
+    uint8_t path_len;               /// length of BIP32 path
+} sign_path_t;
+
 /**
  * Structure for transaction information context.
  */
 typedef struct {
-    uint8_t raw_tx[MAX_TRANSACTION_LEN];  /// raw transaction serialized
-    size_t raw_tx_len;                    /// length of raw transaction
+#ifdef HAVE_STREAMING_SIGN_TX
+    uint8_t staging[TX_STAGING_LEN];      /// fields viewed by transaction, chunks are dropped
+#else
+    uint8_t raw_tx[MAX_TRANSACTION_LEN];  /// raw transaction serialized, viewed by transaction
+#endif
+    size_t raw_tx_len;                    /// length of raw transaction received or retained
+    parser_context_t parser_ctx;          /// parser state kept across APDU chunks
+    cx_sha3_t sha3;                       /// Keccak-256 context updated with every chunk
     transaction_t transaction;            /// structured transaction
     uint8_t m_hash[32];                   /// message hash digest
-    uint8_t signature[MAX_DER_SIG_LEN];   /// transaction signature encoded in DER
-    uint8_t signature_len;                /// length of transaction signature
+    uint8_t r[32];                        /// r value of the transaction signature
+    uint8_t s[32];                        /// s value of the transaction signature
     uint8_t v;                            /// parity of y-coordinate of R in ECDSA signature
+    sign_path_t paths[MAX_SIGN_PATHS];    /// BIP32 paths signing the transaction hash
+    uint8_t paths_count;                  /// number of BIP32 paths
+    batch_ctx_t batch;                    /// transactions of a batch, reviewed together
 } transaction_ctx_t;
 
 /**
@@ -61,8 +95,9 @@ typedef struct {
 typedef struct {
     state_e state;  /// state of the context
     union {
-        pubkey_ctx_t pk_info;       /// public key context
-        transaction_ctx_t tx_info;  /// transaction context
+        pubkey_ctx_t pk_info;            /// public key context
+        transaction_ctx_t tx_info;       /// transaction context
+        discovery_ctx_t discovery_info;  /// address discovery context
     };
     request_type_e req_type;              /// user request
     uint32_t bip32_path[MAX_BIP32_PATH];  /// BIP32 path
@@ -16,13 +16,13 @@
  *****************************************************************************/
 
 #include <stdbool.h>  // bool
-
-#include "crypto_helpers.h"
+#include <string.h>   // explicit_bzero
 
 #include "validate.h"
 #include "../menu.h"
 #include "../../sw.h"
 #include "../../globals.h"
+#include "../../helper/bip32_cache.h"
 #include "../../helper/send_response.h"
 
 void validate_pubkey(bool choice) {
@@ -33,50 +33,89 @@ void validate_pubkey(bool choice) {
     }
 }
 
-static int crypto_sign_message(void) {
+// Sign a transaction hash with one BIP32 path
+static int crypto_sign_message(const sign_path_t *path, const uint8_t *hash) {
     uint32_t info = 0;
-    size_t sig_len = sizeof(G_context.tx_info.signature);
 
-    cx_err_t error = bip32_derive_ecdsa_sign_hash_256(CX_CURVE_256K1,
-                                                      G_context.bip32_path,
-                                                      G_context.bip32_path_len,
-                                                      CX_RND_RFC6979 | CX_LAST,
-                                                      CX_SHA256,
-                                                      G_context.tx_info.m_hash,
-                                                      sizeof(G_context.tx_info.m_hash),
-                                                      G_context.tx_info.signature,
-                                                      &sig_len,
-                                                      &info);
+    cx_err_t error = bip32_cache_sign_hash(path->path,
+                                           path->path_len,
+                                           hash,
+                                           sizeof(G_context.tx_info.m_hash),
+                                           G_context.tx_info.r,
+                                           G_context.tx_info.s,
+                                           &info);
     if (error != CX_OK) {
         return -1;
     }
 
-    PRINTF("Signature: %.*H\n", sig_len, G_context.tx_info.signature);
-
-    G_context.tx_info.signature_len = sig_len;
+    PRINTF("Signature: %.*H %.*H\n", 32, G_context.tx_info.r, 32, G_context.tx_info.s);
 
-    if (info & CX_ECCINFO_PARITY_ODD) {
-        G_context.tx_info.v = CX_ECCINFO_PARITY_ODD;
-    }
-    if (info & CX_ECCINFO_xGTn) {
-        G_context.tx_info.v = CX_ECCINFO_xGTn;
-    }
+    G_context.tx_info.v = (info & CX_ECCINFO_PARITY_ODD) ? 1 : 0;
 
     return 0;
 }
 
 void validate_transaction(bool choice) {
     if (choice) {
+        uint8_t resp[MAX_APDU_SIZE];
+        size_t offset = 0;
+
         G_context.state = STATE_APPROVED;
+        if (G_context.tx_info.batch.count != 0) {
+            validate_batch_signatures();
+            return;
+        }
 
-        if (crypto_sign_message() != 0) {
-            G_context.state = STATE_NONE;
-            io_send_sw(SW_SIGNATURE_FAIL);
-        } else {
-            helper_send_response_sig();
+        // The hash computed once is signed with each path, in the order of the request
+        for (uint8_t i = 0; i < G_context.tx_info.paths_count; i++) {
+            size_t record_len;
+
+            if (crypto_sign_message(&G_context.tx_info.paths[i], G_context.tx_info.m_hash) != 0) {
+                G_context.state = STATE_NONE;
+                io_send_sw(SW_SIGNATURE_FAIL);
+                return;
+            }
+            // Only a chain ID longer than 19 bytes leaves no room for the record of a third path
+            record_len = helper_format_sig(resp + offset, sizeof(resp) - offset);
+            if (record_len == 0) {
+                G_context.state = STATE_NONE;
+                io_send_sw(SW_WRONG_RESPONSE_LENGTH);
+                return;
+            }
+            offset += record_len;
         }
+        helper_send_response_sig(resp, offset);
     } else {
         G_context.state = STATE_NONE;
         io_send_sw(SW_DENY);
     }
 }
+
+int validate_batch_signatures(void) {
+    batch_ctx_t *batch = &G_context.tx_info.batch;
+    uint8_t resp[MAX_APDU_SIZE];
+    size_t offset = 0;
+
+    // The transactions are signed as their signatures are requested, in the order of the batch
+    for (uint8_t records = 0; records < MAX_RESPONSE_SIGS && batch->sent < batch->count;
+         records++) {
+        const batch_entry_t *entry = &batch->entries[batch->sent];
+        size_t record_len;
+
+        if (crypto_sign_message(&G_context.tx_info.paths[0], entry->hash) != 0) {
+            explicit_bzero(&G_context, sizeof(G_context));
+            return io_send_sw(SW_SIGNATURE_FAIL);
+        }
+        // A record without room is signed again, deterministically, on the next request
+        record_len = helper_format_sig(resp + offset, sizeof(resp) - offset);
+        if (record_len == 0) {
+            break;
+        }
+        offset += record_len;
+        batch->sent++;
+    }
+    if (batch->sent == batch->count) {
+        G_context.state = STATE_NONE;
+    }
+    return helper_send_response_sig(resp, offset);
+}
@@ -19,3 +19,12 @@ void validate_pubkey(bool choice);
  *
  */
 void validate_transaction(bool choice);
+
+/**
+ * Action for the signatures of an approved batch: sign the transactions whose signatures are
+ * not sent yet, and send as many signature records as fit in one response.
+ *
+ * @return zero or positive integer if success, -1 otherwise.
+ *
+ */
+int validate_batch_signatures(void);
@@ -18,7 +18,7 @@
 #ifdef HAVE_BAGL
 
 #include <stdbool.h>  // bool
-#include <string.h>   // memset
+#include <string.h>   // memset, strncpy, explicit_bzero
 
 #include "os.h"
 #include "ux.h"
@@ -28,26 +28,22 @@
 #include "format.h"
 
 #include "display.h"
+#include "review_strings.h"
 #include "constants.h"
 #include "../globals.h"
 #include "../sw.h"
 #include "../address.h"
 #include "action/validate.h"
 #include "../transaction/types.h"
-#include "../helper/format.h"
+#include "../transaction/registry.h"
 #include "../menu.h"
 
-#define MAX_FLOW_STEPS 18
+// Review step, one step for each pair, approve and reject steps, end of flow
+#define MAX_FLOW_STEPS (1 + REVIEW_MAX_PAIRS + 3)
 
 static action_validate_cb g_validate_callback;
-static char g_type[50];
-static char g_nonce[30];
-static char g_gasPrice[30];
-static char g_gasLimit[30];
-static char g_to[43];
 static char g_address[43];
-static char g_feeRatio[30];
-static char g_amount[50];
+static review_strings_t g_review;
 
 // Validate/Invalidate public key and go back to home
 static void ui_action_validate_pubkey(bool choice) {
@@ -128,263 +124,237 @@ UX_STEP_NOCB(ux_display_review_step,
                  "Transaction",
              });
 
-// Step with title/text for transaction type
-UX_STEP_NOCB(ux_display_type_step,
-             bnnn_paging,
-             {
-                 .title = "Type",
-                 .text = g_type,
-             });
-// Step with title/text for nonce
-UX_STEP_NOCB(ux_display_nonce_step,
-             bnnn_paging,
+// Pairs of the transaction review, the label and value of the one displayed are copied to
+// g_pair_label and g_pair_value, shared by the review steps
+static review_pair_t g_pairs[REVIEW_MAX_PAIRS];
+static char g_pair_label[20];
+static char g_pair_value[MAX_MEMO_LEN + 1];  // the memo is the longest value
+
+// Copy the pair shown by a review step before the step is displayed
+static void set_review_pair(uint8_t index) {
+    strncpy(g_pair_label, g_pairs[index].label, sizeof(g_pair_label) - 1);
+    strncpy(g_pair_value, g_pairs[index].value, sizeof(g_pair_value) - 1);
+}
+
+// Step with title/text for the pair of index _index of the review
+#define UX_REVIEW_PAIR_STEP(_index)                    \
+    UX_STEP_NOCB_INIT(ux_display_pair_##_index##_step, \
+                      bnnn_paging,                     \
+                      set_review_pair(_index),         \
+                      {                                \
+                          .title = g_pair_label,       \
+                          .text = g_pair_value,        \
+                      })
+
+UX_REVIEW_PAIR_STEP(0);
+UX_REVIEW_PAIR_STEP(1);
+UX_REVIEW_PAIR_STEP(2);
+UX_REVIEW_PAIR_STEP(3);
+UX_REVIEW_PAIR_STEP(4);
+UX_REVIEW_PAIR_STEP(5);
+UX_REVIEW_PAIR_STEP(6);
+UX_REVIEW_PAIR_STEP(7);
+UX_REVIEW_PAIR_STEP(8);
+UX_REVIEW_PAIR_STEP(9);
+UX_REVIEW_PAIR_STEP(10);
+UX_REVIEW_PAIR_STEP(11);
+UX_REVIEW_PAIR_STEP(12);
+UX_REVIEW_PAIR_STEP(13);
+UX_REVIEW_PAIR_STEP(14);
+UX_REVIEW_PAIR_STEP(15);
+
+static const ux_flow_step_t *const ux_display_pair_steps[] = {
+    &ux_display_pair_0_step,
+    &ux_display_pair_1_step,
+    &ux_display_pair_2_step,
+    &ux_display_pair_3_step,
+    &ux_display_pair_4_step,
+    &ux_display_pair_5_step,
+    &ux_display_pair_6_step,
+    &ux_display_pair_7_step,
+    &ux_display_pair_8_step,
+    &ux_display_pair_9_step,
+    &ux_display_pair_10_step,
+    &ux_display_pair_11_step,
+    &ux_display_pair_12_step,
+    &ux_display_pair_13_step,
+    &ux_display_pair_14_step,
+    &ux_display_pair_15_step,
+};
+_Static_assert(sizeof(ux_display_pair_steps) / sizeof(ux_display_pair_steps[0]) ==
+                   REVIEW_MAX_PAIRS,
+               "One review step for each pair");
+
+// Build the review flow from the pairs of review_strings_pairs(), listed in the same order as
+// on NBGL and by the host tools
+static void handle_display_transaction(const tx_descriptor_t *descriptor) {
+    ux_flow_step_t static const *ux_display_flow[MAX_FLOW_STEPS];
+    size_t count =
+        review_strings_pairs(descriptor, &G_context.tx_info.transaction, &g_review, g_pairs);
+    int current_step = 0;
+
+    ux_display_flow[current_step++] = &ux_display_review_step;
+    for (size_t i = 0; i < count; i++) {
+        ux_display_flow[current_step++] = ux_display_pair_steps[i];
+    }
+    ux_display_flow[current_step++] = &ux_display_approve_step;
+    ux_display_flow[current_step++] = &ux_display_reject_step;
+    ux_display_flow[current_step++] = FLOW_END_STEP;
+
+    ux_flow_init(0, ux_display_flow, NULL);
+}
+
+int ui_display_transaction() {
+    if (G_context.req_type != CONFIRM_TRANSACTION || G_context.state != STATE_PARSED) {
+        G_context.state = STATE_NONE;
+        return io_send_sw(SW_BAD_STATE);
+    }
+
+    uint16_t sw = review_strings_format(&G_context.tx_info.transaction, &g_review);
+    if (sw != SW_OK) {
+        return io_send_sw(sw);
+    }
+
+    g_validate_callback = &ui_action_validate_transaction;
+
+    const tx_descriptor_t *descriptor = tx_registry_lookup(G_context.tx_info.transaction.txType);
+    handle_display_transaction(descriptor);
+    return DISPLAY_OK;
+}
+
+// Strings of the batch review, and transaction shown in detail
+static review_batch_strings_t g_batch;
+static uint8_t g_batch_entry;
+
+static void ui_batch_show_details(void);
+static void ui_batch_next_entry(void);
+
+// Step with icon and text
+UX_STEP_NOCB(ux_batch_review_step,
+             pnn,
              {
-                 .title = "Nonce",
-                 .text = g_nonce,
+                 &C_icon_eye,
+                 "Review",
+                 "Batch",
              });
-
-// Step with title/text for gas price
-UX_STEP_NOCB(ux_display_gas_price_step,
+// Step with title/text for the type of the transactions
+UX_STEP_NOCB(ux_batch_type_step,
              bnnn_paging,
              {
-                 .title = "Gas Price",
-                 .text = g_gasPrice,
+                 .title = "Type",
+                 .text = g_batch.type,
              });
-// Step with title/text for gas limit
-UX_STEP_NOCB(ux_display_gas_limit_step,
+// Step with title/text for the number of transactions
+UX_STEP_NOCB(ux_batch_count_step,
              bnnn_paging,
              {
-                 .title = "Gas Limit",
-                 .text = g_gasLimit,
+                 .title = "Transactions",
+                 .text = g_batch.count,
              });
-// Step with title/text for destination address
-UX_STEP_NOCB(ux_display_to_step,
+// Step with title/text for the number of distinct recipients
+UX_STEP_NOCB(ux_batch_recipients_step,
              bnnn_paging,
              {
-                 .title = "To",
-                 .text = g_to,
+                 .title = "Recipients",
+                 .text = g_batch.recipients,
              });
-
-// Step with title/text for Smart Contract
-UX_STEP_NOCB(ux_display_smart_contract_step,
+// Step with title/text for the sum of the values
+UX_STEP_NOCB(ux_batch_total_amount_step,
              bnnn_paging,
              {
-                 .title = "Smart Contract",
-                 .text = g_to,
+                 .title = "Total Amount",
+                 .text = g_batch.totalAmount,
              });
-// Step with title/text for fee ratio
-UX_STEP_NOCB(ux_display_fee_ratio_step,
+// Step with title/text for the sum of the network fees
+UX_STEP_NOCB(ux_batch_total_fee_step,
              bnnn_paging,
              {
-                 .title = "Fee Ratio",
-                 .text = g_feeRatio,
+                 .title = "Max Network Fees",
+                 .text = g_batch.totalFee,
              });
-// Step with title/text for amount
-UX_STEP_NOCB(ux_display_amount_step,
+// Step with button to review each transaction
+UX_STEP_CB(ux_batch_details_step,
+           pb,
+           ui_batch_show_details(),
+           {
+               &C_icon_eye,
+               "Review each",
+           });
+// Step with title/text for the transaction shown in detail
+UX_STEP_NOCB(ux_batch_entry_step,
              bnnn_paging,
              {
-                 .title = "Amount",
-                 .text = g_amount,
+                 .title = g_batch.title,
+                 .text = g_batch.entry,
              });
+// Step with button to the next transaction, or back to the totals after the last one
+UX_STEP_CB(ux_batch_next_step,
+           pb,
+           ui_batch_next_entry(),
+           {
+               &C_icon_eye,
+               "Next",
+           });
 
-UX_FLOW(ux_display_legacy_transaction_flow,
-        &ux_display_review_step,
-        &ux_display_type_step,
-        &ux_display_amount_step,
-        &ux_display_to_step,
-        &ux_display_nonce_step,
-        &ux_display_gas_price_step,
-        &ux_display_gas_limit_step,
+// FLOW to display a batch:
+// #1 screen: eye icon + "Review Batch"
+// #2 to #6 screens: totals of the batch
+// #7 screen: button to review each transaction
+// #8 screen: approve button
+// #9 screen: reject button
+UX_FLOW(ux_batch_flow,
+        &ux_batch_review_step,
+        &ux_batch_type_step,
+        &ux_batch_count_step,
+        &ux_batch_recipients_step,
+        &ux_batch_total_amount_step,
+        &ux_batch_total_fee_step,
+        &ux_batch_details_step,
         &ux_display_approve_step,
         &ux_display_reject_step);
 
-static void handle_display_legacy() {
-    ux_flow_init(0, ux_display_legacy_transaction_flow, NULL);
-}
-
-static void handle_display_value_transfer() {
-    ux_flow_step_t static const *ux_display_flow[MAX_FLOW_STEPS];
-    int current_step = 0;
-
-    ux_display_flow[current_step++] = &ux_display_review_step;
-    ux_display_flow[current_step++] = &ux_display_type_step;
-    ux_display_flow[current_step++] = &ux_display_amount_step;
-    ux_display_flow[current_step++] = &ux_display_to_step;
-    ux_display_flow[current_step++] = &ux_display_nonce_step;
-    ux_display_flow[current_step++] = &ux_display_gas_price_step;
-    ux_display_flow[current_step++] = &ux_display_gas_limit_step;
-
-    if (G_context.tx_info.transaction.ratio != 0) {
-        ux_display_flow[current_step++] = &ux_display_fee_ratio_step;
-    }
-
-    ux_display_flow[current_step++] = &ux_display_approve_step;
-    ux_display_flow[current_step++] = &ux_display_reject_step;
-    ux_display_flow[current_step++] = FLOW_END_STEP;
-
-    ux_flow_init(0, ux_display_flow, NULL);
-}
-
-static void handle_display_smart_contract_deploy() {
-    ux_flow_step_t static const *ux_display_flow[MAX_FLOW_STEPS];
-    int current_step = 0;
-
-    ux_display_flow[current_step++] = &ux_display_review_step;
-    ux_display_flow[current_step++] = &ux_display_type_step;
-    ux_display_flow[current_step++] = &ux_display_amount_step;
-    ux_display_flow[current_step++] = &ux_display_nonce_step;
-    ux_display_flow[current_step++] = &ux_display_gas_price_step;
-    ux_display_flow[current_step++] = &ux_display_gas_limit_step;
-
-    if (G_context.tx_info.transaction.ratio != 0) {
-        ux_display_flow[current_step++] = &ux_display_fee_ratio_step;
+// FLOW to display one transaction of a batch:
+// #1 screen: amount, recipient and nonce
+// #2 screen: button to the next transaction
+UX_FLOW(ux_batch_entry_flow, &ux_batch_entry_step, &ux_batch_next_step);
+
+// Show the transaction g_batch_entry, or the totals once all are shown
+static void ui_batch_show_entry(void) {
+    if (g_batch_entry >= G_context.tx_info.batch.count ||
+        review_strings_format_batch_entry(&G_context.tx_info.batch, g_batch_entry, &g_batch) !=
+            SW_OK) {
+        ux_flow_init(0, ux_batch_flow, NULL);
+        return;
     }
-
-    ux_display_flow[current_step++] = &ux_display_approve_step;
-    ux_display_flow[current_step++] = &ux_display_reject_step;
-    ux_display_flow[current_step++] = FLOW_END_STEP;
-
-    ux_flow_init(0, ux_display_flow, NULL);
+    ux_flow_init(0, ux_batch_entry_flow, NULL);
 }
 
-static void handle_display_smart_contract_execution() {
-    ux_flow_step_t static const *ux_display_flow[MAX_FLOW_STEPS];
-    int current_step = 0;
-
-    ux_display_flow[current_step++] = &ux_display_review_step;
-    ux_display_flow[current_step++] = &ux_display_type_step;
-    ux_display_flow[current_step++] = &ux_display_amount_step;
-    ux_display_flow[current_step++] = &ux_display_smart_contract_step;
-    ux_display_flow[current_step++] = &ux_display_nonce_step;
-    ux_display_flow[current_step++] = &ux_display_gas_price_step;
-    ux_display_flow[current_step++] = &ux_display_gas_limit_step;
-
-    if (G_context.tx_info.transaction.ratio != 0) {
-        ux_display_flow[current_step++] = &ux_display_fee_ratio_step;
-    }
-
-    ux_display_flow[current_step++] = &ux_display_approve_step;
-    ux_display_flow[current_step++] = &ux_display_reject_step;
-    ux_display_flow[current_step++] = FLOW_END_STEP;
-
-    ux_flow_init(0, ux_display_flow, NULL);
+static void ui_batch_show_details(void) {
+    g_batch_entry = 0;
+    ui_batch_show_entry();
 }
 
-static void handle_display_cancel() {
-    ux_flow_step_t static const *ux_display_flow[MAX_FLOW_STEPS];
-    int current_step = 0;
-
-    ux_display_flow[current_step++] = &ux_display_review_step;
-    ux_display_flow[current_step++] = &ux_display_type_step;
-    ux_display_flow[current_step++] = &ux_display_nonce_step;
-    ux_display_flow[current_step++] = &ux_display_gas_price_step;
-
-    if (G_context.tx_info.transaction.ratio != 0) {
-        ux_display_flow[current_step++] = &ux_display_fee_ratio_step;
-    }
-
-    ux_display_flow[current_step++] = &ux_display_gas_limit_step;
-    ux_display_flow[current_step++] = &ux_display_approve_step;
-    ux_display_flow[current_step++] = &ux_display_reject_step;
-    ux_display_flow[current_step++] = FLOW_END_STEP;
-
-    ux_flow_init(0, ux_display_flow, NULL);
+static void ui_batch_next_entry(void) {
+    g_batch_entry++;
+    ui_batch_show_entry();
 }
 
-int ui_display_transaction() {
+int ui_display_batch() {
     if (G_context.req_type != CONFIRM_TRANSACTION || G_context.state != STATE_PARSED) {
         G_context.state = STATE_NONE;
         return io_send_sw(SW_BAD_STATE);
     }
 
-    memset(g_type, 0, sizeof(g_type));
-    memset(g_nonce, 0, sizeof(g_nonce));
-    memset(g_gasPrice, 0, sizeof(g_gasPrice));
-    memset(g_gasLimit, 0, sizeof(g_gasLimit));
-    memset(g_to, 0, sizeof(g_to));
-    memset(g_feeRatio, 0, sizeof(g_feeRatio));
-    memset(g_amount, 0, sizeof(g_amount));
-
-    char type[50] = {0};
-    if (!format_transaction_type(G_context.tx_info.transaction.txType, type, sizeof(type))) {
-        return io_send_sw(SW_DISPLAY_TYPE_FAIL);
+    uint16_t sw = review_strings_format_batch(&G_context.tx_info.batch, &g_batch);
+    if (sw != SW_OK) {
+        // Drop the batch, which would otherwise refuse the next transactions
+        explicit_bzero(&G_context, sizeof(G_context));
+        return io_send_sw(sw);
     }
-    strncpy(g_type, type, sizeof(g_type));
-
-    char nonce[30] = {0};
-    uint64_t nonceValue = convertUint256ToUint64(&G_context.tx_info.transaction.nonce);
-    if (!format_u64(nonce, sizeof(nonce), nonceValue)) {
-        return io_send_sw(SW_DISPLAY_NONCE_FAIL);
-    }
-    strncpy(g_nonce, nonce, sizeof(g_nonce));
-
-    char gasPrice[30] = {0};
-    uint64_t gasPriceValue = convertUint256ToUint64(&G_context.tx_info.transaction.gasprice);
-    if (!format_u64(gasPrice, sizeof(gasPrice), gasPriceValue)) {
-        return io_send_sw(SW_DISPLAY_GASPRICE_FAIL);
-    }
-    strncpy(g_gasPrice, gasPrice, sizeof(g_gasPrice));
-
-    char gasLimit[30] = {0};
-    uint64_t gasLimitValue = convertUint256ToUint64(&G_context.tx_info.transaction.startgas);
-    if (!format_u64(gasLimit, sizeof(gasLimit), gasLimitValue)) {
-        return io_send_sw(SW_DISPLAY_GAS_FAIL);
-    }
-    strncpy(g_gasLimit, gasLimit, sizeof(g_gasLimit));
-
-    if (format_hex(G_context.tx_info.transaction.to, ADDRESS_LEN, g_to, sizeof(g_to)) == -1) {
-        return io_send_sw(SW_DISPLAY_ADDRESS_FAIL);
-    }
-
-    char feeRatio[30] = {0};
-    if (!format_u64(feeRatio, sizeof(feeRatio), G_context.tx_info.transaction.ratio)) {
-        return io_send_sw(SW_DISPLAY_FEERATIO_FAIL);
-    }
-    strncpy(g_feeRatio, feeRatio, sizeof(g_feeRatio));
-    strncat(g_feeRatio, "%%", 1);  // append '%' sign
-
-    char amount[50] = {0};
-    if (!amount_to_string(G_context.tx_info.transaction.value,
-                          EXPONENT_SMALLEST_UNIT,
-                          amount,
-                          sizeof(amount))) {
-        return io_send_sw(SW_DISPLAY_AMOUNT_FAIL);
-    }
-    snprintf(g_amount, sizeof(g_amount), "KAIA %.*s", sizeof(amount), amount);
 
     g_validate_callback = &ui_action_validate_transaction;
 
-    switch (G_context.tx_info.transaction.txType) {
-        case LEGACY:
-            handle_display_legacy();
-            break;
-        case VALUE_TRANSFER:
-        case FEE_DELEGATED_VALUE_TRANSFER:
-        case PARTIAL_FEE_DELEGATED_VALUE_TRANSFER:
-        case VALUE_TRANSFER_MEMO:
-        case FEE_DELEGATED_VALUE_TRANSFER_MEMO:
-        case PARTIAL_FEE_DELEGATED_VALUE_TRANSFER_MEMO:
-            handle_display_value_transfer();
-            break;
-        case SMART_CONTRACT_DEPLOY:
-        case FEE_DELEGATED_SMART_CONTRACT_DEPLOY:
-        case PARTIAL_FEE_DELEGATED_SMART_CONTRACT_DEPLOY:
-            handle_display_smart_contract_deploy();
-            break;
-        case SMART_CONTRACT_EXECUTION:
-        case FEE_DELEGATED_SMART_CONTRACT_EXECUTION:
-        case PARTIAL_FEE_DELEGATED_SMART_CONTRACT_EXECUTION:
-            handle_display_smart_contract_execution();
-            break;
-        case CANCEL:
-        case FEE_DELEGATED_CANCEL:
-        case PARTIAL_FEE_DELEGATED_CANCEL:
-            handle_display_cancel();
-            break;
-        default:
-            PRINTF("Transaction type %d is not supported\n", G_context.tx_info.transaction.txType);
-            return DISPLAY_ERROR;
-    }
+    ux_flow_init(0, ux_batch_flow, NULL);
     return DISPLAY_OK;
 }
 
@@ -25,3 +25,12 @@ int ui_display_address(void);
  *
  */
 int ui_display_transaction(void);
+
+/**
+ * Display the totals of a batch of transactions on the device, with the detail of each one on
+ * request, and ask confirmation to sign them all.
+ *
+ * @return 0 if success, negative integer otherwise.
+ *
+ */
+int ui_display_batch(void);
@@ -22,12 +22,19 @@
 #include "glyphs.h"
 
 #include "../globals.h"
+#include "../helper/bip32_cache.h"
 #include "menu.h"
 
+// Wipe the cached derivation node and exit the app
+static void app_quit(void) {
+    bip32_cache_wipe();
+    os_sched_exit(-1);
+}
+
 UX_STEP_NOCB(ux_menu_ready_step, pnn, {&C_app_kaia_16px, "Kaia", "is ready"});
 UX_STEP_NOCB(ux_menu_version_step, bn, {"Version", APPVERSION});
 UX_STEP_CB(ux_menu_about_step, pb, ui_menu_about(), {&C_icon_certificate, "About"});
-UX_STEP_VALID(ux_menu_exit_step, pb, os_sched_exit(-1), {&C_icon_dashboard_x, "Quit"});
+UX_STEP_VALID(ux_menu_exit_step, pb, app_quit(), {&C_icon_dashboard_x, "Quit"});
 
 // FLOW for the main menu:
 // #1 screen: ready
@@ -23,6 +23,7 @@
 #include "nbgl_use_case.h"
 
 #include "../globals.h"
+#include "../helper/bip32_cache.h"
 #include "menu.h"
 
 //  -----------------------------------------------------------
@@ -30,6 +31,7 @@
 //  -----------------------------------------------------------
 
 void app_quit(void) {
+    bip32_cache_wipe();
     // exit app here
     os_sched_exit(-1);
 }
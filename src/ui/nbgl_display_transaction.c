@@ -18,7 +18,7 @@
 #ifdef HAVE_NBGL
 
 #include <stdbool.h>  // bool
-#include <string.h>   // memset
+#include <string.h>   // memset, explicit_bzero
 
 #include "os.h"
 #include "glyphs.h"
@@ -26,29 +26,22 @@
 #include "nbgl_use_case.h"
 #include "io.h"
 #include "bip32.h"
-#include "format.h"
-#include "helper/format.h"
 
 #include "display.h"
+#include "review_strings.h"
 #include "constants.h"
 #include "../globals.h"
 #include "../sw.h"
 #include "../address.h"
 #include "action/validate.h"
 #include "../transaction/types.h"
+#include "../transaction/registry.h"
 #include "../menu.h"
 
-// Buffer where the transaction amount string is written
-static char g_amount[50];
-// Buffer where the transaction address string is written
-static char g_to[43];
-static char g_type[50];
-static char g_nonce[30];
-static char g_gasPrice[30];
-static char g_gasLimit[30];
-static char g_feeRatio[30];
-
-static nbgl_layoutTagValue_t pairs[7];
+// Strings of the transaction review
+static review_strings_t g_review;
+
+static nbgl_layoutTagValue_t pairs[REVIEW_MAX_PAIRS];
 static nbgl_layoutTagValueList_t pairList;
 static nbgl_pageInfoLongPress_t infoLongPress;
 
@@ -78,292 +71,163 @@ static void review_choice(bool confirm) {
     }
 }
 
-static void handle_display_legacy() {
-    // Setup data to display
-
-    int i = 0;
-    pairs[i].item = "Type";
-    pairs[i++].value = g_type;
-
-    pairs[i].item = "Amount";
-    pairs[i++].value = g_amount;
-
-    pairs[i].item = "To";
-    pairs[i++].value = g_to;
-
-    pairs[i].item = "Gas Price";
-    pairs[i++].value = g_gasPrice;
-
-    pairs[i].item = "Gas Limit";
-    pairs[i++].value = g_gasLimit;
-
-    pairs[i].item = "Nonce";
-    pairs[i++].value = g_nonce;
+// Setup the fields listed in the review set of the transaction type
+static void review_continue(void) {
+    const tx_descriptor_t *descriptor =
+        tx_registry_lookup(G_context.tx_info.transaction.txType);
+    review_pair_t review_pairs[REVIEW_MAX_PAIRS];
+    size_t count =
+        review_strings_pairs(descriptor, &G_context.tx_info.transaction, &g_review, review_pairs);
+
+    for (size_t i = 0; i < count; i++) {
+        pairs[i].item = review_pairs[i].label;
+        pairs[i].value = review_pairs[i].value;
+    }
 
     // Setup list
     pairList.nbMaxLinesForValue = 0;
-    pairList.nbPairs = i;
+    pairList.nbPairs = count;
     pairList.pairs = pairs;
 
     // Info long press
     infoLongPress.icon = &C_app_kaia_64px;
-    infoLongPress.text = "Sign transaction\nto send KAIA";
+    infoLongPress.text = G_context.tx_info.transaction.feePayerSignature
+                             ? "Sign transaction\nas its fee payer"
+                             : "Sign transaction\nto send KAIA";
     infoLongPress.longPressText = "Hold to sign";
-}
-
-static void handle_display_value_transfer() {
-    // Setup data to display
-
-    int i = 0;
-    pairs[i].item = "Type";
-    pairs[i++].value = g_type;
-
-    pairs[i].item = "Amount";
-    pairs[i++].value = g_amount;
 
-    pairs[i].item = "To";
-    pairs[i++].value = g_to;
-
-    pairs[i].item = "Gas Price";
-    pairs[i++].value = g_gasPrice;
-
-    pairs[i].item = "Gas Limit";
-    pairs[i++].value = g_gasLimit;
-
-    pairs[i].item = "Nonce";
-    pairs[i++].value = g_nonce;
+    nbgl_useCaseStaticReview(&pairList, &infoLongPress, "Reject transaction", review_choice);
+}
 
-    if (G_context.tx_info.transaction.ratio != 0) {
-        pairs[i].item = "Fee Ratio";
-        pairs[i++].value = g_feeRatio;
+// Public function to start the transaction review
+// - Check if the app is in the right state for transaction review
+// - Format the strings of the review in g_review
+// - Display the first screen of the transaction review
+int ui_display_transaction() {
+    if (G_context.req_type != CONFIRM_TRANSACTION || G_context.state != STATE_PARSED) {
+        G_context.state = STATE_NONE;
+        return io_send_sw(SW_BAD_STATE);
     }
 
-    // Setup list
-    pairList.nbMaxLinesForValue = 0;
-    pairList.nbPairs = i;
-    pairList.pairs = pairs;
+    uint16_t sw = review_strings_format(&G_context.tx_info.transaction, &g_review);
+    if (sw != SW_OK) {
+        return io_send_sw(sw);
+    }
 
-    // Info long press
-    infoLongPress.icon = &C_app_kaia_64px;
-    infoLongPress.text = "Sign transaction\nto send KAIA";
-    infoLongPress.longPressText = "Hold to sign";
+    // Start review
+    PRINTF("Displaying transaction review\n");
+    nbgl_useCaseReviewStart(&C_app_kaia_64px,
+                            G_context.tx_info.transaction.feePayerSignature
+                                ? "Review transaction\nas its fee payer"
+                                : "Review transaction\nto send KAIA",
+                            NULL,
+                            "Reject transaction",
+                            review_continue,
+                            ask_transaction_rejection_confirmation);
+    return DISPLAY_OK;
 }
 
-static void handle_display_smart_contract_deploy() {
-    // Setup data to display
-    int i = 0;
-
-    pairs[i].item = "Type";
-    pairs[i++].value = g_type;
-
-    pairs[i].item = "Amount";
-    pairs[i++].value = g_amount;
-
-    pairs[i].item = "Gas Price";
-    pairs[i++].value = g_gasPrice;
+// Strings of the batch review, and transaction shown in detail
+static review_batch_strings_t g_batch;
+static uint8_t g_batch_entry;
 
-    pairs[i].item = "Gas Limit";
-    pairs[i++].value = g_gasLimit;
-
-    pairs[i].item = "Nonce";
-    pairs[i++].value = g_nonce;
-
-    if (G_context.tx_info.transaction.ratio != 0) {
-        pairs[i].item = "Fee Ratio";
-        pairs[i++].value = g_feeRatio;
+// called when long press button on the batch summary is long-touched or when reject footer is
+// touched
+static void review_batch_choice(bool confirm) {
+    if (confirm) {
+        validate_transaction(true);
+        nbgl_useCaseStatus("BATCH\nSIGNED", true, ui_menu_main);
+    } else {
+        ask_transaction_rejection_confirmation();
     }
-
-    // Setup list
-    pairList.nbMaxLinesForValue = 0;
-    pairList.nbPairs = i;
-    pairList.pairs = pairs;
-
-    // Info long press
-    infoLongPress.icon = &C_app_kaia_64px;
-    infoLongPress.text = "Sign transaction\nto send KAIA";
-    infoLongPress.longPressText = "Hold to sign";
 }
 
-static void handle_display_smart_contract_execution() {
-    // Setup data to display
-    int i = 0;
-
-    pairs[i].item = "Type";
-    pairs[i++].value = g_type;
-
-    pairs[i].item = "Amount";
-    pairs[i++].value = g_amount;
+// Setup the totals of the batch
+static void review_batch_summary(void) {
+    review_pair_t review_pairs[REVIEW_BATCH_PAIRS];
+    size_t count = review_strings_batch_pairs(&g_batch, review_pairs);
 
-    pairs[i].item = "Smart Contract";
-    pairs[i++].value = g_to;
-
-    pairs[i].item = "Gas Price";
-    pairs[i++].value = g_gasPrice;
-
-    pairs[i].item = "Gas Limit";
-    pairs[i++].value = g_gasLimit;
-
-    pairs[i].item = "Nonce";
-    pairs[i++].value = g_nonce;
-
-    if (G_context.tx_info.transaction.ratio != 0) {
-        pairs[i].item = "Fee Ratio";
-        pairs[i++].value = g_feeRatio;
+    for (size_t i = 0; i < count; i++) {
+        pairs[i].item = review_pairs[i].label;
+        pairs[i].value = review_pairs[i].value;
     }
 
-    // Setup list
     pairList.nbMaxLinesForValue = 0;
-    pairList.nbPairs = i;
+    pairList.nbPairs = count;
     pairList.pairs = pairs;
 
-    // Info long press
     infoLongPress.icon = &C_app_kaia_64px;
-    infoLongPress.text = "Sign transaction\nto send KAIA";
+    infoLongPress.text = "Sign batch\nof transactions";
     infoLongPress.longPressText = "Hold to sign";
-}
-
-static void handle_display_cancel() {
-    // Setup data to display
-    int i = 0;
-
-    pairs[i].item = "Type";
-    pairs[i++].value = g_type;
-
-    pairs[i].item = "Amount";
-    pairs[i++].value = g_amount;
 
-    pairs[i].item = "Gas Price";
-    pairs[i++].value = g_gasPrice;
-
-    pairs[i].item = "Gas Limit";
-    pairs[i++].value = g_gasLimit;
+    nbgl_useCaseStaticReview(&pairList, &infoLongPress, "Reject batch", review_batch_choice);
+}
 
-    pairs[i].item = "Nonce";
-    pairs[i++].value = g_nonce;
+static void review_batch_entry_choice(bool next);
 
-    if (G_context.tx_info.transaction.ratio != 0) {
-        pairs[i].item = "Fee Ratio";
-        pairs[i++].value = g_feeRatio;
+// Show the transaction g_batch_entry, the next one or the summary follows
+static void review_batch_entry(void) {
+    if (review_strings_format_batch_entry(&G_context.tx_info.batch, g_batch_entry, &g_batch) !=
+        SW_OK) {
+        review_batch_summary();
+        return;
     }
+    nbgl_useCaseChoice(&C_app_kaia_64px,
+                       g_batch.title,
+                       g_batch.entry,
+                       "Next",
+                       "Skip to summary",
+                       review_batch_entry_choice);
+}
 
-    // Setup list
-    pairList.nbMaxLinesForValue = 0;
-    pairList.nbPairs = i;
-    pairList.pairs = pairs;
-
-    // Info long press
-    infoLongPress.icon = &C_app_kaia_64px;
-    infoLongPress.text = "Sign transaction\nto send KAIA";
-    infoLongPress.longPressText = "Hold to sign";
+static void review_batch_entry_choice(bool next) {
+    g_batch_entry++;
+    if (next && g_batch_entry < G_context.tx_info.batch.count) {
+        review_batch_entry();
+    } else {
+        review_batch_summary();
+    }
 }
 
-static void review_continue(void) {
-    switch (G_context.tx_info.transaction.txType) {
-        case LEGACY:
-            handle_display_legacy();
-            break;
-        case VALUE_TRANSFER:
-        case FEE_DELEGATED_VALUE_TRANSFER:
-        case PARTIAL_FEE_DELEGATED_VALUE_TRANSFER:
-        case VALUE_TRANSFER_MEMO:
-        case FEE_DELEGATED_VALUE_TRANSFER_MEMO:
-        case PARTIAL_FEE_DELEGATED_VALUE_TRANSFER_MEMO:
-            handle_display_value_transfer();
-            break;
-        case SMART_CONTRACT_DEPLOY:
-        case FEE_DELEGATED_SMART_CONTRACT_DEPLOY:
-        case PARTIAL_FEE_DELEGATED_SMART_CONTRACT_DEPLOY:
-            handle_display_smart_contract_deploy();
-            break;
-        case SMART_CONTRACT_EXECUTION:
-        case FEE_DELEGATED_SMART_CONTRACT_EXECUTION:
-        case PARTIAL_FEE_DELEGATED_SMART_CONTRACT_EXECUTION:
-            handle_display_smart_contract_execution();
-            break;
-        case CANCEL:
-        case FEE_DELEGATED_CANCEL:
-        case PARTIAL_FEE_DELEGATED_CANCEL:
-            handle_display_cancel();
-            break;
-        default:
-            PRINTF("Transaction type %d is not supported\n", G_context.tx_info.transaction.txType);
+// The transactions are only shown one by one on request, the totals are always shown
+static void review_batch_details_choice(bool details) {
+    if (details) {
+        g_batch_entry = 0;
+        review_batch_entry();
+    } else {
+        review_batch_summary();
     }
+}
 
-    nbgl_useCaseStaticReview(&pairList, &infoLongPress, "Reject transaction", review_choice);
+static void review_batch_continue(void) {
+    nbgl_useCaseChoice(&C_app_kaia_64px,
+                       "Review each\ntransaction?",
+                       "The totals of the batch are shown in any case",
+                       "Review each",
+                       "Totals only",
+                       review_batch_details_choice);
 }
 
-// Public function to start the transaction review
-// - Check if the app is in the right state for transaction review
-// - Format the amount and address strings in g_amount and g_to buffers
-// - Display the first screen of the transaction review
-int ui_display_transaction() {
+// Public function to start the batch review
+int ui_display_batch() {
     if (G_context.req_type != CONFIRM_TRANSACTION || G_context.state != STATE_PARSED) {
         G_context.state = STATE_NONE;
         return io_send_sw(SW_BAD_STATE);
     }
 
-    memset(g_type, 0, sizeof(g_type));
-    memset(g_nonce, 0, sizeof(g_nonce));
-    memset(g_gasPrice, 0, sizeof(g_gasPrice));
-    memset(g_gasLimit, 0, sizeof(g_gasLimit));
-    memset(g_to, 0, sizeof(g_to));
-    memset(g_feeRatio, 0, sizeof(g_feeRatio));
-    memset(g_amount, 0, sizeof(g_amount));
-
-    char type[50] = {0};
-    if (!format_transaction_type(G_context.tx_info.transaction.txType, type, sizeof(type))) {
-        return io_send_sw(SW_DISPLAY_TYPE_FAIL);
-    }
-    strncpy(g_type, type, sizeof(g_type));
-
-    char nonce[30] = {0};
-    uint64_t nonceValue = convertUint256ToUint64(&G_context.tx_info.transaction.nonce);
-    if (!format_u64(nonce, sizeof(nonce), nonceValue)) {
-        return io_send_sw(SW_DISPLAY_NONCE_FAIL);
+    uint16_t sw = review_strings_format_batch(&G_context.tx_info.batch, &g_batch);
+    if (sw != SW_OK) {
+        // Drop the batch, which would otherwise refuse the next transactions
+        explicit_bzero(&G_context, sizeof(G_context));
+        return io_send_sw(sw);
     }
-    strncpy(g_nonce, nonce, sizeof(g_nonce));
 
-    char gasPrice[30] = {0};
-    uint64_t gasPriceValue = convertUint256ToUint64(&G_context.tx_info.transaction.gasprice);
-    if (!format_u64(gasPrice, sizeof(gasPrice), gasPriceValue)) {
-        return io_send_sw(SW_DISPLAY_GASPRICE_FAIL);
-    }
-    strncpy(g_gasPrice, gasPrice, sizeof(g_gasPrice));
-
-    char gasLimit[30] = {0};
-    uint64_t gasLimitValue = convertUint256ToUint64(&G_context.tx_info.transaction.startgas);
-    if (!format_u64(gasLimit, sizeof(gasLimit), gasLimitValue)) {
-        return io_send_sw(SW_DISPLAY_GAS_FAIL);
-    }
-    strncpy(g_gasLimit, gasLimit, sizeof(g_gasLimit));
-
-    if (format_hex(G_context.tx_info.transaction.to, ADDRESS_LEN, g_to, sizeof(g_to)) == -1) {
-        return io_send_sw(SW_DISPLAY_ADDRESS_FAIL);
-    }
-
-    char feeRatio[30] = {0};
-    if (!format_u64(feeRatio, sizeof(feeRatio), G_context.tx_info.transaction.ratio)) {
-        return io_send_sw(SW_DISPLAY_FEERATIO_FAIL);
-    }
-    strncpy(g_feeRatio, feeRatio, sizeof(g_feeRatio));
-    strncat(g_feeRatio, "%%", 1);  // append '%' sign
-
-    char amount[50] = {0};
-    if (!amount_to_string(G_context.tx_info.transaction.value,
-                          EXPONENT_SMALLEST_UNIT,
-                          amount,
-                          sizeof(amount))) {
-        return io_send_sw(SW_DISPLAY_AMOUNT_FAIL);
-    }
-    snprintf(g_amount, sizeof(g_amount), "KAIA %.*s", sizeof(amount), amount);
-
-    // Start review
-    PRINTF("Displaying transaction review\n");
+    PRINTF("Displaying batch review\n");
     nbgl_useCaseReviewStart(&C_app_kaia_64px,
-                            "Review transaction\nto send KAIA",
+                            "Review batch\nof transactions",
                             NULL,
-                            "Reject transaction",
-                            review_continue,
+                            "Reject batch",
+                            review_batch_continue,
                             ask_transaction_rejection_confirmation);
     return DISPLAY_OK;
 }
@@ -0,0 +1,327 @@
+/*****************************************************************************
+ *   Ledger App Kaia.
+ *   (c) 2024 Blooo SAS.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *****************************************************************************/
+
+#include <stdbool.h>  // bool
+#include <stdio.h>    // snprintf
+#include <string.h>   // memcpy, memset, strncpy
+
+#include "format.h"
+
+#include "review_strings.h"
+#include "../constants.h"
+#include "../sw.h"
+#include "../helper/format.h"
+#include "../helper/uint256.h"
+#include "../transaction/calldata.h"
+#include "../transaction/utils.h"
+
+#define KAIA_TICKER "KAIA "
+
+// Format an integer field in decimal, over its whole 256 bits
+static bool format_integer(const uint256_view_t *value, char *out, size_t out_len) {
+    return uint256_to_decimal(*value, out, out_len);
+}
+
+// Format an amount in KAIA after the ticker, directly in the displayed string
+static bool format_kaia(const uint256_view_t *value, char *out, size_t out_len) {
+    const size_t tickerLength = sizeof(KAIA_TICKER) - 1;
+
+    if (out_len <= tickerLength) {
+        return false;
+    }
+    memcpy(out, KAIA_TICKER, tickerLength);
+    return amount_to_string(*value,
+                            EXPONENT_SMALLEST_UNIT,
+                            out + tickerLength,
+                            out_len - tickerLength);
+}
+
+// Format a 256 bits result in KAIA
+static bool format_kaia_u256(const u256_t *value, char *out, size_t out_len) {
+    uint8_t bytes[MAX_INT256];
+    uint256_view_t view = {.value = bytes, .length = sizeof(bytes)};
+
+    u256_to_bytes(value, bytes);
+    return format_kaia(&view, out, out_len);
+}
+
+// Format the gas price times the gas limit, and the value plus this fee. Nobody can pay for a
+// transaction whose fee or cost overflows 256 bits, its review fails whoever pays the fee.
+static bool format_fees(const transaction_t *tx, review_strings_t *strings) {
+    u256_t gasPrice;
+    u256_t gasLimit;
+    u256_t value;
+    u256_t fee;
+    u256_t total;
+
+    if (!u256_from_view(&gasPrice, &tx->gasprice) || !u256_from_view(&gasLimit, &tx->startgas) ||
+        !u256_from_view(&value, &tx->value)) {
+        return false;
+    }
+    if (!u256_mul(&fee, &gasPrice, &gasLimit) || !u256_add(&total, &value, &fee)) {
+        return false;
+    }
+    return format_kaia_u256(&fee, strings->networkFee, sizeof(strings->networkFee)) &&
+           format_kaia_u256(&total, strings->totalCost, sizeof(strings->totalCost));
+}
+
+// Format an address in hexadecimal
+static bool format_address(const uint8_t *address, char *out, size_t out_len) {
+    return format_hex(address, ADDRESS_LEN, out, out_len) != -1;
+}
+
+uint16_t review_strings_format(const transaction_t *tx, review_strings_t *strings) {
+    memset(strings, 0, sizeof(*strings));
+
+    const tx_descriptor_t *descriptor = tx_registry_lookup(tx->txType);
+    if (descriptor == NULL) {
+        return SW_DISPLAY_TYPE_FAIL;
+    }
+    strncpy(strings->type, tx_registry_name(descriptor), sizeof(strings->type) - 1);
+
+    if (!format_integer(&tx->nonce, strings->nonce, sizeof(strings->nonce))) {
+        return SW_DISPLAY_NONCE_FAIL;
+    }
+    if (!format_integer(&tx->gasprice, strings->gasPrice, sizeof(strings->gasPrice)) ||
+        !format_integer(&tx->priorityFee, strings->priorityFee, sizeof(strings->priorityFee))) {
+        return SW_DISPLAY_GASPRICE_FAIL;
+    }
+    if (!format_integer(&tx->startgas, strings->gasLimit, sizeof(strings->gasLimit))) {
+        return SW_DISPLAY_GAS_FAIL;
+    }
+    if (!format_u64(strings->accessList, sizeof(strings->accessList), tx->accessListCount)) {
+        return SW_DISPLAY_ACCESS_LIST_FAIL;
+    }
+
+    if (!format_address(tx->to, strings->to, sizeof(strings->to)) ||
+        !format_address(tx->from, strings->sender, sizeof(strings->sender)) ||
+        !format_address(tx->feePayer, strings->feePayer, sizeof(strings->feePayer))) {
+        return SW_DISPLAY_ADDRESS_FAIL;
+    }
+
+    char feeRatio[sizeof(strings->feeRatio) - 1] = {0};
+    if (!format_u64(feeRatio, sizeof(feeRatio), tx->ratio)) {
+        return SW_DISPLAY_FEERATIO_FAIL;
+    }
+    snprintf(strings->feeRatio, sizeof(strings->feeRatio), "%s%%", feeRatio);
+
+    if (!format_kaia(&tx->value, strings->amount, sizeof(strings->amount))) {
+        return SW_DISPLAY_AMOUNT_FAIL;
+    }
+
+    if (!format_fees(tx, strings)) {
+        return SW_DISPLAY_FEE_FAIL;
+    }
+
+    if (tx->tokenCall != TOKEN_CALL_NONE) {
+        uint256_view_t tokenValue = {.value = tx->tokenValue, .length = sizeof(tx->tokenValue)};
+        strncpy(strings->tokenMethod,
+                calldata_method_name(tx->tokenCall),
+                sizeof(strings->tokenMethod) - 1);
+        if (!format_address(tx->tokenFrom, strings->tokenFrom, sizeof(strings->tokenFrom)) ||
+            !format_address(tx->tokenTo, strings->tokenTo, sizeof(strings->tokenTo)) ||
+            !uint256_to_decimal(tokenValue, strings->tokenValue, sizeof(strings->tokenValue))) {
+            return SW_DISPLAY_TOKEN_FAIL;
+        }
+    }
+
+    char dataSize[sizeof(strings->dataSize) - 6] = {0};
+    if (!format_u64(dataSize, sizeof(dataSize), tx->dataSize) ||
+        format_hex(tx->dataHash, DATA_HASH_LEN, strings->dataHash, sizeof(strings->dataHash)) ==
+            -1) {
+        return SW_DISPLAY_DATA_FAIL;
+    }
+    snprintf(strings->dataSize, sizeof(strings->dataSize), "%s bytes", dataSize);
+
+    if (tx->memoLength != 0 && !transaction_utils_format_memo(tx->memo,
+                                                              tx->memoLength,
+                                                              strings->memo,
+                                                              sizeof(strings->memo))) {
+        return SW_DISPLAY_MEMO_FAIL;
+    }
+
+    // A review set with more pairs than the UIs have room for is refused before it is displayed
+    review_pair_t pairs[REVIEW_MAX_PAIRS];
+    if (review_strings_pairs(descriptor, tx, strings, pairs) == 0) {
+        return SW_DISPLAY_TYPE_FAIL;
+    }
+
+    return SW_OK;
+}
+
+// Append a pair, past REVIEW_MAX_PAIRS it is only counted so that the review is refused
+static void add_pair(review_pair_t *pairs, size_t *count, const char *label, const char *value) {
+    if (*count < REVIEW_MAX_PAIRS) {
+        pairs[*count] = (review_pair_t){label, value};
+    }
+    (*count)++;
+}
+
+// The owner is only part of the *From calls, the value of safeTransferFrom() may be a token ID
+static void review_strings_token_pairs(const transaction_t *tx,
+                                       const review_strings_t *strings,
+                                       review_pair_t *pairs,
+                                       size_t *count) {
+    add_pair(pairs, count, "Method", strings->tokenMethod);
+    if (tx->tokenCall == TOKEN_TRANSFER_FROM || tx->tokenCall == TOKEN_SAFE_TRANSFER_FROM) {
+        add_pair(pairs, count, "Token From", strings->tokenFrom);
+    }
+    if (tx->tokenCall == TOKEN_APPROVE) {
+        add_pair(pairs, count, "Spender", strings->tokenTo);
+    } else {
+        add_pair(pairs, count, "Token To", strings->tokenTo);
+    }
+    // The decimals of the token are unknown, the amount is in its smallest unit
+    if (tx->tokenCall == TOKEN_SAFE_TRANSFER_FROM) {
+        add_pair(pairs, count, "Amount or ID (raw)", strings->tokenValue);
+    } else {
+        add_pair(pairs, count, "Amount (raw)", strings->tokenValue);
+    }
+}
+
+// The fee payer pays the whole network fee, or its share of it, but not the value
+uint32_t review_strings_fields(const tx_descriptor_t *descriptor, const transaction_t *tx) {
+    uint32_t review = descriptor->review;
+
+    if (tx->feePayerSignature) {
+        review |= TX_REVIEW_SENDER | TX_REVIEW_FEE_PAYER | TX_REVIEW_NETWORK_FEE;
+        review &= ~TX_REVIEW_TOTAL_COST;
+    }
+    return review;
+}
+
+size_t review_strings_pairs(const tx_descriptor_t *descriptor,
+                            const transaction_t *tx,
+                            const review_strings_t *strings,
+                            review_pair_t *pairs) {
+    uint32_t review = review_strings_fields(descriptor, tx);
+    size_t i = 0;
+
+    if (review & TX_REVIEW_TYPE) {
+        add_pair(pairs, &i, "Type", strings->type);
+    }
+    if (review & TX_REVIEW_SENDER) {
+        add_pair(pairs, &i, "Sender", strings->sender);
+    }
+    if (review & TX_REVIEW_AMOUNT) {
+        add_pair(pairs, &i, "Amount", strings->amount);
+    }
+    if (review & TX_REVIEW_TO) {
+        add_pair(pairs, &i, "To", strings->to);
+    }
+    if (review & TX_REVIEW_SMART_CONTRACT) {
+        add_pair(pairs, &i, "Smart Contract", strings->to);
+    }
+    if ((review & TX_REVIEW_TOKEN_CALL) && tx->tokenCall != TOKEN_CALL_NONE) {
+        review_strings_token_pairs(tx, strings, pairs, &i);
+    }
+    if ((review & TX_REVIEW_MEMO) && tx->memoLength != 0) {
+        add_pair(pairs, &i, "Memo", strings->memo);
+    }
+    // The bytes data of a token call is not decoded, the calldata is shown by its size and hash
+    if ((review & TX_REVIEW_DATA) && tx->dataSize != 0 &&
+        (tx->tokenCall == TOKEN_CALL_NONE || tx->tokenBytes) && tx->memoLength == 0) {
+        add_pair(pairs, &i, "Data Size", strings->dataSize);
+        add_pair(pairs, &i, "Data Hash", strings->dataHash);
+    }
+    if (review & TX_REVIEW_GAS_PRICE) {
+        add_pair(pairs, &i, "Gas Price", strings->gasPrice);
+    }
+    if (review & TX_REVIEW_MAX_FEE) {
+        add_pair(pairs, &i, "Max Fee", strings->gasPrice);
+    }
+    if (review & TX_REVIEW_PRIORITY_FEE) {
+        add_pair(pairs, &i, "Priority Fee", strings->priorityFee);
+    }
+    if (review & TX_REVIEW_GAS_LIMIT) {
+        add_pair(pairs, &i, "Gas Limit", strings->gasLimit);
+    }
+    if (review & TX_REVIEW_FEE_PAYER) {
+        add_pair(pairs, &i, "Fee Payer", strings->feePayer);
+    }
+    if (review & TX_REVIEW_NETWORK_FEE) {
+        add_pair(pairs, &i, "Max Network Fee", strings->networkFee);
+    }
+    if (review & TX_REVIEW_TOTAL_COST) {
+        add_pair(pairs, &i, "Max Total Cost", strings->totalCost);
+    }
+    if (review & TX_REVIEW_NONCE) {
+        add_pair(pairs, &i, "Nonce", strings->nonce);
+    }
+    if (review & TX_REVIEW_ACCESS_LIST) {
+        add_pair(pairs, &i, "Access List", strings->accessList);
+    }
+    if ((review & TX_REVIEW_FEE_RATIO) && tx->ratio != 0) {
+        add_pair(pairs, &i, "Fee Ratio", strings->feeRatio);
+    }
+    return i > REVIEW_MAX_PAIRS ? 0 : i;
+}
+
+uint16_t review_strings_format_batch(const batch_ctx_t *batch, review_batch_strings_t *strings) {
+    memset(strings, 0, sizeof(*strings));
+
+    const tx_descriptor_t *descriptor = tx_registry_lookup(batch->txType);
+    if (descriptor == NULL) {
+        return SW_DISPLAY_TYPE_FAIL;
+    }
+    strncpy(strings->type, tx_registry_name(descriptor), sizeof(strings->type) - 1);
+
+    snprintf(strings->count, sizeof(strings->count), "%u", batch->count);
+    snprintf(strings->recipients, sizeof(strings->recipients), "%u", batch_recipients(batch));
+
+    if (!format_kaia_u256(&batch->totalValue, strings->totalAmount, sizeof(strings->totalAmount))) {
+        return SW_DISPLAY_AMOUNT_FAIL;
+    }
+    if (!format_kaia_u256(&batch->totalFee, strings->totalFee, sizeof(strings->totalFee))) {
+        return SW_DISPLAY_FEE_FAIL;
+    }
+    return SW_OK;
+}
+
+uint16_t review_strings_format_batch_entry(const batch_ctx_t *batch,
+                                           uint8_t index,
+                                           review_batch_strings_t *strings) {
+    const batch_entry_t *entry = &batch->entries[index];
+    uint256_view_t value = {.value = entry->value, .length = sizeof(entry->value)};
+    char amount[sizeof(strings->totalAmount)] = {0};
+    char to[ADDRESS_LEN * 2 + 1] = {0};
+    char nonce[21] = {0};
+
+    if (!format_kaia(&value, amount, sizeof(amount))) {
+        return SW_DISPLAY_AMOUNT_FAIL;
+    }
+    if (!format_address(entry->to, to, sizeof(to))) {
+        return SW_DISPLAY_ADDRESS_FAIL;
+    }
+    if (!format_u64(nonce, sizeof(nonce), entry->nonce)) {
+        return SW_DISPLAY_NONCE_FAIL;
+    }
+    snprintf(strings->title, sizeof(strings->title), "Transaction %u/%u", index + 1, batch->count);
+    snprintf(strings->entry, sizeof(strings->entry), "%s to %s, nonce %s", amount, to, nonce);
+    return SW_OK;
+}
+
+size_t review_strings_batch_pairs(const review_batch_strings_t *strings, review_pair_t *pairs) {
+    size_t i = 0;
+
+    pairs[i++] = (review_pair_t){"Type", strings->type};
+    pairs[i++] = (review_pair_t){"Transactions", strings->count};
+    pairs[i++] = (review_pair_t){"Recipients", strings->recipients};
+    pairs[i++] = (review_pair_t){"Total Amount", strings->totalAmount};
+    pairs[i++] = (review_pair_t){"Max Network Fees", strings->totalFee};
+    return i;
+}
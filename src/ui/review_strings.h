@@ -0,0 +1,140 @@
+#pragma once
+
+#include <stddef.h>  // size_t
+#include <stdint.h>  // uint*_t
+
+#include "../transaction/types.h"
+#include "../transaction/registry.h"
+#include "../transaction/batch.h"
+
+/**
+ * Maximum number of label/value pairs displayed on the review of a transaction. The largest
+ * review, a partial fee delegated execution of safeTransferFrom() with bytes data signed by the
+ * fee payer with a non zero ratio, has 16. A review set with more pairs is refused by
+ * review_strings_format().
+ */
+#define REVIEW_MAX_PAIRS 16
+
+/**
+ * Strings displayed on the review of a transaction.
+ */
+typedef struct {
+    char type[50];                /// transaction type name
+    char amount[90];              /// value, with the KAIA ticker
+    char to[43];                  /// recipient address, in hexadecimal
+    char sender[43];              /// sender address, in hexadecimal
+    char feePayer[43];            /// fee payer address, in hexadecimal
+    char nonce[80];               /// nonce
+    char gasPrice[80];            /// gas price, or max fee per gas (EIP-1559)
+    char priorityFee[80];         /// max priority fee per gas (EIP-1559)
+    char gasLimit[80];            /// gas limit
+    char feeRatio[30];            /// fee ratio, in percent
+    char accessList[30];          /// number of access list entries
+    char networkFee[90];          /// gas price times gas limit, with the KAIA ticker
+    char totalCost[90];           /// value plus network fee, with the KAIA ticker
+    char tokenMethod[20];         /// method of the token call
+    char tokenFrom[43];           /// token owner, in hexadecimal
+    char tokenTo[43];             /// token recipient or spender, in hexadecimal
+    char tokenValue[80];          /// token amount in its smallest unit or ID, in decimal
+    char dataSize[30];            /// size of the data, in bytes
+    char dataHash[65];            /// Keccak-256 hash of the data, in hexadecimal
+    char memo[MAX_MEMO_LEN + 1];  /// memo, printable ASCII
+} review_strings_t;
+
+/**
+ * Number of label/value pairs displayed on the review of a batch.
+ */
+#define REVIEW_BATCH_PAIRS 5
+
+/**
+ * Strings displayed on the review of a batch.
+ */
+typedef struct {
+    char type[50];         /// type name of the transactions
+    char count[10];        /// number of transactions
+    char recipients[10];   /// number of distinct recipients
+    char totalAmount[90];  /// sum of the values, with the KAIA ticker
+    char totalFee[90];     /// sum of the network fees, with the KAIA ticker
+    char title[30];        /// position of the transaction shown in detail
+    char entry[180];       /// amount, recipient and nonce of the transaction shown in detail
+} review_batch_strings_t;
+
+/**
+ * Label and value of a field displayed on the review.
+ */
+typedef struct {
+    const char *label;  /// field label
+    const char *value;  /// field value, from review_strings_t
+} review_pair_t;
+
+/**
+ * Format the fields of a parsed transaction as displayed on its review.
+ *
+ * Shared by the BAGL and NBGL flows, and by the host tools to show the same strings.
+ *
+ * @param[in] tx Parsed transaction.
+ * @param[out] strings Strings of the review.
+ * @return SW_OK if success, SW_DISPLAY_TYPE_FAIL if the review has more than REVIEW_MAX_PAIRS
+ * pairs, the SW_DISPLAY_* status word of the faulty field otherwise.
+ */
+uint16_t review_strings_format(const transaction_t *tx, review_strings_t *strings);
+
+/**
+ * Get the fields displayed on the review of a transaction.
+ *
+ * This is the review set of the transaction type, except on the fee payer signature where the
+ * sender, the fee payer and the network fee are shown, but not the total cost of the sender.
+ *
+ * @param[in] descriptor Descriptor of the transaction type.
+ * @param[in] tx Parsed transaction.
+ * @return The tx_review_field_e set displayed.
+ */
+uint32_t review_strings_fields(const tx_descriptor_t *descriptor, const transaction_t *tx);
+
+/**
+ * List the fields displayed on the review of a transaction, in their display order.
+ *
+ * The fields are selected by review_strings_fields(). The fee ratio is only listed when it is
+ * not zero, the token call when the calldata was decoded, the memo when it is printable, and
+ * the size and hash of the data when it is not empty and was not decoded.
+ *
+ * @param[in] descriptor Descriptor of the transaction type.
+ * @param[in] tx Parsed transaction.
+ * @param[in] strings Strings formatted by review_strings_format().
+ * @param[out] pairs Pairs displayed, REVIEW_MAX_PAIRS entries, never written past them.
+ * @return Number of pairs, 0 if they do not fit in REVIEW_MAX_PAIRS entries.
+ */
+size_t review_strings_pairs(const tx_descriptor_t *descriptor,
+                            const transaction_t *tx,
+                            const review_strings_t *strings,
+                            review_pair_t *pairs);
+
+/**
+ * Format the totals of a batch as displayed on its review.
+ *
+ * @param[in] batch Batch whose transactions are all received.
+ * @param[out] strings Strings of the review, the detail of a transaction is left empty.
+ * @return SW_OK if success, the SW_DISPLAY_* status word of the faulty field otherwise.
+ */
+uint16_t review_strings_format_batch(const batch_ctx_t *batch, review_batch_strings_t *strings);
+
+/**
+ * Format the summary of one transaction of a batch, shown in detail on request.
+ *
+ * @param[in] batch Batch whose transactions are all received.
+ * @param[in] index Index of the transaction in the batch.
+ * @param[out] strings Strings of the review, whose title and entry are formatted.
+ * @return SW_OK if success, the SW_DISPLAY_* status word of the faulty field otherwise.
+ */
+uint16_t review_strings_format_batch_entry(const batch_ctx_t *batch,
+                                           uint8_t index,
+                                           review_batch_strings_t *strings);
+
+/**
+ * List the totals displayed on the review of a batch, in their display order.
+ *
+ * @param[in] strings Strings formatted by review_strings_format_batch().
+ * @param[out] pairs Pairs displayed, REVIEW_BATCH_PAIRS entries.
+ * @return Number of pairs.
+ */
+size_t review_strings_batch_pairs(const review_batch_strings_t *strings, review_pair_t *pairs);
@@ -1,5 +1,5 @@
 from enum import IntEnum
-from typing import Generator, List, Optional
+from typing import Generator, List, Optional, Union
 from contextlib import contextmanager
 
 from ragger.backend.interface import BackendInterface, RAPDU
@@ -17,18 +17,30 @@ class P1(IntEnum):
     P1_MAX   = 0x03
     # Parameter 1 for screen confirmation for GET_PUBLIC_KEY.
     P1_CONFIRM = 0x01
+    # Parameter 1 for compressed public keys instead of addresses for GET_ADDRESSES.
+    P1_PUBLIC_KEYS = 0x01
 
 class P2(IntEnum):
     # Parameter 2 for last APDU to receive.
     P2_LAST = 0x00
     # Parameter 2 for more APDU to receive.
     P2_MORE = 0x80
+    # Parameter 2 flag of the first SIGN_TX APDU to sign as the fee payer.
+    P2_FEE_PAYER = 0x01
+    # Parameter 2 flag of the first SIGN_TX APDU holding several BIP32 paths.
+    P2_MULTI_PATH = 0x02
+    # Parameter 2 flag of the first SIGN_TX APDU starting a batch of transactions.
+    P2_BATCH = 0x04
+    # Parameter 2 of GET_PUBLIC_KEY to return the extended public key of a hardened path.
+    P2_EXTENDED = 0x01
 
 class InsType(IntEnum):
-    GET_VERSION    = 0x03
-    GET_APP_NAME   = 0x04
-    GET_PUBLIC_KEY = 0x05
-    SIGN_TX        = 0x06
+    GET_VERSION          = 0x03
+    GET_APP_NAME         = 0x04
+    GET_PUBLIC_KEY       = 0x05
+    SIGN_TX              = 0x06
+    GET_BATCH_SIGNATURES = 0x07
+    GET_ADDRESSES        = 0x08
 
 class Errors(IntEnum):
     SW_DENY                    = 0x6985
@@ -45,12 +57,20 @@ class Errors(IntEnum):
     SW_TX_HASH_FAIL            = 0xB006
     SW_BAD_STATE               = 0xB007
     SW_SIGNATURE_FAIL          = 0xB008
+    SW_TX_NOT_BATCHABLE        = 0xB014
+    SW_WRONG_INDEX_RANGE       = 0xB015
+    SW_WRONG_ACCOUNT_PATH      = 0xB016
 
 
 def split_message(message: bytes, max_size: int) -> List[bytes]:
     return [message[x:x + max_size] for x in range(0, len(message), max_size)]
 
 
+# The chunk index wraps from 0xFF to 0x01, 0x00 being reserved for the BIP32 path
+def next_chunk_index(idx: int) -> int:
+    return idx + 1 if idx < 0xFF else P1.P1_START + 1
+
+
 class KaiaCommandSender:
     def __init__(self, backend: BackendInterface) -> None:
         self.backend = backend
@@ -88,6 +108,14 @@ class KaiaCommandSender:
                                      data=pack_derivation_path(path))
 
 
+    def get_extended_public_key(self, path: str) -> RAPDU:
+        return self.backend.exchange(cla=CLA,
+                                     ins=InsType.GET_PUBLIC_KEY,
+                                     p1=P1.P1_START,
+                                     p2=P2.P2_EXTENDED,
+                                     data=pack_derivation_path(path))
+
+
     @contextmanager
     def get_public_key_with_confirmation(self, path: str) -> Generator[None, None, None]:
         with self.backend.exchange_async(cla=CLA,
@@ -99,12 +127,23 @@ class KaiaCommandSender:
 
 
     @contextmanager
-    def sign_tx(self, path: str, transaction: bytes) -> Generator[None, None, None]:
+    def sign_tx(self,
+                path: Union[str, List[str]],
+                transaction: bytes,
+                fee_payer: bool = False) -> Generator[None, None, None]:
+        # A list of paths is sent with its length, one signature is returned for each path
+        p2: int = P2.P2_MORE | (P2.P2_FEE_PAYER if fee_payer else 0)
+        if isinstance(path, str):
+            data = pack_derivation_path(path)
+        else:
+            p2 |= P2.P2_MULTI_PATH
+            data = len(path).to_bytes(1, byteorder="big")
+            data += b"".join(pack_derivation_path(p) for p in path)
         self.backend.exchange(cla=CLA,
                               ins=InsType.SIGN_TX,
                               p1=P1.P1_START,
-                              p2=P2.P2_MORE,
-                              data=pack_derivation_path(path))
+                              p2=p2,
+                              data=data)
         messages = split_message(transaction, MAX_APDU_LEN)
         idx: int = P1.P1_START + 1
 
@@ -114,7 +153,7 @@ class KaiaCommandSender:
                                   p1=idx,
                                   p2=P2.P2_MORE,
                                   data=msg)
-            idx += 1
+            idx = next_chunk_index(idx)
 
         with self.backend.exchange_async(cla=CLA,
                                          ins=InsType.SIGN_TX,
@@ -123,5 +162,67 @@ class KaiaCommandSender:
                                          data=messages[-1]) as response:
             yield response
 
+    @contextmanager
+    def sign_tx_batch(self,
+                      path: str,
+                      transactions: List[bytes]) -> Generator[None, None, None]:
+        # The response to the last chunk holds the first signatures, once the batch is approved
+        self.backend.exchange(cla=CLA,
+                              ins=InsType.SIGN_TX,
+                              p1=P1.P1_START,
+                              p2=P2.P2_MORE | P2.P2_BATCH,
+                              data=len(transactions).to_bytes(1, byteorder="big") +
+                                   pack_derivation_path(path))
+        messages = []
+        for transaction in transactions:
+            chunks = split_message(transaction, MAX_APDU_LEN)
+            messages += [(chunk, P2.P2_MORE) for chunk in chunks[:-1]]
+            messages.append((chunks[-1], P2.P2_LAST))
+        idx: int = P1.P1_START + 1
+
+        for msg, p2 in messages[:-1]:
+            self.backend.exchange(cla=CLA,
+                                  ins=InsType.SIGN_TX,
+                                  p1=idx,
+                                  p2=p2,
+                                  data=msg)
+            idx = next_chunk_index(idx)
+
+        with self.backend.exchange_async(cla=CLA,
+                                         ins=InsType.SIGN_TX,
+                                         p1=idx,
+                                         p2=P2.P2_LAST,
+                                         data=messages[-1][0]) as response:
+            yield response
+
+    def get_batch_signatures(self) -> RAPDU:
+        return self.backend.exchange(cla=CLA,
+                                     ins=InsType.GET_BATCH_SIGNATURES,
+                                     p1=P1.P1_START,
+                                     p2=P2.P2_LAST,
+                                     data=b"")
+
+    def get_addresses(self,
+                      path: str,
+                      first: int,
+                      count: int,
+                      public_keys: bool = False) -> bytes:
+        # The records that do not fit in the first response are returned by the next requests
+        record_len: int = 33 if public_keys else 20
+        records: bytes = self.backend.exchange(cla=CLA,
+                                               ins=InsType.GET_ADDRESSES,
+                                               p1=P1.P1_PUBLIC_KEYS if public_keys else P1.P1_START,
+                                               p2=P2.P2_LAST,
+                                               data=pack_derivation_path(path) +
+                                                    first.to_bytes(4, byteorder="big") +
+                                                    count.to_bytes(1, byteorder="big")).data
+        while len(records) < count * record_len:
+            records += self.backend.exchange(cla=CLA,
+                                             ins=InsType.GET_ADDRESSES,
+                                             p1=P1.P1_START,
+                                             p2=P2.P2_MORE,
+                                             data=b"").data
+        return records
+
     def get_async_response(self) -> Optional[RAPDU]:
         return self.backend.last_async_response
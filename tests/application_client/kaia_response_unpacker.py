@@ -1,4 +1,4 @@
-from typing import Tuple
+from typing import List, Tuple
 from struct import unpack
 
 # remainder, data_len, data
@@ -62,16 +62,45 @@ def unpack_get_public_key_response(response: bytes) -> Tuple[int, bytes, int, by
     return pub_key_len, pub_key, address_len, address, chain_code_len, chain_code
 
 # Unpack from response:
-# response = der_sig_len (1)
-#            der_sig (var)
-#            v (1)
-def unpack_sign_tx_response(response: bytes) -> Tuple[int, bytes, int]:
-    response, der_sig_len, der_sig = pop_size_prefixed_buf_from_buf(response)
-    response, v = pop_sized_buf_from_buffer(response, 1)
+# response = depth (1)
+#            parent_fingerprint (4)
+#            child_number (4)
+#            chain_code (32)
+#            public_key (33)
+def unpack_get_extended_public_key_response(response: bytes) -> Tuple[int, bytes, int, bytes, bytes]:
+    response, depth = pop_sized_buf_from_buffer(response, 1)
+    response, parent_fingerprint = pop_sized_buf_from_buffer(response, 4)
+    response, child_number = pop_sized_buf_from_buffer(response, 4)
+    response, chain_code = pop_sized_buf_from_buffer(response, 32)
+    response, public_key = pop_sized_buf_from_buffer(response, 33)
 
     assert len(response) == 0
 
-    return der_sig_len, der_sig, int.from_bytes(v, byteorder='big')
+    return depth[0], parent_fingerprint, int.from_bytes(child_number, byteorder='big'), chain_code, public_key
+
+# Unpack from response:
+# response = (v_len (1) || v (v_len) || r (32) || s (32)) for each path
+def unpack_sign_tx_multi_path_response(response: bytes) -> List[bytes]:
+    records = []
+    while len(response) > 0:
+        record_len = 1 + response[0] + 64
+        assert len(response) >= record_len
+        records.append(response[:record_len])
+        response = response[record_len:]
+
+    return records
+
+# Unpack from response:
+# response = (address (20) or compressed public key (33)) for each index
+def unpack_get_addresses_response(response: bytes, record_len: int) -> List[bytes]:
+    assert len(response) % record_len == 0
+
+    return [response[i:i + record_len] for i in range(0, len(response), record_len)]
+
+# Unpack from record:
+# record = v_len (1) || v (v_len) || r (32) || s (32)
+def unpack_signature_v(signature: bytes) -> int:
+    return int.from_bytes(signature[1:1 + signature[0]], byteorder='big')
 
 def strip_v_from_signature(signature: bytes) -> bytes:
-    return signature[1:]
+    return signature[1 + signature[0]:]
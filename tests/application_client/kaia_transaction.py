@@ -1,52 +1,169 @@
-from io import BytesIO
-from typing import Union
+from dataclasses import dataclass, field
+from enum import IntEnum
+from typing import List, Optional, Tuple, Union
 
-from .kaia_utils import read, read_uint, read_varint, write_varint, UINT64_MAX
+from .kaia_utils import rlp_encode
+
+ADDRESS_LEN: int = 20
+MAX_INT256_LEN: int = 32
+UINT64_MAX: int = 2**64-1
+UINT256_MAX: int = 2**256-1
 
 
 class TransactionError(Exception):
     pass
 
 
+class TransactionType(IntEnum):
+    # Mirrors transaction_type_e of src/transaction/types.h
+    EIP2930 = 0x01
+    EIP1559 = 0x02
+    LEGACY = 0xC0
+    VALUE_TRANSFER = 0x08
+    FEE_DELEGATED_VALUE_TRANSFER = 0x09
+    PARTIAL_FEE_DELEGATED_VALUE_TRANSFER = 0x0A
+    VALUE_TRANSFER_MEMO = 0x10
+    FEE_DELEGATED_VALUE_TRANSFER_MEMO = 0x11
+    PARTIAL_FEE_DELEGATED_VALUE_TRANSFER_MEMO = 0x12
+    SMART_CONTRACT_DEPLOY = 0x28
+    FEE_DELEGATED_SMART_CONTRACT_DEPLOY = 0x29
+    PARTIAL_FEE_DELEGATED_SMART_CONTRACT_DEPLOY = 0x2A
+    SMART_CONTRACT_EXECUTION = 0x30
+    FEE_DELEGATED_SMART_CONTRACT_EXECUTION = 0x31
+    PARTIAL_FEE_DELEGATED_SMART_CONTRACT_EXECUTION = 0x32
+    CANCEL = 0x38
+    FEE_DELEGATED_CANCEL = 0x39
+    PARTIAL_FEE_DELEGATED_CANCEL = 0x3A
+
+    @property
+    def is_kaia(self) -> bool:
+        return self not in (TransactionType.LEGACY,
+                            TransactionType.EIP2930,
+                            TransactionType.EIP1559)
+
+    @property
+    def is_partial_fee_delegated(self) -> bool:
+        return self.is_kaia and self & 0x03 == 0x02
+
+    @property
+    def is_fee_delegated(self) -> bool:
+        # Fee delegated or partial fee delegated, with a fee payer
+        return self.is_kaia and self & 0x03 != 0
+
+    @property
+    def base(self) -> "TransactionType":
+        # Basic type of a fee delegated one
+        return TransactionType(self & ~0x03) if self.is_kaia else self
+
+
+AccessList = List[Tuple[bytes, List[bytes]]]
+
+
+def to_address(address: Union[str, bytes]) -> bytes:
+    if isinstance(address, str):
+        return bytes.fromhex(address[2:] if address.startswith("0x") else address)
+    return address
+
+
+@dataclass
 class Transaction:
-    def __init__(self,
-                 nonce: int,
-                 to: Union[str, bytes],
-                 value: int,
-                 memo: str,
-                 do_check: bool = True) -> None:
-        self.nonce: int = nonce
-        self.to: bytes = bytes.fromhex(to[2:]) if isinstance(to, str) else to
-        self.value: int = value
-        self.memo: bytes = memo.encode("ascii")
-
-        if do_check:
-            if not 0 <= self.nonce <= UINT64_MAX:
-                raise TransactionError(f"Bad nonce: '{self.nonce}'!")
-
-            if not 0 <= self.value <= UINT64_MAX:
-                raise TransactionError(f"Bad value: '{self.value}'!")
-
-            if len(self.to) != 20:
-                raise TransactionError(f"Bad address: '{self.to.hex()}'!")
+    """Kaia, legacy or typed Ethereum transaction, serialized as the signature preimage
+    expected by SIGN_TX.
+
+    `gas_price` is the max fee per gas of EIP-1559 transactions. `data` is the input of smart
+    contract executions and typed transactions, the memo of value transfers with memo and the
+    bytecode of smart contract deploys. A legacy transaction without `chain_id` is pre EIP-155.
+    With `fee_payer`, the preimage is the one signed by the fee payer of a fee delegated
+    transaction.
+    """
+    tx_type: TransactionType
+    nonce: int = 0
+    gas_price: int = 0
+    gas: int = 0
+    to: Union[str, bytes] = b""
+    value: int = 0
+    sender: Union[str, bytes] = bytes(ADDRESS_LEN)
+    data: bytes = b""
+    ratio: int = 0
+    chain_id: Optional[int] = 1001
+    priority_fee: int = 0
+    access_list: AccessList = field(default_factory=list)
+    human_readable: bool = False
+    code_format: int = 0
+    fee_payer: Optional[Union[str, bytes]] = None
+    do_check: bool = True
+
+    def __post_init__(self) -> None:
+        self.tx_type = TransactionType(self.tx_type)
+        self.to = to_address(self.to)
+        self.sender = to_address(self.sender)
+        if self.fee_payer is not None:
+            self.fee_payer = to_address(self.fee_payer)
+        if self.do_check:
+            self.check()
+
+    def check(self) -> None:
+        for name in ("nonce", "gas_price", "gas", "value", "priority_fee"):
+            if not 0 <= getattr(self, name) <= UINT256_MAX:
+                raise TransactionError(f"Bad {name}: '{getattr(self, name)}'!")
+        # EIP-2681, the device tells legacy transactions from Kaia ones by their nonce length
+        if self.tx_type == TransactionType.LEGACY and self.nonce > UINT64_MAX:
+            raise TransactionError(f"Bad legacy nonce: '{self.nonce}'!")
+        if self.chain_id is not None and not 0 <= self.chain_id <= UINT256_MAX:
+            raise TransactionError(f"Bad chain id: '{self.chain_id}'!")
+        if self.chain_id is None and self.tx_type != TransactionType.LEGACY:
+            raise TransactionError("Only legacy transactions can omit the chain id!")
+        # Smart contract deploys have no recipient, others may only omit it to create one
+        if self.tx_type.base == TransactionType.SMART_CONTRACT_DEPLOY:
+            if self.to:
+                raise TransactionError("Smart contract deploys have no recipient!")
+        elif len(self.to) != ADDRESS_LEN and (self.tx_type.is_kaia or self.to):
+            raise TransactionError(f"Bad address: '{self.to.hex()}'!")
+        if len(self.sender) != ADDRESS_LEN:
+            raise TransactionError(f"Bad sender: '{self.sender.hex()}'!")
+        if self.tx_type.is_partial_fee_delegated and not 1 <= self.ratio <= 99:
+            raise TransactionError(f"Bad fee ratio: '{self.ratio}'!")
+        if self.fee_payer is not None:
+            if not self.tx_type.is_fee_delegated:
+                raise TransactionError("Only fee delegated transactions have a fee payer!")
+            if len(self.fee_payer) != ADDRESS_LEN:
+                raise TransactionError(f"Bad fee payer: '{self.fee_payer.hex()}'!")
+
+    def kaia_fields(self) -> list:
+        base = self.tx_type.base
+        fields: list = [self.tx_type, self.nonce, self.gas_price, self.gas]
+        if base == TransactionType.CANCEL:
+            fields += [self.sender]
+        elif base == TransactionType.SMART_CONTRACT_DEPLOY:
+            fields += [b"", self.value, self.sender, self.data, int(self.human_readable)]
+        elif base == TransactionType.VALUE_TRANSFER:
+            fields += [self.to, self.value, self.sender]
+        else:
+            fields += [self.to, self.value, self.sender, self.data]
+        if self.tx_type.is_partial_fee_delegated:
+            fields.append(self.ratio)
+        if base == TransactionType.SMART_CONTRACT_DEPLOY:
+            fields.append(self.code_format)
+        return fields
 
     def serialize(self) -> bytes:
-        return b"".join([
-            self.nonce.to_bytes(8, byteorder="big"),
-            self.to,
-            self.value.to_bytes(8, byteorder="big"),
-            write_varint(len(self.memo)),
-            self.memo
-        ])
-
-    @classmethod
-    def from_bytes(cls, hexa: Union[bytes, BytesIO]):
-        buf: BytesIO = BytesIO(hexa) if isinstance(hexa, bytes) else hexa
-
-        nonce: int = read_uint(buf, 64, byteorder="big")
-        to: bytes = read(buf, 20)
-        value: int = read_uint(buf, 64, byteorder="big")
-        memo_len: int = read_varint(buf)
-        memo: str = read(buf, memo_len).decode("ascii")
-
-        return cls(nonce=nonce, to=to, value=value, memo=memo)
+        if self.tx_type == TransactionType.LEGACY:
+            fields: list = [self.nonce, self.gas_price, self.gas, self.to, self.value, self.data]
+            if self.chain_id is not None:
+                fields += [self.chain_id, 0, 0]
+            return rlp_encode(fields)
+        if self.tx_type == TransactionType.EIP2930:
+            return bytes([self.tx_type]) + rlp_encode([
+                self.chain_id, self.nonce, self.gas_price, self.gas, self.to, self.value,
+                self.data, [[address, keys] for address, keys in self.access_list]
+            ])
+        if self.tx_type == TransactionType.EIP1559:
+            return bytes([self.tx_type]) + rlp_encode([
+                self.chain_id, self.nonce, self.priority_fee, self.gas_price, self.gas, self.to,
+                self.value, self.data, [[address, keys] for address, keys in self.access_list]
+            ])
+        # The Kaia fields are encoded as a byte string in the preimage, followed by the fee
+        # payer address in the one of the fee payer
+        if self.fee_payer is not None:
+            return rlp_encode([rlp_encode(self.kaia_fields()), self.fee_payer, self.chain_id, 0, 0])
+        return rlp_encode([rlp_encode(self.kaia_fields()), self.chain_id, 0, 0])
@@ -1,5 +1,5 @@
 from io import BytesIO
-from typing import Optional, Literal
+from typing import Optional, Literal, Union
 
 
 UINT64_MAX: int = 2**64-1
@@ -59,3 +59,21 @@ def read_uint(buf: BytesIO,
         raise ValueError(f"Can't read u{bit_len} in buffer!")
 
     return int.from_bytes(b, byteorder)
+
+
+def rlp_encode_length(length: int, offset: int) -> bytes:
+    if length < 56:
+        return bytes([offset + length])
+    length_bytes: bytes = length.to_bytes((length.bit_length() + 7) // 8, byteorder="big")
+    return bytes([offset + 55 + len(length_bytes)]) + length_bytes
+
+
+def rlp_encode(item: Union[bytes, int, list]) -> bytes:
+    if isinstance(item, int):
+        item = item.to_bytes((item.bit_length() + 7) // 8, byteorder="big")
+    if isinstance(item, (bytes, bytearray)):
+        if len(item) == 1 and item[0] < 0x80:
+            return bytes(item)
+        return rlp_encode_length(len(item), 0x80) + bytes(item)
+    payload: bytes = b"".join(rlp_encode(i) for i in item)
+    return rlp_encode_length(len(payload), 0xC0) + payload
@@ -32,6 +32,14 @@ def test_wrong_p1p2(backend):
     with pytest.raises(ExceptionRAPDU) as e:
         backend.exchange(cla=CLA, ins=InsType.GET_APP_NAME, p1=P1.P1_START, p2=P2.P2_MORE)
     assert e.value.status == Errors.SW_WRONG_P1P2
+    # The extended public key is not displayed
+    with pytest.raises(ExceptionRAPDU) as e:
+        backend.exchange(cla=CLA,
+                         ins=InsType.GET_PUBLIC_KEY,
+                         p1=P1.P1_CONFIRM,
+                         p2=P2.P2_EXTENDED,
+                         data=bytes.fromhex("038000002c8000003c80000000"))
+    assert e.value.status == Errors.SW_WRONG_P1P2
 
 
 # Ensure the app returns an error when a bad data length is used
@@ -55,3 +63,16 @@ def test_invalid_state(backend):
                          p2=P2.P2_MORE,
                          data=b"abcde")  # data is not parsed in this case
     assert e.value.status == Errors.SW_BAD_STATE
+
+
+# Ensure the number of signing paths is checked on the first SIGN_TX APDU
+def test_wrong_path_count(backend):
+    path = bytes.fromhex("058000002c80002019800000000000000000000000")
+    for count in (0, 4):
+        with pytest.raises(ExceptionRAPDU) as e:
+            backend.exchange(cla=CLA,
+                             ins=InsType.SIGN_TX,
+                             p1=P1.P1_START,
+                             p2=P2.P2_MORE | P2.P2_MULTI_PATH,
+                             data=bytes([count]) + path * count)
+        assert e.value.status == Errors.SW_WRONG_DATA_LENGTH
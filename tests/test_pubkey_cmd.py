@@ -1,11 +1,17 @@
 import pytest
 
-from application_client.kaia_command_sender import KaiaCommandSender, Errors
-from application_client.kaia_response_unpacker import unpack_get_public_key_response
+from application_client.kaia_command_sender import CLA, InsType, P1, P2, KaiaCommandSender, Errors
+from application_client.kaia_response_unpacker import unpack_get_public_key_response, unpack_get_addresses_response, unpack_get_extended_public_key_response
 from ragger.bip import calculate_public_key_and_chaincode, CurveChoice
 from ragger.error import ExceptionRAPDU
 from ragger.navigator import NavInsID, NavIns
 from utils import ROOT_SCREENSHOT_PATH
+import hashlib
+import sha3
+
+
+def compress_public_key(public_key: bytes) -> bytes:
+    return bytes([2 + (public_key[-1] & 1)]) + public_key[1:33]
 
 
 # In this test we check that the GET_PUBLIC_KEY works in non-confirmation mode
@@ -87,3 +93,57 @@ def test_get_public_key_confirm_refused(firmware, backend, navigator, test_name)
             # Assert that we have received a refusal
             assert e.value.status == Errors.SW_DENY
             assert len(e.value.data) == 0
+
+
+# In this test we check that GET_ADDRESSES returns the addresses and public keys of a range of
+# indices, over several responses
+def test_get_addresses(backend):
+    client = KaiaCommandSender(backend)
+    base_path = "m/44'/60'/0'/0"
+    first, count = 5, 25
+
+    addresses = unpack_get_addresses_response(client.get_addresses(base_path, first, count), 20)
+    public_keys = unpack_get_addresses_response(client.get_addresses(base_path, first, count, public_keys=True), 33)
+    assert len(addresses) == count and len(public_keys) == count
+
+    for i in range(count):
+        ref_public_key, _ = calculate_public_key_and_chaincode(CurveChoice.Secp256k1, path=f"{base_path}/{first + i}")
+        ref_public_key = bytes.fromhex(ref_public_key)
+        assert addresses[i] == sha3.keccak_256(ref_public_key[1:]).digest()[-20:]
+        assert public_keys[i] == compress_public_key(ref_public_key)
+
+    # Every record of the range has been sent
+    with pytest.raises(ExceptionRAPDU) as e:
+        backend.exchange(cla=CLA, ins=InsType.GET_ADDRESSES, p1=P1.P1_START, p2=P2.P2_MORE, data=b"")
+    assert e.value.status == Errors.SW_BAD_STATE
+
+    # The range stops before the hardened indices
+    for first, count in ((0, 0), (0x7FFFFFFF, 2), (0x80000000, 1)):
+        with pytest.raises(ExceptionRAPDU) as e:
+            client.get_addresses(base_path, first, count)
+        assert e.value.status == Errors.SW_WRONG_INDEX_RANGE
+
+
+# In this test we check that GET_PUBLIC_KEY returns the extended public key of an account path,
+# from which the host derives the addresses of the account
+def test_get_extended_public_key(backend):
+    client = KaiaCommandSender(backend)
+    for parent_path, path, child_number in (("m/44'/60'", "m/44'/60'/0'", 0x80000000),
+                                            ("m/44'/60'/1'", "m/44'/60'/1'/8217'", 0x80002019)):
+        response = client.get_extended_public_key(path=path).data
+        depth, parent_fingerprint, number, chain_code, public_key = unpack_get_extended_public_key_response(response)
+
+        ref_public_key, ref_chain_code = calculate_public_key_and_chaincode(CurveChoice.Secp256k1, path=path)
+        ref_parent_key, _ = calculate_public_key_and_chaincode(CurveChoice.Secp256k1, path=parent_path)
+        ref_parent_key = compress_public_key(bytes.fromhex(ref_parent_key))
+        assert depth == path.count("/")
+        assert parent_fingerprint == hashlib.new("ripemd160", hashlib.sha256(ref_parent_key).digest()).digest()[:4]
+        assert number == child_number
+        assert chain_code.hex() == ref_chain_code
+        assert public_key == compress_public_key(bytes.fromhex(ref_public_key))
+
+    # Only account paths have an extended public key: hardened, with a parent under m/44'/60'
+    for path in ("m/44'/60'/0'/0", "m/44'/60'", "m/44'"):
+        with pytest.raises(ExceptionRAPDU) as e:
+            client.get_extended_public_key(path=path)
+        assert e.value.status == Errors.SW_WRONG_ACCOUNT_PATH
@@ -1,8 +1,8 @@
 import pytest
 
 from application_client.kaia_transaction import Transaction
-from application_client.kaia_command_sender import KaiaCommandSender, Errors
-from application_client.kaia_response_unpacker import strip_v_from_signature, unpack_get_public_key_response, unpack_sign_tx_response
+from application_client.kaia_command_sender import CLA, InsType, P1, P2, KaiaCommandSender, Errors
+from application_client.kaia_response_unpacker import strip_v_from_signature, unpack_get_public_key_response, unpack_sign_tx_multi_path_response, unpack_signature_v
 from ragger.error import ExceptionRAPDU
 from ragger.navigator import NavInsID
 from utils import ROOT_SCREENSHOT_PATH, check_signature_validity
@@ -12,7 +12,7 @@ import sha3
 
 def verify_transaction_signature_from_public_key(transaction: bytes, signature: bytes, public_key: bytes):
     try:
-        if len(signature) == 65:
+        if len(signature) > 64:
             signature = strip_v_from_signature(signature)
         verifying_key = VerifyingKey.from_string(public_key, curve=SECP256k1)    
         return verifying_key.verify(signature, transaction, hashfunc=sha3.keccak_256)
@@ -127,3 +127,127 @@ def test_sign_tx_fee_delegated_cancel_tx(firmware, backend, navigator, test_name
 def test_sign_tx_partial_fee_delegated_cancel_tx(firmware, backend, navigator, test_name):
     raw_transaction_hex = "e9a3e23a19850ba43b7400830493e0946e93a3acfbadf457f29fb0e57fa42274004c32ea1e8203e98080"
     perform_test_sign_tx_with_raw_tx(firmware, backend, navigator, test_name, raw_transaction_hex)
+
+# In this test a chunk sent after the last one of a rejected transaction is refused, the hash of
+# the reviewed transaction is not finalized again
+def test_sign_tx_late_chunk_refused(firmware, backend, navigator):
+    client = KaiaCommandSender(backend)
+    raw_transaction_bytes = bytes.fromhex("f84eb847f8450882115c850ba43b7400830493e0940ee56b604c869e3792c99e35c1c424f88f87dc8a8ca18f07d736b90be550000001946e93a3acfbadf457f29fb0e57fa42274004c32ea8203e98080")
+
+    with pytest.raises(ExceptionRAPDU) as e:
+        with client.sign_tx(path="m/44'/60'/0'/0/0", transaction=raw_transaction_bytes):
+            if firmware.device.startswith("nano"):
+                navigator.navigate_until_text(NavInsID.RIGHT_CLICK, [NavInsID.BOTH_CLICK], "Reject")
+            else:
+                navigator.navigate([NavInsID.USE_CASE_REVIEW_REJECT,
+                                    NavInsID.USE_CASE_CHOICE_CONFIRM,
+                                    NavInsID.USE_CASE_STATUS_DISMISS])
+    assert e.value.status == Errors.SW_DENY
+
+    # The transaction fits in one chunk, the late one follows it
+    with pytest.raises(ExceptionRAPDU) as e:
+        backend.exchange(cla=CLA, ins=InsType.SIGN_TX, p1=P1.P1_START + 2, p2=P2.P2_LAST, data=b"")
+    assert e.value.status == Errors.SW_BAD_STATE
+
+# In this test the transaction is reviewed once and signed with several paths, without screenshots comparison
+def test_sign_tx_multi_path(firmware, backend, navigator):
+    client = KaiaCommandSender(backend)
+    paths = ["m/44'/60'/0'/0/0", "m/44'/60'/0'/0/1", "m/44'/60'/1'/0/0"]
+    public_keys = []
+    for path in paths:
+        rapdu = client.get_public_key(path=path)
+        _, public_key, _, _, _, _ = unpack_get_public_key_response(rapdu.data)
+        public_keys.append(public_key)
+
+    raw_transaction_bytes = bytes.fromhex("f84eb847f8450882115c850ba43b7400830493e0940ee56b604c869e3792c99e35c1c424f88f87dc8a8ca18f07d736b90be550000001946e93a3acfbadf457f29fb0e57fa42274004c32ea8203e98080")
+
+    with client.sign_tx(path=paths, transaction=raw_transaction_bytes):
+        if firmware.device.startswith("nano"):
+            navigator.navigate_until_text(NavInsID.RIGHT_CLICK, [NavInsID.BOTH_CLICK], "Approve")
+        else:
+            navigator.navigate_until_text(NavInsID.USE_CASE_REVIEW_TAP,
+                                          [NavInsID.USE_CASE_REVIEW_CONFIRM,
+                                           NavInsID.USE_CASE_STATUS_DISMISS],
+                                          "Hold to sign")
+
+    # One signature is returned for each path, in the order of the paths
+    signatures = unpack_sign_tx_multi_path_response(client.get_async_response().data)
+    assert len(signatures) == len(paths)
+    for signature, public_key in zip(signatures, public_keys):
+        # v is chainId * 2 + 35 + parity, on 2 bytes for the chain ID 1001
+        assert unpack_signature_v(signature) in (1001 * 2 + 35, 1001 * 2 + 36)
+        assert verify_transaction_signature_from_public_key(raw_transaction_bytes, signature, public_key)
+
+# In these tests a batch is reviewed and its signatures are fetched in chained responses.
+# Nano devices review its totals, Stax devices each of its transactions then its totals,
+# or its totals only.
+def perform_test_sign_tx_batch(firmware, backend, navigator, test_name, review_each):
+    client = KaiaCommandSender(backend)
+    path: str = "m/44'/60'/0'/0/0"
+    rapdu = client.get_public_key(path=path)
+    _, public_key, _, _, _, _ = unpack_get_public_key_response(rapdu.data)
+
+    # Value transfers to alternating recipients, with increasing nonces
+    transactions = [bytes.fromhex("f84eb847f845088211%02x850ba43b7400830493e0940ee56b604c869e3792c99e35c1c424f88f87dc8a8ca18f07d736b90be550000001946e93a3acfbadf457f29fb0e57fa42274004c32ea8203e98080" % nonce)
+                    for nonce in range(1, 8)]
+    transactions = [tx if i % 2 == 0 else tx.replace(bytes.fromhex("0ee56b604c869e3792c99e35c1c424f88f87dc8a"),
+                                                     bytes.fromhex("6e93a3acfbadf457f29fb0e57fa42274004c32ea"), 1)
+                    for i, tx in enumerate(transactions)]
+
+    with client.sign_tx_batch(path=path, transactions=transactions):
+        if firmware.device.startswith("nano"):
+            navigator.navigate_until_text(NavInsID.RIGHT_CLICK, [NavInsID.BOTH_CLICK], "Approve")
+        else:
+            # Start of the review, choice of the details, then "Next" on each transaction
+            if review_each:
+                instructions = [NavInsID.USE_CASE_REVIEW_TAP, NavInsID.USE_CASE_CHOICE_CONFIRM]
+                instructions += [NavInsID.USE_CASE_CHOICE_CONFIRM] * len(transactions)
+            else:
+                instructions = [NavInsID.USE_CASE_REVIEW_TAP, NavInsID.USE_CASE_CHOICE_REJECT]
+            navigator.navigate_and_compare(ROOT_SCREENSHOT_PATH, test_name, instructions)
+            # Totals of the batch, signed with a long press
+            navigator.navigate_until_text_and_compare(NavInsID.USE_CASE_REVIEW_TAP,
+                                                      [NavInsID.USE_CASE_REVIEW_CONFIRM,
+                                                       NavInsID.USE_CASE_STATUS_DISMISS],
+                                                      "Hold to sign",
+                                                      ROOT_SCREENSHOT_PATH,
+                                                      test_name,
+                                                      screen_change_before_first_instruction=False,
+                                                      snap_start_idx=len(instructions))
+
+    signatures = unpack_sign_tx_multi_path_response(client.get_async_response().data)
+
+    # No SIGN_TX chunk is accepted until every signature of the batch is sent
+    for p1, p2 in ((P1.P1_START, P2.P2_MORE), (P1.P1_START + 1, P2.P2_LAST)):
+        with pytest.raises(ExceptionRAPDU) as e:
+            backend.exchange(cla=CLA, ins=InsType.SIGN_TX, p1=p1, p2=p2, data=transactions[0])
+        assert e.value.status == Errors.SW_BAD_STATE
+
+    while len(signatures) < len(transactions):
+        signatures += unpack_sign_tx_multi_path_response(client.get_batch_signatures().data)
+    assert len(signatures) == len(transactions)
+    for signature, transaction in zip(signatures, transactions):
+        assert verify_transaction_signature_from_public_key(transaction, signature, public_key)
+
+    # Every signature was sent
+    with pytest.raises(ExceptionRAPDU) as e:
+        client.get_batch_signatures()
+    assert e.value.status == Errors.SW_BAD_STATE
+
+def test_sign_tx_batch(firmware, backend, navigator, test_name):
+    perform_test_sign_tx_batch(firmware, backend, navigator, test_name, True)
+
+def test_sign_tx_batch_totals(firmware, backend, navigator, test_name):
+    if firmware.device.startswith("nano"):
+        pytest.skip("Nano devices review the totals of a batch in test_sign_tx_batch")
+    perform_test_sign_tx_batch(firmware, backend, navigator, test_name, False)
+
+
+# Only value transfers without data may be part of a batch
+def test_sign_tx_batch_refused(backend):
+    client = KaiaCommandSender(backend)
+    execution = bytes.fromhex("f886b87ff87d3019850ba43b7400830493e0940ee56b604c869e3792c99e35c1c424f88f87dc8a01946e93a3acfbadf457f29fb0e57fa42274004c32eab844095ea7b3000000000000000000000000f50782a24afcb26acb85d086cf892bfffb5731b5ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff8203e98080")
+    with pytest.raises(ExceptionRAPDU) as e:
+        with client.sign_tx_batch(path="m/44'/60'/0'/0/0", transactions=[execution, execution]):
+            pass
+    assert e.value.status == Errors.SW_TX_NOT_BATCHABLE
@@ -0,0 +1,141 @@
+import json
+import os
+import time
+from statistics import median
+
+from application_client.kaia_command_sender import (CLA, InsType, P1, P2, MAX_APDU_LEN,
+                                                    KaiaCommandSender, split_message,
+                                                    next_chunk_index)
+from application_client.kaia_response_unpacker import unpack_get_public_key_response
+from application_client.kaia_utils import rlp_encode
+from ragger.bip import pack_derivation_path
+from ragger.navigator import NavInsID
+from test_sign_cmd import verify_transaction_signature_from_public_key
+
+# In this benchmark we measure how long the device takes to answer each SIGN_TX chunk
+# of large SMART_CONTRACT_DEPLOY transactions. The last APDU is measured until the review
+# screen is displayed, it should stay in the range of an intermediate APDU now that the
+# parsing and the hashing are done while the chunks are received.
+#
+# Without a baseline, the test checks that the last APDU of the largest deploy takes at most
+# MAX_SCALING times the one of the smallest: it grew with the transaction size when the whole
+# transaction was hashed once received.
+# Set KAIA_BENCH_OUTPUT to a file path to keep the results as JSON, and KAIA_BENCH_BASELINE to
+# the results of a previous run on the same device to check that the last APDU of each deploy
+# takes at most KAIA_BENCH_MAX_RATIO (default MAX_RATIO) times its baseline. The procedure is
+# described in usage.md.
+
+PATH: str = "m/44'/60'/0'/0/0"
+SMART_CONTRACT_DEPLOY: int = 0x28
+# The largest payload only fits with the streaming SIGN_TX (default build), KAIA_BENCH_SIZES
+# overrides the sizes, e.g. "1024,4096,8000" for a build without it
+BYTECODE_SIZES = [1024, 4096, 8000, 32768]
+MAX_SCALING: float = 2.0
+MAX_RATIO: float = 1.2
+
+
+def bytecode_sizes() -> list:
+    sizes = os.environ.get("KAIA_BENCH_SIZES")
+    if not sizes:
+        return BYTECODE_SIZES
+    return [int(size) for size in sizes.split(",")]
+
+
+def check_baseline(device: str, results: list) -> None:
+    path = os.environ.get("KAIA_BENCH_BASELINE")
+    if not path:
+        return
+    max_ratio = float(os.environ.get("KAIA_BENCH_MAX_RATIO", MAX_RATIO))
+    with open(path, encoding="utf-8") as f:
+        baseline = json.load(f)
+    assert baseline["device"] == device, f"baseline of {baseline['device']}, not {device}"
+    previous = {result["bytecode_size"]: result for result in baseline["results"]}
+    compared = 0
+    for result in results:
+        before = previous.get(result["bytecode_size"])
+        if before is None:
+            continue
+        ratio = result["last_apdu_ms"] / before["last_apdu_ms"]
+        print(f"{result['bytecode_size']} bytes: last APDU {before['last_apdu_ms']} ms -> "
+              f"{result['last_apdu_ms']} ms ({ratio:.2f}x)")
+        assert ratio <= max_ratio, \
+            f"last APDU of a {result['bytecode_size']} bytes deploy {ratio:.2f}x its baseline"
+        compared += 1
+    assert compared > 0, "no bytecode size in common with the baseline"
+
+
+def build_smart_contract_deploy(bytecode_size: int) -> bytes:
+    sender = bytes.fromhex("6e93a3acfbadf457f29fb0e57fa42274004c32ea")
+    bytecode = bytes((i * 7) & 0xff for i in range(bytecode_size))
+    inner = rlp_encode([SMART_CONTRACT_DEPLOY, 25, 50000000000, 3000000, b"", 0, sender,
+                        bytecode, 0, 0])
+    return rlp_encode([inner, 1001, 0, 0])
+
+
+def approve(firmware, navigator):
+    if firmware.device.startswith("nano"):
+        navigator.navigate_until_text(NavInsID.RIGHT_CLICK, [NavInsID.BOTH_CLICK], "Approve")
+    else:
+        navigator.navigate_until_text(NavInsID.USE_CASE_REVIEW_TAP,
+                                      [NavInsID.USE_CASE_REVIEW_CONFIRM,
+                                       NavInsID.USE_CASE_STATUS_DISMISS],
+                                      "Hold to sign")
+
+
+def test_sign_tx_last_apdu_latency(firmware, backend, navigator):
+    client = KaiaCommandSender(backend)
+    rapdu = client.get_public_key(path=PATH)
+    _, public_key, _, _, _, _ = unpack_get_public_key_response(rapdu.data)
+
+    results = []
+    for bytecode_size in bytecode_sizes():
+        transaction = build_smart_contract_deploy(bytecode_size)
+        backend.exchange(cla=CLA,
+                         ins=InsType.SIGN_TX,
+                         p1=P1.P1_START,
+                         p2=P2.P2_MORE,
+                         data=pack_derivation_path(PATH))
+        messages = split_message(transaction, MAX_APDU_LEN)
+
+        chunk_latencies = []
+        idx = P1.P1_START + 1
+        for msg in messages[:-1]:
+            start = time.perf_counter()
+            backend.exchange(cla=CLA, ins=InsType.SIGN_TX, p1=idx, p2=P2.P2_MORE, data=msg)
+            chunk_latencies.append(time.perf_counter() - start)
+            idx = next_chunk_index(idx)
+
+        start = time.perf_counter()
+        with backend.exchange_async(cla=CLA,
+                                    ins=InsType.SIGN_TX,
+                                    p1=idx,
+                                    p2=P2.P2_LAST,
+                                    data=messages[-1]):
+            backend.wait_for_screen_change()
+            last_latency = time.perf_counter() - start
+            approve(firmware, navigator)
+
+        signature = client.get_async_response().data
+        assert verify_transaction_signature_from_public_key(transaction, signature, public_key)
+
+        results.append({
+            "bytecode_size": bytecode_size,
+            "transaction_size": len(transaction),
+            "chunks": len(messages),
+            "median_chunk_ms": round(median(chunk_latencies) * 1000, 3),
+            "last_apdu_ms": round(last_latency * 1000, 3),
+        })
+
+    print(json.dumps(results, indent=2))
+    output = os.environ.get("KAIA_BENCH_OUTPUT")
+    if output:
+        with open(output, "w", encoding="utf-8") as f:
+            json.dump({"device": firmware.device, "results": results}, f, indent=2)
+
+    check_baseline(firmware.device, results)
+    smallest = min(results, key=lambda result: result["bytecode_size"])
+    largest = max(results, key=lambda result: result["bytecode_size"])
+    assert largest["last_apdu_ms"] <= MAX_SCALING * smallest["last_apdu_ms"], \
+        f"last APDU of a {largest['bytecode_size']} bytes deploy takes " \
+        f"{largest['last_apdu_ms']} ms, {smallest['last_apdu_ms']} ms for " \
+        f"{smallest['bytecode_size']} bytes"
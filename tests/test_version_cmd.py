@@ -2,8 +2,8 @@ from application_client.kaia_command_sender import KaiaCommandSender
 from application_client.kaia_response_unpacker import unpack_get_version_response
 
 # Taken from the Makefile, to update every time the Makefile version is bumped
-MAJOR = 1
-MINOR = 1
+MAJOR = 2
+MINOR = 0
 PATCH = 0
 
 # In this test we check the behavior of the device when asked to provide the app version
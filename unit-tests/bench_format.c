@@ -0,0 +1,115 @@
+/*
+ * Host benchmark of the formatting of the review.
+ *
+ * Reports the cost of the decimal conversion of 256 bits integers, of their formatting as KAIA
+ * amounts, of the network fee and total cost arithmetic, and of review_strings_format() on a
+ * transaction with full width fields.
+ *
+ * Usage: bench_format [rounds]
+ */
+#define _POSIX_C_SOURCE 199309L  // clock_gettime
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "constants.h"
+#include "sw.h"
+#include "helper/format.h"
+#include "helper/uint256.h"
+#include "transaction/types.h"
+#include "ui/review_strings.h"
+
+// 1.5 KAIA in its smallest unit, a 25 gkei gas price and a 21000 gas limit
+static const uint8_t SMALL_VALUE[] = {0x14, 0xd1, 0x12, 0x0d, 0x7b, 0x16, 0x00, 0x00};
+static const uint8_t GAS_PRICE[] = {0x05, 0xd2, 0x1d, 0xba, 0x00};
+static const uint8_t GAS_LIMIT[] = {0x52, 0x08};
+
+// Full width value, whose conversion takes the most divisions
+static const uint8_t LARGE_VALUE[MAX_INT256] = {
+    0x0f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
+
+typedef enum { BENCH_DECIMAL, BENCH_AMOUNT, BENCH_FEES, BENCH_REVIEW } bench_e;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Run one case, the characters written are summed so that no call is optimized out
+static double run(bench_e bench, const transaction_t *tx, long rounds, uint64_t *check) {
+    static review_strings_t strings;
+    char out[100];
+    double start = now_ns();
+
+    for (long r = 0; r < rounds; r++) {
+        bool ok = true;
+        u256_t gasPrice;
+        u256_t gasLimit;
+        u256_t value;
+
+        switch (bench) {
+            case BENCH_DECIMAL:
+                ok = uint256_to_decimal(tx->value, out, sizeof(out));
+                *check += out[0];
+                break;
+            case BENCH_AMOUNT:
+                ok = amount_to_string(tx->value, EXPONENT_SMALLEST_UNIT, out, sizeof(out));
+                *check += out[0];
+                break;
+            case BENCH_FEES:
+                ok = u256_from_view(&gasPrice, &tx->gasprice) &&
+                     u256_from_view(&gasLimit, &tx->startgas) &&
+                     u256_from_view(&value, &tx->value) &&
+                     u256_mul(&gasPrice, &gasPrice, &gasLimit) &&
+                     u256_add(&value, &value, &gasPrice);
+                *check += value.limbs[0];
+                break;
+            case BENCH_REVIEW:
+                ok = review_strings_format(tx, &strings) == SW_OK;
+                *check += strings.totalCost[5];
+                break;
+        }
+        if (!ok) {
+            fprintf(stderr, "formatting error\n");
+            exit(1);
+        }
+    }
+    return (now_ns() - start) / rounds;
+}
+
+int main(int argc, char *argv[]) {
+    static const struct {
+        bench_e bench;
+        const char *name;
+    } cases[] = {{BENCH_DECIMAL, "uint256_to_decimal"},
+                 {BENCH_AMOUNT, "amount_to_string"},
+                 {BENCH_FEES, "network fee and total cost"},
+                 {BENCH_REVIEW, "review_strings_format"}};
+    long rounds = argc > 1 ? atol(argv[1]) : 200000;
+    uint64_t check = 0;
+    transaction_t small;
+    transaction_t large;
+
+    memset(&small, 0, sizeof(small));
+    small.txType = VALUE_TRANSFER;
+    small.value = (uint256_view_t){.value = SMALL_VALUE, .length = sizeof(SMALL_VALUE)};
+    small.gasprice = (uint256_view_t){.value = GAS_PRICE, .length = sizeof(GAS_PRICE)};
+    small.startgas = (uint256_view_t){.value = GAS_LIMIT, .length = sizeof(GAS_LIMIT)};
+    large = small;
+    large.value = (uint256_view_t){.value = LARGE_VALUE, .length = sizeof(LARGE_VALUE)};
+
+    printf("rounds: %ld\n", rounds);
+    printf("%-28s %12s %12s\n", "", "1.5 KAIA", "256 bits");
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        double smallNs = run(cases[i].bench, &small, rounds, &check);
+        double largeNs = run(cases[i].bench, &large, rounds, &check);
+        printf("%-28s %9.1f ns %9.1f ns\n", cases[i].name, smallNs, largeNs);
+    }
+    return check == 0;
+}
@@ -0,0 +1,229 @@
+/*
+ * Host benchmark of the RLP header decoding.
+ *
+ * Compares the per-field cost of parseRLP() with the previous decoding, which fed the
+ * prefix byte by byte through rlpBuffer and ran the prefix if-ladder twice per field.
+ *
+ * Usage: bench_rlp_decode [rounds]
+ */
+#define _POSIX_C_SOURCE 199309L  // clock_gettime
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "transaction/deserialize.h"
+
+#define FIELD_COUNT 4096
+
+// Previous decoding, kept here as the reference
+static uint8_t ladder_read_byte(parser_context_t *parser_ctx) {
+    parser_ctx->commandLength--;
+    return *parser_ctx->workBuffer++;
+}
+
+static bool ladder_decode_length(uint8_t *buffer,
+                                 uint32_t *fieldLength,
+                                 uint32_t *offset,
+                                 bool *list) {
+    if (*buffer <= 0x7f) {
+        *offset = 0;
+        *fieldLength = 1;
+        *list = false;
+    } else if (*buffer <= 0xb7) {
+        *offset = 1;
+        *fieldLength = *buffer - 0x80;
+        *list = false;
+    } else if (*buffer <= 0xbf) {
+        *offset = 1 + (*buffer - 0xb7);
+        *list = false;
+        switch (*buffer) {
+            case 0xb8:
+                *fieldLength = *(buffer + 1);
+                break;
+            case 0xb9:
+                *fieldLength = (*(buffer + 1) << 8) + *(buffer + 2);
+                break;
+            case 0xba:
+                *fieldLength = (*(buffer + 1) << 16) + (*(buffer + 2) << 8) + *(buffer + 3);
+                break;
+            case 0xbb:
+                *fieldLength = (*(buffer + 1) << 24) + (*(buffer + 2) << 16) +
+                               (*(buffer + 3) << 8) + *(buffer + 4);
+                break;
+            default:
+                return false;  // arbitrary 32 bits length limitation
+        }
+    } else if (*buffer <= 0xf7) {
+        *offset = 1;
+        *fieldLength = *buffer - 0xc0;
+        *list = true;
+    } else {
+        *offset = 1 + (*buffer - 0xf7);
+        *list = true;
+        switch (*buffer) {
+            case 0xf8:
+                *fieldLength = *(buffer + 1);
+                break;
+            case 0xf9:
+                *fieldLength = (*(buffer + 1) << 8) + *(buffer + 2);
+                break;
+            case 0xfa:
+                *fieldLength = (*(buffer + 1) << 16) + (*(buffer + 2) << 8) + *(buffer + 3);
+                break;
+            case 0xfb:
+                *fieldLength = (*(buffer + 1) << 24) + (*(buffer + 2) << 16) +
+                               (*(buffer + 3) << 8) + *(buffer + 4);
+                break;
+            default:
+                return false;  // arbitrary 32 bits length limitation
+        }
+    }
+
+    return true;
+}
+
+static bool ladder_can_decode(uint8_t *buffer, uint32_t bufferLength, bool *valid) {
+    if (*buffer <= 0x7f) {
+    } else if (*buffer <= 0xb7) {
+    } else if (*buffer <= 0xbf) {
+        if (bufferLength < (uint32_t) (1 + (*buffer - 0xb7))) {
+            return false;
+        }
+        if (*buffer > 0xbb) {
+            *valid = false;  // arbitrary 32 bits length limitation
+            return true;
+        }
+    } else if (*buffer <= 0xf7) {
+    } else {
+        if (bufferLength < (uint32_t) (1 + (*buffer - 0xf7))) {
+            return false;
+        }
+        if (*buffer > 0xfb) {
+            *valid = false;  // arbitrary 32 bits length limitation
+            return true;
+        }
+    }
+    *valid = true;
+    return true;
+}
+
+// Not inlined, to compare with parseRLP() from its own translation unit
+__attribute__((noinline)) static parser_status_e ladder_parse(parser_context_t *parser_ctx) {
+    bool canDecode = false;
+    uint32_t offset;
+    while (parser_ctx->commandLength != 0) {
+        bool valid;
+        // Feed the RLP buffer until the length can be decoded
+        parser_ctx->rlpBuffer[parser_ctx->rlpBufferPos++] = ladder_read_byte(parser_ctx);
+        if (ladder_can_decode(parser_ctx->rlpBuffer, parser_ctx->rlpBufferPos, &valid)) {
+            // Can decode now, if valid
+            if (!valid) {
+                return PARSING_ERROR;
+            }
+            canDecode = true;
+            break;
+        }
+        // Cannot decode yet
+        // Sanity check
+        if (parser_ctx->rlpBufferPos == sizeof(parser_ctx->rlpBuffer)) {
+            return PARSING_ERROR;
+        }
+    }
+    if (!canDecode) {
+        return PARSING_PROCESSING;
+    }
+    // Ready to process this field
+    if (!ladder_decode_length(parser_ctx->rlpBuffer,
+                              &parser_ctx->currentFieldLength,
+                              &offset,
+                              &parser_ctx->currentFieldIsList)) {
+        return PARSING_ERROR;
+    }
+    if (offset == 0) {
+        // Hack for single byte, self encoded
+        parser_ctx->workBuffer--;
+        parser_ctx->commandLength++;
+        parser_ctx->fieldSingleByte = true;
+    } else {
+        parser_ctx->fieldSingleByte = false;
+    }
+    parser_ctx->rlpBufferPos = 0;
+
+    parser_ctx->currentFieldPos = 0;
+    parser_ctx->processingField = true;
+    return PARSING_CONTINUE;
+}
+
+// Fields of a typical transaction: single bytes, quantities, addresses and some calldata
+static size_t build_fields(uint8_t *out) {
+    static const uint32_t lengths[] = {1, 2, 5, 3, 20, 9, 20, 68, 1, 2, 260, 0};
+    size_t size = 0;
+    for (size_t i = 0; i < FIELD_COUNT; i++) {
+        uint32_t length = lengths[i % (sizeof(lengths) / sizeof(lengths[0]))];
+        if (length == 1) {
+            out[size++] = 0x01;
+            continue;
+        }
+        if (length <= 55) {
+            out[size++] = 0x80 + length;
+        } else if (length <= 0xff) {
+            out[size++] = 0xb8;
+            out[size++] = length;
+        } else {
+            out[size++] = 0xb9;
+            out[size++] = length >> 8;
+            out[size++] = length & 0xff;
+        }
+        memset(out + size, 0x5a, length);
+        size += length;
+    }
+    return size;
+}
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+int main(int argc, char *argv[]) {
+    static uint8_t fields[FIELD_COUNT * 300];
+    size_t size = build_fields(fields);
+    long rounds = argc > 1 ? atol(argv[1]) : 2000;
+    uint64_t check[2] = {0, 0};
+    double elapsed[2];
+
+    for (int impl = 0; impl < 2; impl++) {
+        double start = now_ns();
+        for (long r = 0; r < rounds; r++) {
+            parser_context_t ctx;
+            memset(&ctx, 0, sizeof(ctx));
+            ctx.workBuffer = fields;
+            ctx.commandLength = size;
+            while (ctx.commandLength != 0) {
+                parser_status_e status = impl == 0 ? ladder_parse(&ctx) : parseRLP(&ctx);
+                if (status != PARSING_CONTINUE) {
+                    fprintf(stderr, "decoding error\n");
+                    return 1;
+                }
+                check[impl] += ctx.currentFieldLength;
+                ctx.workBuffer += ctx.currentFieldLength;
+                ctx.commandLength -= ctx.currentFieldLength;
+            }
+        }
+        elapsed[impl] = now_ns() - start;
+    }
+    if (check[0] != check[1]) {
+        fprintf(stderr, "decoded lengths differ\n");
+        return 1;
+    }
+
+    printf("fields: %d x %ld rounds\n", FIELD_COUNT, rounds);
+    printf("byte-wise ladder: %.2f ns/field\n", elapsed[0] / ((double) FIELD_COUNT * rounds));
+    printf("prefix table:     %.2f ns/field\n", elapsed[1] / ((double) FIELD_COUNT * rounds));
+    return 0;
+}
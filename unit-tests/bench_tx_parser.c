@@ -0,0 +1,452 @@
+/*
+ * Host benchmark of transaction_deserialize(), broken down by transaction type.
+ *
+ * Each corpus holds generated signature preimages of one transaction type with random
+ * nonces, gas and values. The parse time is reported per transaction, per RLP field and as a
+ * throughput, on stdout or as JSON to compare commits.
+ *
+ * With --threads N, every corpus is parsed by 1 to N threads at once, each thread parsing all
+ * of them with its own contexts, and the aggregated throughput is reported for each thread
+ * count to show how the parser scales with the cores.
+ *
+ * Usage: bench_tx_parser [--json] [--threads N] [rounds]
+ */
+#define _POSIX_C_SOURCE 200112L  // clock_gettime, pthread_barrier_t
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "constants.h"
+#include "transaction/deserialize.h"
+#include "transaction/types.h"
+
+#define CORPUS_TX_COUNT 256
+#define MAX_THREADS     256
+
+typedef struct {
+    const char *name;
+    uint8_t type;
+    uint32_t data_len;  // calldata, memo or bytecode length
+} corpus_spec_t;
+
+typedef struct {
+    uint8_t *data;
+    uint32_t *offsets;  // CORPUS_TX_COUNT + 1 offsets in data
+    uint32_t fields;    // RLP items decoded over the corpus
+} corpus_t;
+
+static const corpus_spec_t CORPORA[] = {
+    {"legacy", LEGACY, 0},
+    {"value_transfer", VALUE_TRANSFER, 0},
+    {"fee_delegated_value_transfer", FEE_DELEGATED_VALUE_TRANSFER, 0},
+    {"partial_fee_delegated_value_transfer", PARTIAL_FEE_DELEGATED_VALUE_TRANSFER, 0},
+    {"value_transfer_memo", VALUE_TRANSFER_MEMO, 32},
+    {"fee_delegated_value_transfer_memo", FEE_DELEGATED_VALUE_TRANSFER_MEMO, 32},
+    {"partial_fee_delegated_value_transfer_memo", PARTIAL_FEE_DELEGATED_VALUE_TRANSFER_MEMO, 32},
+    {"smart_contract_deploy_0k", SMART_CONTRACT_DEPLOY, 0},
+    {"smart_contract_deploy_1k", SMART_CONTRACT_DEPLOY, 1024},
+    {"smart_contract_deploy_4k", SMART_CONTRACT_DEPLOY, 4096},
+    {"smart_contract_deploy_8k", SMART_CONTRACT_DEPLOY, 8000},
+    {"fee_delegated_smart_contract_deploy_4k", FEE_DELEGATED_SMART_CONTRACT_DEPLOY, 4096},
+    {"partial_fee_delegated_smart_contract_deploy_4k",
+     PARTIAL_FEE_DELEGATED_SMART_CONTRACT_DEPLOY,
+     4096},
+    {"smart_contract_execution", SMART_CONTRACT_EXECUTION, 68},
+    {"fee_delegated_smart_contract_execution", FEE_DELEGATED_SMART_CONTRACT_EXECUTION, 68},
+    {"partial_fee_delegated_smart_contract_execution",
+     PARTIAL_FEE_DELEGATED_SMART_CONTRACT_EXECUTION,
+     68},
+    {"cancel", CANCEL, 0},
+    {"fee_delegated_cancel", FEE_DELEGATED_CANCEL, 0},
+    {"partial_fee_delegated_cancel", PARTIAL_FEE_DELEGATED_CANCEL, 0},
+    {"eip2930", EIP2930, 0},
+    {"eip1559", EIP1559, 68},
+};
+
+static uint32_t g_seed = 0x4b414941;
+
+static uint32_t next_random(void) {
+    g_seed ^= g_seed << 13;
+    g_seed ^= g_seed >> 17;
+    g_seed ^= g_seed << 5;
+    return g_seed;
+}
+
+static size_t rlp_header(uint8_t *out, size_t length, uint8_t offset) {
+    if (length < 56) {
+        out[0] = offset + length;
+        return 1;
+    }
+    size_t bytes = length > 0xffff ? 3 : length > 0xff ? 2 : 1;
+    out[0] = offset + 55 + bytes;
+    for (size_t i = 0; i < bytes; i++) {
+        out[bytes - i] = length >> (8 * i);
+    }
+    return 1 + bytes;
+}
+
+static size_t rlp_string(uint8_t *out, const uint8_t *data, size_t length) {
+    if (length == 1 && data[0] < 0x80) {
+        out[0] = data[0];
+        return 1;
+    }
+    size_t offset = rlp_header(out, length, 0x80);
+    memcpy(out + offset, data, length);
+    return offset + length;
+}
+
+static size_t rlp_uint(uint8_t *out, uint64_t value) {
+    uint8_t be[8];
+    size_t length = 0;
+    for (uint64_t v = value; v != 0; v >>= 8) {
+        length++;
+    }
+    for (size_t i = 0; i < length; i++) {
+        be[length - 1 - i] = value >> (8 * i);
+    }
+    return rlp_string(out, be, length);
+}
+
+// Wrap the encoded items with a list (or string) header
+static size_t rlp_wrap(uint8_t *out, const uint8_t *items, size_t length, uint8_t offset) {
+    size_t header = rlp_header(out, length, offset);
+    memcpy(out + header, items, length);
+    return header + length;
+}
+
+// Encode the signature preimage of a transaction, return its length
+static size_t encode_tx(uint8_t *out, const corpus_spec_t *spec, uint32_t *fields) {
+    static uint8_t items[MAX_TRANSACTION_LEN];
+    static uint8_t inner[MAX_TRANSACTION_LEN];
+    static uint8_t data[MAX_TRANSACTION_LEN];
+    uint8_t address[ADDRESS_LEN];
+    uint8_t kind = spec->type & ~0x03;
+    uint8_t flavor = spec->type & 0x03;
+    uint64_t value = ((uint64_t) next_random() << 32) | next_random();
+    size_t n = 0;
+
+    for (size_t i = 0; i < ADDRESS_LEN; i++) {
+        address[i] = next_random();
+    }
+    for (size_t i = 0; i < spec->data_len; i++) {
+        data[i] = kind == VALUE_TRANSFER_MEMO ? 'a' + next_random() % 26 : next_random();
+    }
+
+    if (spec->type == LEGACY) {
+        n += rlp_uint(items + n, next_random() % 100000);
+        n += rlp_uint(items + n, 25000000000);
+        n += rlp_uint(items + n, 21000 + next_random() % 100000);
+        n += rlp_string(items + n, address, ADDRESS_LEN);
+        n += rlp_uint(items + n, value);
+        n += rlp_string(items + n, data, 0);
+        n += rlp_uint(items + n, 1001);
+        n += rlp_uint(items + n, 0);
+        n += rlp_uint(items + n, 0);
+        *fields += 10;
+        return rlp_wrap(out, items, n, 0xc0);
+    }
+
+    if (spec->type == EIP2930 || spec->type == EIP1559) {
+        // type || rlp([chainId, nonce, [maxPriorityFee], gasPrice, gas, to, value, data,
+        //              [[address, [key]], [address, []]]])
+        uint8_t key[32] = {0};
+        size_t entry = rlp_string(inner, address, ADDRESS_LEN);
+        entry += rlp_wrap(inner + entry, items, rlp_string(items, key, sizeof(key)), 0xc0);
+        size_t list = rlp_wrap(data + spec->data_len, inner, entry, 0xc0);
+        entry = rlp_string(inner, address, ADDRESS_LEN);
+        entry += rlp_wrap(inner + entry, items, 0, 0xc0);
+        list += rlp_wrap(data + spec->data_len + list, inner, entry, 0xc0);
+
+        n += rlp_uint(items + n, 1001);
+        n += rlp_uint(items + n, next_random() % 100000);
+        if (spec->type == EIP1559) {
+            n += rlp_uint(items + n, 1000000000);
+        }
+        n += rlp_uint(items + n, 25000000000);
+        n += rlp_uint(items + n, 21000 + next_random() % 100000);
+        n += rlp_string(items + n, address, ADDRESS_LEN);
+        n += rlp_uint(items + n, value);
+        n += rlp_string(items + n, data, spec->data_len);
+        n += rlp_wrap(items + n, data + spec->data_len, list, 0xc0);
+        *fields += spec->type == EIP1559 ? 13 : 12;
+        out[0] = spec->type;
+        return 1 + rlp_wrap(out + 1, items, n, 0xc0);
+    }
+
+    // type, nonce, gasPrice, gas
+    n += rlp_uint(items + n, spec->type);
+    n += rlp_uint(items + n, next_random() % 100000);
+    n += rlp_uint(items + n, 25000000000);
+    n += rlp_uint(items + n, 21000 + next_random() % 1000000);
+    *fields += 4;
+    if (kind == SMART_CONTRACT_DEPLOY) {
+        // to, value, from, input, humanReadable
+        n += rlp_string(items + n, address, 0);
+        n += rlp_uint(items + n, 0);
+        n += rlp_string(items + n, address, ADDRESS_LEN);
+        n += rlp_string(items + n, data, spec->data_len);
+        n += rlp_uint(items + n, 0);
+        *fields += 5;
+    } else if (kind != CANCEL) {
+        // to, value, from, [input]
+        n += rlp_string(items + n, address, ADDRESS_LEN);
+        n += rlp_uint(items + n, value);
+        n += rlp_string(items + n, address, ADDRESS_LEN);
+        *fields += 3;
+        if (kind != VALUE_TRANSFER) {
+            n += rlp_string(items + n, data, spec->data_len);
+            *fields += 1;
+        }
+    } else {
+        // from
+        n += rlp_string(items + n, address, ADDRESS_LEN);
+        *fields += 1;
+    }
+    if (flavor == PARTIAL_FEE_DELEGATED) {
+        n += rlp_uint(items + n, 1 + next_random() % 99);
+        *fields += 1;
+    }
+    if (kind == SMART_CONTRACT_DEPLOY) {
+        // codeFormat
+        n += rlp_uint(items + n, 0);
+        *fields += 1;
+    }
+
+    // rlp([encode(rlp([type, ...])), chainId, 0, 0])
+    size_t inner_len = rlp_wrap(inner, items, n, 0xc0);
+    n = rlp_wrap(items, inner, inner_len, 0x80);
+    n += rlp_uint(items + n, 1001);
+    n += rlp_uint(items + n, 0);
+    n += rlp_uint(items + n, 0);
+    *fields += 6;
+    return rlp_wrap(out, items, n, 0xc0);
+}
+
+static void build_corpus(const corpus_spec_t *spec, corpus_t *corpus) {
+    corpus->data = malloc(CORPUS_TX_COUNT * (size_t) MAX_TRANSACTION_LEN);
+    corpus->offsets = malloc((CORPUS_TX_COUNT + 1) * sizeof(uint32_t));
+    if (corpus->data == NULL || corpus->offsets == NULL) {
+        abort();
+    }
+    corpus->fields = 0;
+    corpus->offsets[0] = 0;
+    for (size_t i = 0; i < CORPUS_TX_COUNT; i++) {
+        uint8_t *out = corpus->data + corpus->offsets[i];
+        corpus->offsets[i + 1] = corpus->offsets[i] + encode_tx(out, spec, &corpus->fields);
+    }
+}
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Parse every transaction of a corpus, return false on a parsing error
+static bool parse_corpus(const corpus_t *corpus) {
+    for (size_t i = 0; i < CORPUS_TX_COUNT; i++) {
+        transaction_t tx;
+        buffer_t buf = {.ptr = corpus->data + corpus->offsets[i],
+                        .size = corpus->offsets[i + 1] - corpus->offsets[i],
+                        .offset = 0};
+        if (transaction_deserialize(&buf, &tx) != PARSING_OK) {
+            return false;
+        }
+    }
+    return true;
+}
+
+typedef struct {
+    const corpus_t *corpora;
+    size_t corpus_count;
+    long rounds;
+    pthread_barrier_t *start;
+    bool ok;
+} worker_t;
+
+static void *scaling_worker(void *arg) {
+    worker_t *worker = arg;
+
+    worker->ok = true;
+    pthread_barrier_wait(worker->start);
+    for (long r = 0; r < worker->rounds; r++) {
+        for (size_t c = 0; c < worker->corpus_count; c++) {
+            worker->ok &= parse_corpus(&worker->corpora[c]);
+        }
+    }
+    return NULL;
+}
+
+// Parse all the corpora from 1 to threads threads at once, each thread doing the same work
+static int run_scaling(const corpus_t *corpora,
+                       size_t corpus_count,
+                       long threads,
+                       long rounds,
+                       bool json) {
+    static pthread_t tids[MAX_THREADS];
+    static worker_t workers[MAX_THREADS];
+    double bytes = 0;
+    double base_tx_per_s = 0;
+
+    for (size_t c = 0; c < corpus_count; c++) {
+        bytes += corpora[c].offsets[CORPUS_TX_COUNT];
+    }
+    if (json) {
+        printf("{\"benchmark\": \"tx_parser_scaling\", \"rounds\": %ld, \"results\": [",
+               rounds);
+    } else {
+        printf("%-8s %14s %10s %10s %10s\n", "threads", "tx/s", "MB/s", "speedup", "efficiency");
+    }
+    for (long n = 1; n <= threads; n++) {
+        pthread_barrier_t start;
+        pthread_barrier_init(&start, NULL, n + 1);
+        for (long t = 0; t < n; t++) {
+            workers[t] = (worker_t){.corpora = corpora,
+                                    .corpus_count = corpus_count,
+                                    .rounds = rounds,
+                                    .start = &start};
+            if (pthread_create(&tids[t], NULL, scaling_worker, &workers[t]) != 0) {
+                fprintf(stderr, "pthread_create failed\n");
+                return 1;
+            }
+        }
+        pthread_barrier_wait(&start);
+        double begin = now_ns();
+        bool ok = true;
+        for (long t = 0; t < n; t++) {
+            pthread_join(tids[t], NULL);
+            ok &= workers[t].ok;
+        }
+        double elapsed = now_ns() - begin;
+        pthread_barrier_destroy(&start);
+        if (!ok) {
+            fprintf(stderr, "parsing error\n");
+            return 1;
+        }
+
+        double tx_per_s = (double) n * rounds * corpus_count * CORPUS_TX_COUNT / (elapsed / 1e9);
+        double mb_per_s = (double) n * rounds * bytes / (elapsed / 1e3);
+        if (n == 1) {
+            base_tx_per_s = tx_per_s;
+        }
+        double speedup = tx_per_s / base_tx_per_s;
+        if (json) {
+            printf("%s\n  {\"threads\": %ld, \"tx_per_s\": %.0f, \"mb_per_s\": %.2f, "
+                   "\"speedup\": %.2f, \"efficiency\": %.2f}",
+                   n == 1 ? "" : ",",
+                   n,
+                   tx_per_s,
+                   mb_per_s,
+                   speedup,
+                   speedup / n);
+        } else {
+            printf("%-8ld %14.0f %10.1f %10.2f %10.2f\n",
+                   n,
+                   tx_per_s,
+                   mb_per_s,
+                   speedup,
+                   speedup / n);
+        }
+    }
+    if (json) {
+        printf("\n]}\n");
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    bool json = false;
+    long threads = 0;
+    long rounds = 200;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0) {
+            json = true;
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atol(argv[++i]);
+        } else {
+            rounds = atol(argv[i]);
+        }
+    }
+    if (rounds < 1 || threads < 0 || threads > MAX_THREADS) {
+        fprintf(stderr, "usage: bench_tx_parser [--json] [--threads N] [rounds]\n");
+        return 1;
+    }
+
+    if (threads > 0) {
+        size_t corpus_count = sizeof(CORPORA) / sizeof(CORPORA[0]);
+        corpus_t corpora[sizeof(CORPORA) / sizeof(CORPORA[0])];
+        for (size_t c = 0; c < corpus_count; c++) {
+            build_corpus(&CORPORA[c], &corpora[c]);
+            if (!parse_corpus(&corpora[c])) {
+                fprintf(stderr, "%s: parsing error\n", CORPORA[c].name);
+                return 1;
+            }
+        }
+        int status = run_scaling(corpora, corpus_count, threads, rounds, json);
+        for (size_t c = 0; c < corpus_count; c++) {
+            free(corpora[c].data);
+            free(corpora[c].offsets);
+        }
+        return status;
+    }
+
+    if (json) {
+        printf("{\"benchmark\": \"tx_parser\", \"rounds\": %ld, \"results\": [", rounds);
+    } else {
+        printf("%-48s %10s %10s %10s\n", "corpus", "ns/tx", "ns/field", "MB/s");
+    }
+    for (size_t c = 0; c < sizeof(CORPORA) / sizeof(CORPORA[0]); c++) {
+        corpus_t corpus;
+        build_corpus(&CORPORA[c], &corpus);
+
+        // The first round warms the caches up and checks the corpus, it is not timed
+        double start = 0;
+        for (long r = -1; r < rounds; r++) {
+            if (r == 0) {
+                start = now_ns();
+            }
+            if (!parse_corpus(&corpus)) {
+                fprintf(stderr, "%s: parsing error\n", CORPORA[c].name);
+                return 1;
+            }
+        }
+        double elapsed = now_ns() - start;
+
+        double txs = (double) CORPUS_TX_COUNT * rounds;
+        double ns_per_tx = elapsed / txs;
+        double ns_per_field = elapsed / ((double) corpus.fields * rounds);
+        double mb_per_s = (double) corpus.offsets[CORPUS_TX_COUNT] * rounds / (elapsed / 1e3);
+        if (json) {
+            printf("%s\n  {\"corpus\": \"%s\", \"type\": %u, \"transactions\": %.0f, "
+                   "\"bytes_per_tx\": %.1f, \"fields_per_tx\": %.1f, \"ns_per_tx\": %.2f, "
+                   "\"ns_per_field\": %.2f, \"mb_per_s\": %.2f}",
+                   c == 0 ? "" : ",",
+                   CORPORA[c].name,
+                   CORPORA[c].type,
+                   txs,
+                   (double) corpus.offsets[CORPUS_TX_COUNT] / CORPUS_TX_COUNT,
+                   (double) corpus.fields / CORPUS_TX_COUNT,
+                   ns_per_tx,
+                   ns_per_field,
+                   mb_per_s);
+        } else {
+            printf("%-48s %10.1f %10.2f %10.1f\n",
+                   CORPORA[c].name,
+                   ns_per_tx,
+                   ns_per_field,
+                   mb_per_s);
+        }
+        free(corpus.data);
+        free(corpus.offsets);
+    }
+    if (json) {
+        printf("\n]}\n");
+    }
+    return 0;
+}
@@ -0,0 +1,313 @@
+#!/usr/bin/env python3
+"""Differential test of transaction_deserialize() against the Python encoder of the tests.
+
+Random transactions of every type are generated and serialized by
+tests/application_client/kaia_transaction.py, then decoded by the diff_tx_parser host driver,
+once in place and once in chunks with staging. Every field decoded in transaction_t must match
+the generated values. Some fee delegated transactions are serialized as the preimage of their
+fee payer and decoded in fee payer mode, in which the other transactions must be rejected. The
+transactions are generated and checked in batches, in parallel.
+
+The data hashes are checked with pysha3, from tests/requirements.txt. Without it, only the data
+sizes are checked.
+
+Usage: diff_tx_parser.py [--driver PATH] [--count N] [--batch N] [--jobs N] [--seed N]
+"""
+import argparse
+import os
+import random
+import struct
+import subprocess
+import sys
+import time
+from multiprocessing import Pool
+from pathlib import Path
+from typing import List, Optional, Tuple
+
+try:
+    from sha3 import keccak_256
+except ImportError:
+    keccak_256 = None
+
+sys.path.insert(0, str(Path(__file__).resolve().parents[2] / "tests"))
+
+# pylint: disable=wrong-import-position
+from application_client.kaia_transaction import (  # noqa: E402
+    ADDRESS_LEN, MAX_INT256_LEN, Transaction, TransactionType)
+
+MAX_TRANSACTION_LEN = 8190
+MAX_APDU_SIZE = 255
+MAX_MEMO_LEN = 465
+PARSING_OK = 2
+PARSING_ERROR = -1
+HAS_DATA = (TransactionType.LEGACY, TransactionType.EIP2930, TransactionType.EIP1559,
+            TransactionType.VALUE_TRANSFER_MEMO, TransactionType.SMART_CONTRACT_DEPLOY,
+            TransactionType.SMART_CONTRACT_EXECUTION)
+
+# Token calls decoded by src/transaction/calldata.c: selector -> (token_call_e, static
+# arguments, dynamic argument), the arguments being "from", "to" or "value"
+TOKEN_METHODS = {
+    0xa9059cbb: (1, ("to", "value"), False),  # transfer
+    0x095ea7b3: (2, ("to", "value"), False),  # approve
+    0x23b872dd: (3, ("from", "to", "value"), False),  # transferFrom
+    0x423f6cef: (4, ("to", "value"), False),  # safeTransfer
+    0xeb795549: (4, ("to", "value"), True),  # safeTransfer with data
+    0x42842e0e: (5, ("from", "to", "value"), False),  # safeTransferFrom
+    0xb88d4fde: (5, ("from", "to", "value"), True),  # safeTransferFrom with data
+}
+
+
+def random_uint(rng: random.Random, max_len: int = MAX_INT256_LEN) -> int:
+    # Lengths are drawn first so that the short encodings and 0 are covered as well as 32 bytes
+    length = rng.choice([0, 1, 1, 2, 4, 8, rng.randint(0, max_len), max_len])
+    return rng.getrandbits(8 * min(length, max_len))
+
+
+def random_data(rng: random.Random) -> bytes:
+    length = rng.choice([0, 1, rng.randint(2, 55), rng.randint(56, 300), rng.randint(0, 4000)])
+    if length == 1:
+        # Single bytes are self encoded below 0x80
+        return bytes([rng.choice([0x00, 0x7f, 0x80, 0xff])])
+    return rng.randbytes(length)
+
+
+def random_token_call(rng: random.Random) -> bytes:
+    selector = rng.choice(list(TOKEN_METHODS))
+    _, args, dynamic = TOKEN_METHODS[selector]
+    words = []
+    for arg in args:
+        if arg == "value":
+            words.append(random_uint(rng).to_bytes(32, "big"))
+        else:
+            words.append(bytes(12) + rng.randbytes(ADDRESS_LEN))
+    if dynamic:
+        # Offset, length and content of the bytes argument, padded to a whole word
+        content = rng.randbytes(rng.choice([0, 1, rng.randint(2, 100)]))
+        words += [(32 * (len(args) + 1)).to_bytes(32, "big"),
+                  len(content).to_bytes(32, "big"),
+                  content + bytes(-len(content) % 32)]
+    calldata = selector.to_bytes(4, "big") + b"".join(words)
+    # Malformed calls: truncated, extended, with a dirty address padding, or with a wrong
+    # offset or length of the bytes argument
+    mutation = rng.random()
+    if mutation < 0.05:
+        calldata = calldata[:rng.randrange(len(calldata))]
+    elif mutation < 0.1:
+        calldata += rng.randbytes(rng.randint(1, 40))
+    elif mutation < 0.15:
+        calldata = calldata[:4] + b"\x01" + calldata[5:]
+    elif mutation < 0.2 and dynamic:
+        position = 4 + 32 * len(args) + rng.choice([31, 63, 60, rng.randrange(64)])
+        calldata = (calldata[:position] + bytes([calldata[position] ^ rng.randint(1, 255)]) +
+                    calldata[position + 1:])
+    return calldata
+
+
+def expected_token_call(calldata: bytes) -> List[str]:
+    method = TOKEN_METHODS.get(int.from_bytes(calldata[:4], "big")) if len(calldata) >= 4 else None
+    if method is None:
+        return ["0", "", "", ""]
+    call, args, dynamic = method
+    static_len = 4 + 32 * (len(args) + (1 if dynamic else 0))
+    if len(calldata) < static_len or (not dynamic and len(calldata) != static_len):
+        return ["0", "", "", ""]
+    if dynamic:
+        # The bytes argument follows the static ones, its content padded to a whole word ends
+        # the calldata and its length fits in 32 bits
+        offset = int.from_bytes(calldata[static_len - 32:static_len], "big")
+        length = int.from_bytes(calldata[static_len:static_len + 32], "big")
+        if (offset != static_len - 4 or length >= 1 << 32 or
+                len(calldata) != static_len + 32 + length + (-length % 32)):
+            return ["0", "", "", ""]
+    decoded = {"from": bytes(ADDRESS_LEN), "to": bytes(ADDRESS_LEN), "value": bytes(32)}
+    for index, arg in enumerate(args):
+        word = calldata[4 + 32 * index:4 + 32 * (index + 1)]
+        if arg != "value" and any(word[:12]):
+            return ["0", "", "", ""]
+        decoded[arg] = word if arg == "value" else word[12:]
+    return [str(call), decoded["from"].hex(), decoded["to"].hex(), decoded["value"].hex()]
+
+
+def random_transaction(rng: random.Random) -> Transaction:
+    tx_type = rng.choice(list(TransactionType))
+    base = tx_type.base
+    access_list = []
+    if tx_type in (TransactionType.EIP2930, TransactionType.EIP1559):
+        access_list = [(rng.randbytes(ADDRESS_LEN),
+                        [rng.randbytes(32) for _ in range(rng.randint(0, 3))])
+                       for _ in range(rng.choice([0, 1, rng.randint(2, 6)]))]
+    to = rng.randbytes(ADDRESS_LEN)
+    if base == TransactionType.SMART_CONTRACT_DEPLOY or (not tx_type.is_kaia and
+                                                         rng.random() < 0.1):
+        to = b""
+    chain_id: Optional[int] = random_uint(rng, 8)
+    if tx_type == TransactionType.LEGACY and rng.random() < 0.2:
+        chain_id = None
+    # Legacy nonces are limited to 64 bits by EIP-2681
+    nonce = random_uint(rng, 8 if tx_type == TransactionType.LEGACY else MAX_INT256_LEN)
+    data = random_data(rng)
+    fee_payer = None
+    if tx_type.is_fee_delegated and rng.random() < 0.3:
+        fee_payer = rng.randbytes(ADDRESS_LEN)
+    if base == TransactionType.SMART_CONTRACT_EXECUTION and rng.random() < 0.5:
+        data = random_token_call(rng)
+    elif base == TransactionType.VALUE_TRANSFER_MEMO and rng.random() < 0.5:
+        data = bytes(rng.randrange(0x80) for _ in range(rng.randint(0, MAX_MEMO_LEN + 1)))
+    return Transaction(tx_type=tx_type,
+                       nonce=nonce,
+                       gas_price=random_uint(rng),
+                       gas=random_uint(rng),
+                       to=to,
+                       value=random_uint(rng),
+                       sender=rng.randbytes(ADDRESS_LEN),
+                       data=data,
+                       ratio=rng.randint(1, 99) if tx_type.is_partial_fee_delegated else 0,
+                       chain_id=chain_id,
+                       priority_fee=random_uint(rng),
+                       access_list=access_list,
+                       human_readable=rng.random() < 0.5,
+                       code_format=rng.randint(0, 1),
+                       fee_payer=fee_payer)
+
+
+def view(value: int) -> str:
+    return value.to_bytes((value.bit_length() + 7) // 8, "big").hex()
+
+
+def expected_fields(tx: Transaction) -> str:
+    """Line written by diff_tx_parser for the transaction, see unit-tests/diff_tx_parser.c."""
+    base = tx.tx_type.base
+    has_to = base not in (TransactionType.SMART_CONTRACT_DEPLOY, TransactionType.CANCEL)
+    to = tx.to if has_to else b""
+    typed = tx.tx_type in (TransactionType.EIP2930, TransactionType.EIP1559)
+    sender = tx.sender if tx.tx_type.is_kaia else bytes(ADDRESS_LEN)
+    return ",".join([
+        str(PARSING_OK),
+        str(int(tx.tx_type)),
+        view(tx.nonce),
+        view(tx.gas_price),
+        view(tx.priority_fee) if tx.tx_type == TransactionType.EIP1559 else "",
+        view(tx.gas),
+        to.ljust(ADDRESS_LEN, b"\x00").hex(),
+        sender.hex(),
+        (tx.fee_payer or bytes(ADDRESS_LEN)).hex(),
+        str(tx.ratio if tx.tx_type.is_partial_fee_delegated else 0),
+        view(tx.value) if base != TransactionType.CANCEL else "",
+        view(tx.chain_id) if tx.chain_id is not None else "",
+        str(len(tx.access_list) if typed else 0),
+    ] + (expected_token_call(tx.data) if base == TransactionType.SMART_CONTRACT_EXECUTION else
+         ["0", "", "", ""]) + expected_data(tx))
+
+
+def expected_data(tx: Transaction) -> List[str]:
+    if tx.tx_type.base not in HAS_DATA:
+        return ["0", bytes(32).hex(), ""]
+    # Memos are displayed when they are printable ASCII and fit the display buffer
+    memo = ""
+    if (tx.tx_type.base == TransactionType.VALUE_TRANSFER_MEMO and
+            len(tx.data) <= MAX_MEMO_LEN and all(0x20 <= byte <= 0x7e for byte in tx.data)):
+        memo = tx.data.hex()
+    return [str(len(tx.data)), keccak_256(tx.data).hexdigest() if keccak_256 else "", memo]
+
+
+def same_fields(want: str, got: str) -> bool:
+    if keccak_256 is None and want.startswith(f"{PARSING_OK},"):
+        # The data hash, before the memo, is not expected
+        want_fields = want.split(",")
+        got_fields = got.split(",")
+        got_fields[-2] = want_fields[-2]
+        return want_fields == got_fields
+    return want == got
+
+
+def run_driver(driver: str, records: bytes, chunk: Optional[int], fee_payer: bool) -> List[str]:
+    args = [driver] + (["--fee-payer"] if fee_payer else [])
+    if chunk is not None:
+        args += ["--chunk", str(chunk)]
+    result = subprocess.run(args, input=records, stdout=subprocess.PIPE, check=True)
+    return result.stdout.decode().splitlines()
+
+
+def check_records(driver: str, seed: int, fee_payer: bool, raw_txs: List[bytes],
+                  expected: List[str], chunk: int) -> List[str]:
+    records = b"".join(struct.pack(">I", len(raw_tx)) + raw_tx for raw_tx in raw_txs)
+    signer = "fee payer" if fee_payer else "sender"
+    failures = []
+    for mode in ("in place", f"chunks of {chunk}"):
+        lines = run_driver(driver, records, chunk if mode != "in place" else None, fee_payer)
+        if len(lines) != len(raw_txs):
+            failures.append(f"seed {seed}, {signer}, {mode}: {len(lines)} results for "
+                            f"{len(raw_txs)} transactions")
+            continue
+        for raw_tx, want, got in zip(raw_txs, expected, lines):
+            if not same_fields(want, got):
+                failures.append(f"seed {seed}, {signer}, {mode}: {raw_tx.hex()}\n"
+                                f"  expected {want}\n  decoded  {got}")
+    return failures
+
+
+def check_batch(job: Tuple[str, int, int]) -> Tuple[int, List[str]]:
+    driver, seed, count = job
+    rng = random.Random(seed)
+    # Transactions signed by the sender, and by the fee payer
+    raw_txs: Tuple[List[bytes], List[bytes]] = ([], [])
+    expected: Tuple[List[str], List[str]] = ([], [])
+    while len(raw_txs[0]) + len(raw_txs[1]) < count:
+        tx = random_transaction(rng)
+        raw_tx = tx.serialize()
+        if len(raw_tx) > MAX_TRANSACTION_LEN:
+            continue
+        if tx.fee_payer is None and rng.random() < 0.05:
+            # Only the preimages of fee delegated transactions are signed by the fee payer
+            raw_txs[1].append(raw_tx)
+            expected[1].append(str(PARSING_ERROR))
+            continue
+        fee_payer = tx.fee_payer is not None
+        raw_txs[fee_payer].append(raw_tx)
+        expected[fee_payer].append(expected_fields(tx))
+
+    chunk = rng.randint(1, MAX_APDU_SIZE)
+    failures = []
+    for fee_payer in (False, True):
+        failures += check_records(driver, seed, fee_payer, raw_txs[fee_payer],
+                                  expected[fee_payer], chunk)
+    return count, failures
+
+
+def main() -> int:
+    default_driver = Path(__file__).resolve().parents[1] / "build" / "diff_tx_parser"
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--driver", default=str(default_driver), help="diff_tx_parser binary")
+    parser.add_argument("--count", type=int, default=1_000_000, help="transactions to check")
+    parser.add_argument("--batch", type=int, default=20_000, help="transactions per batch")
+    parser.add_argument("--jobs", type=int, default=os.cpu_count(), help="parallel batches")
+    parser.add_argument("--seed", type=int, default=random.randrange(2**32), help="base seed")
+    args = parser.parse_args()
+
+    # Each batch has its own seed, reported with its failures to replay it alone
+    jobs = []
+    for index, start in enumerate(range(0, args.count, args.batch)):
+        jobs.append((args.driver, args.seed * 1_000_003 + index, min(args.batch,
+                                                                   args.count - start)))
+    print(f"seed {args.seed}: {args.count} transactions, {len(jobs)} batches, {args.jobs} jobs")
+    if keccak_256 is None:
+        print("pysha3 is not installed, the data hashes are not checked")
+
+    checked = 0
+    failures: List[str] = []
+    start_time = time.monotonic()
+    with Pool(args.jobs) as pool:
+        for count, batch_failures in pool.imap_unordered(check_batch, jobs):
+            checked += count
+            failures += batch_failures
+    elapsed = time.monotonic() - start_time
+
+    for failure in failures[:20]:
+        print(failure)
+    print(f"{checked} transactions checked in {elapsed:.1f} s ({checked / elapsed:.0f} tx/s), "
+          f"{len(failures)} mismatches")
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,166 @@
+/*
+ * Host driver of the differential test of transaction_deserialize().
+ *
+ * Reads raw transactions from stdin, each prefixed by its length on 4 bytes big endian, and
+ * writes one line per transaction on stdout with the parser status and, when it is PARSING_OK,
+ * the decoded fields of transaction_t:
+ *
+ *   status,txType,nonce,gasprice,priorityFee,startgas,to,from,feePayer,ratio,value,chainID,
+ *   accessListCount,tokenCall,tokenFrom,tokenTo,tokenValue,dataSize,dataHash,memo
+ *
+ * Integers are in decimal and views in hexadecimal, empty when their length is 0. The token
+ * arguments are in hexadecimal, empty when no token call is decoded, and so is the memo when it
+ * is not displayed.
+ *
+ * With --chunk N, the transaction is sent in chunks of N bytes that are each copied to their
+ * own buffer and parsed with staging, as by the streaming SIGN_TX handler. Otherwise it is
+ * parsed in place from a single buffer. With --fee-payer, the transactions are fee payer
+ * signature preimages.
+ *
+ * The transactions are generated and the fields compared by diff/diff_tx_parser.py.
+ *
+ * Usage: diff_tx_parser [--fee-payer] [--chunk N] < records
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "constants.h"
+#include "transaction/deserialize.h"
+#include "transaction/types.h"
+
+static void write_hex(const uint8_t *bytes, size_t length) {
+    static const char digits[] = "0123456789abcdef";
+    for (size_t i = 0; i < length; i++) {
+        putchar(digits[bytes[i] >> 4]);
+        putchar(digits[bytes[i] & 0x0f]);
+    }
+}
+
+static void write_view(const uint256_view_t *view) {
+    putchar(',');
+    write_hex(view->value, view->length);
+}
+
+static parser_status_e deserialize_chunks(const uint8_t *raw,
+                                          size_t size,
+                                          size_t chunk_size,
+                                          bool fee_payer,
+                                          transaction_t *tx,
+                                          uint8_t *staging) {
+    static uint8_t chunk[MAX_APDU_SIZE];
+    parser_context_t parser_ctx;
+    parser_status_e status;
+    size_t offset = 0;
+
+    transaction_deserialize_init(&parser_ctx, tx);
+    transaction_deserialize_set_staging(&parser_ctx, staging, TX_STAGING_LEN);
+    if (fee_payer) {
+        transaction_deserialize_set_fee_payer(&parser_ctx);
+    }
+    do {
+        size_t chunk_len = MIN(size - offset, chunk_size);
+        bool last = offset + chunk_len == size;
+
+        // The chunk buffer is reused, the fields must be read from the staging area
+        memcpy(chunk, raw + offset, chunk_len);
+        buffer_t buf = {.ptr = chunk, .size = chunk_len, .offset = 0};
+        status = transaction_deserialize_chunk(&parser_ctx, &buf, last);
+        offset += chunk_len;
+        if (last) {
+            break;
+        }
+    } while (status == PARSING_PROCESSING || status == PARSING_OK);
+    return status;
+}
+
+static bool read_exact(uint8_t *out, size_t length) {
+    return fread(out, 1, length, stdin) == length;
+}
+
+int main(int argc, char *argv[]) {
+    static uint8_t raw[MAX_TRANSACTION_LEN];
+    static uint8_t staging[TX_STAGING_LEN];
+    static char out[1 << 16];
+    size_t chunk_size = 0;
+    bool fee_payer = false;
+    uint8_t prefix[4];
+    int arg = 1;
+
+    if (arg < argc && strcmp(argv[arg], "--fee-payer") == 0) {
+        fee_payer = true;
+        arg++;
+    }
+    if (arg + 2 == argc && strcmp(argv[arg], "--chunk") == 0) {
+        chunk_size = strtoul(argv[arg + 1], NULL, 10);
+        if (chunk_size == 0 || chunk_size > MAX_APDU_SIZE) {
+            fprintf(stderr, "chunk size must be between 1 and %d\n", MAX_APDU_SIZE);
+            return 2;
+        }
+    } else if (arg != argc) {
+        fprintf(stderr, "Usage: %s [--fee-payer] [--chunk N] < records\n", argv[0]);
+        return 2;
+    }
+    setvbuf(stdout, out, _IOFBF, sizeof(out));
+
+    while (read_exact(prefix, sizeof(prefix))) {
+        uint32_t size = (uint32_t) prefix[0] << 24 | (uint32_t) prefix[1] << 16 |
+                        (uint32_t) prefix[2] << 8 | prefix[3];
+        if (size == 0 || size > sizeof(raw) || !read_exact(raw, size)) {
+            fprintf(stderr, "invalid record\n");
+            return 1;
+        }
+
+        transaction_t tx;
+        parser_status_e status;
+        memset(&tx, 0, sizeof(tx));
+        if (chunk_size == 0) {
+            parser_context_t parser_ctx;
+            buffer_t buf = {.ptr = raw, .size = size, .offset = 0};
+            transaction_deserialize_init(&parser_ctx, &tx);
+            if (fee_payer) {
+                transaction_deserialize_set_fee_payer(&parser_ctx);
+            }
+            status = transaction_deserialize_chunk(&parser_ctx, &buf, true);
+        } else {
+            status = deserialize_chunks(raw, size, chunk_size, fee_payer, &tx, staging);
+        }
+
+        printf("%d", status);
+        if (status == PARSING_OK) {
+            printf(",%d", tx.txType);
+            write_view(&tx.nonce);
+            write_view(&tx.gasprice);
+            write_view(&tx.priorityFee);
+            write_view(&tx.startgas);
+            putchar(',');
+            write_hex(tx.to, sizeof(tx.to));
+            putchar(',');
+            write_hex(tx.from, sizeof(tx.from));
+            putchar(',');
+            write_hex(tx.feePayer, sizeof(tx.feePayer));
+            printf(",%d", tx.ratio);
+            write_view(&tx.value);
+            write_view(&tx.chainID);
+            printf(",%u", tx.accessListCount);
+            printf(",%d,", tx.tokenCall);
+            if (tx.tokenCall != TOKEN_CALL_NONE) {
+                write_hex(tx.tokenFrom, sizeof(tx.tokenFrom));
+                putchar(',');
+                write_hex(tx.tokenTo, sizeof(tx.tokenTo));
+                putchar(',');
+                write_hex(tx.tokenValue, sizeof(tx.tokenValue));
+            } else {
+                fputs(",,", stdout);
+            }
+            printf(",%u,", tx.dataSize);
+            write_hex(tx.dataHash, sizeof(tx.dataHash));
+            putchar(',');
+            write_hex(tx.memo, tx.memoLength);
+        }
+        putchar('\n');
+    }
+    return 0;
+}
@@ -0,0 +1,81 @@
+#!/usr/bin/env python3
+"""Generate the seed corpus of fuzz_tx_parser: one signature preimage per transaction type, and
+one fee payer signature preimage per fee delegated type.
+
+Each file starts with the byte seeding the chunk boundaries, whose high bit selects the fee payer
+signing mode, followed by the raw transaction.
+"""
+from pathlib import Path
+
+SENDER = bytes.fromhex("6e93a3acfbadf457f29fb0e57fa42274004c32ea")
+RECIPIENT = bytes.fromhex("0ee56b604c869e3792c99e35c1c424f88f87dc8a")
+FEE_PAYER = bytes.fromhex("5a0043070275d9f6054307ee7348bd660849d90f")
+CHAIN_ID = 1001
+
+
+def rlp_length(length: int, offset: int) -> bytes:
+    if length < 56:
+        return bytes([offset + length])
+    encoded = length.to_bytes((length.bit_length() + 7) // 8, "big")
+    return bytes([offset + 55 + len(encoded)]) + encoded
+
+
+def rlp(item) -> bytes:
+    if isinstance(item, int):
+        item = item.to_bytes((item.bit_length() + 7) // 8, "big")
+    if isinstance(item, list):
+        payload = b"".join(rlp(i) for i in item)
+        return rlp_length(len(payload), 0xc0) + payload
+    if len(item) == 1 and item[0] < 0x80:
+        return item
+    return rlp_length(len(item), 0x80) + item
+
+
+def kaia(tx_type: int, fields: list, partial: bool, trailer: list = None,
+         fee_payer: bool = False) -> bytes:
+    inner = [tx_type, 0x115c, 25000000000, 300000] + fields
+    if partial:
+        inner.append(30)
+    inner += trailer or []
+    return rlp([rlp(inner)] + ([FEE_PAYER] if fee_payer else []) + [CHAIN_ID, 0, 0])
+
+
+def main() -> None:
+    calldata = bytes.fromhex("a9059cbb") + bytes(12) + RECIPIENT + (10**18).to_bytes(32, "big")
+    bytecode = bytes(range(256)) * 4
+    access_list = [[RECIPIENT, [bytes(31) + b"\x01", bytes(32)]], [SENDER, []]]
+    seeds = {
+        "legacy": rlp([0x19, 50000000000, 300000, RECIPIENT, 10**18, b"", CHAIN_ID, 0, 0]),
+        "legacy_pre_eip155": rlp([0x19, 50000000000, 300000, RECIPIENT, 10**18, b""]),
+        "eip2930": b"\x01" + rlp([CHAIN_ID, 1, 1, 21000, RECIPIENT, 1, b"", []]),
+        "eip1559": b"\x02" + rlp([CHAIN_ID, 1, 1, 1, 21000, RECIPIENT, 1, b"", access_list]),
+    }
+    fee_payer_seeds = {}
+    flavors = {0: "", 1: "fee_delegated_", 2: "partial_fee_delegated_"}
+    for flavor, prefix in flavors.items():
+        partial = flavor == 2
+        for fee_payer in (False, True) if flavor != 0 else (False,):
+            output = fee_payer_seeds if fee_payer else seeds
+            suffix = "_fee_payer" if fee_payer else ""
+            output[prefix + "value_transfer" + suffix] = kaia(
+                0x08 | flavor, [RECIPIENT, 10**18, SENDER], partial, fee_payer=fee_payer)
+            output[prefix + "value_transfer_memo" + suffix] = kaia(
+                0x10 | flavor, [RECIPIENT, 10**18, SENDER, b"deposit tag 42"], partial,
+                fee_payer=fee_payer)
+            output[prefix + "smart_contract_deploy" + suffix] = kaia(
+                0x28 | flavor, [b"", 0, SENDER, bytecode, b""], partial, [0], fee_payer)
+            output[prefix + "smart_contract_execution" + suffix] = kaia(
+                0x30 | flavor, [RECIPIENT, 0, SENDER, calldata], partial, fee_payer=fee_payer)
+            output[prefix + "cancel" + suffix] = kaia(
+                0x38 | flavor, [SENDER], partial, fee_payer=fee_payer)
+
+    corpus = Path(__file__).parent / "corpus"
+    corpus.mkdir(exist_ok=True)
+    for name, raw_tx in seeds.items():
+        (corpus / name).write_bytes(b"\x00" + raw_tx)
+    for name, raw_tx in fee_payer_seeds.items():
+        (corpus / name).write_bytes(b"\x80" + raw_tx)
+
+
+if __name__ == "__main__":
+    main()
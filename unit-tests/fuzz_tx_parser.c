@@ -0,0 +1,166 @@
+/*
+ * Fuzzing harness of transaction_deserialize().
+ *
+ * The first input byte seeds the chunk boundaries and, with its high bit, selects the fee payer
+ * signing mode. The rest is the raw transaction. The transaction is parsed from a single buffer,
+ * then again in chunks that are each copied to their own allocation, parsed with staging and
+ * freed right away, as the streaming SIGN_TX handler does. Both parses must agree, and a field
+ * read from a freed chunk is reported by AddressSanitizer.
+ *
+ * Built with libFuzzer when FUZZ is set, otherwise with a driver replaying the files given
+ * on the command line.
+ */
+#define _POSIX_C_SOURCE 199309L  // clock_gettime
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "constants.h"
+#include "transaction/deserialize.h"
+#include "transaction/types.h"
+
+static bool same_view(const uint256_view_t *a, const uint256_view_t *b) {
+    return a->length == b->length && (a->length == 0 || memcmp(a->value, b->value, a->length) == 0);
+}
+
+static bool same_token_call(const transaction_t *a, const transaction_t *b) {
+    // The token arguments are only meaningful for a decoded call
+    return a->tokenCall == b->tokenCall && a->tokenBytes == b->tokenBytes &&
+           (a->tokenCall == TOKEN_CALL_NONE ||
+            (memcmp(a->tokenFrom, b->tokenFrom, sizeof(a->tokenFrom)) == 0 &&
+             memcmp(a->tokenTo, b->tokenTo, sizeof(a->tokenTo)) == 0 &&
+             memcmp(a->tokenValue, b->tokenValue, sizeof(a->tokenValue)) == 0));
+}
+
+static bool same_transaction(const transaction_t *a, const transaction_t *b) {
+    return a->txType == b->txType && same_view(&a->nonce, &b->nonce) &&
+           same_view(&a->gasprice, &b->gasprice) && same_view(&a->priorityFee, &b->priorityFee) &&
+           same_view(&a->startgas, &b->startgas) && memcmp(a->to, b->to, sizeof(a->to)) == 0 &&
+           memcmp(a->from, b->from, sizeof(a->from)) == 0 &&
+           memcmp(a->feePayer, b->feePayer, sizeof(a->feePayer)) == 0 && a->ratio == b->ratio &&
+           same_view(&a->value, &b->value) &&
+           same_view(&a->chainID, &b->chainID) && a->accessListCount == b->accessListCount &&
+           same_token_call(a, b) && a->dataSize == b->dataSize &&
+           memcmp(a->dataHash, b->dataHash, sizeof(a->dataHash)) == 0 &&
+           a->memoLength == b->memoLength && memcmp(a->memo, b->memo, a->memoLength) == 0;
+}
+
+static parser_status_e deserialize_chunks(const uint8_t *data,
+                                          size_t size,
+                                          uint32_t seed,
+                                          bool fee_payer,
+                                          transaction_t *tx,
+                                          uint8_t *staging) {
+    parser_context_t parser_ctx;
+    parser_status_e status = PARSING_PROCESSING;
+    size_t offset = 0;
+
+    transaction_deserialize_init(&parser_ctx, tx);
+    transaction_deserialize_set_staging(&parser_ctx, staging, TX_STAGING_LEN);
+    if (fee_payer) {
+        transaction_deserialize_set_fee_payer(&parser_ctx);
+    }
+    do {
+        // xorshift32, chunks of 1 to MAX_APDU_SIZE bytes
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        size_t chunk_len = MIN(size - offset, 1 + seed % MAX_APDU_SIZE);
+        bool last = offset + chunk_len == size;
+
+        uint8_t *chunk = malloc(chunk_len + 1);
+        if (chunk == NULL) {
+            abort();
+        }
+        memcpy(chunk, data + offset, chunk_len);
+        buffer_t buf = {.ptr = chunk, .size = chunk_len, .offset = 0};
+        status = transaction_deserialize_chunk(&parser_ctx, &buf, last);
+        free(chunk);
+
+        offset += chunk_len;
+        if (last) {
+            break;
+        }
+        // As in the SIGN_TX handler, the chunks are sent until the last one even when the
+        // transaction is already complete, trailing data is then rejected
+    } while (status == PARSING_PROCESSING || status == PARSING_OK);
+    return status;
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    transaction_t tx;
+    transaction_t chunked_tx;
+    uint8_t staging[TX_STAGING_LEN];
+
+    if (size < 1 || size - 1 > MAX_TRANSACTION_LEN) {
+        return 0;
+    }
+    uint32_t seed = data[0] | 0x100;
+    bool fee_payer = (data[0] & 0x80) != 0;
+    data++;
+    size--;
+
+    // Parsed in place from a copy of the exact size, so that overreads are caught
+    uint8_t *raw_tx = malloc(size + 1);
+    if (raw_tx == NULL) {
+        abort();
+    }
+    memcpy(raw_tx, data, size);
+    buffer_t buf = {.ptr = raw_tx, .size = size, .offset = 0};
+    parser_context_t parser_ctx;
+    memset(&tx, 0, sizeof(tx));
+    transaction_deserialize_init(&parser_ctx, &tx);
+    if (fee_payer) {
+        transaction_deserialize_set_fee_payer(&parser_ctx);
+    }
+    parser_status_e status = transaction_deserialize_chunk(&parser_ctx, &buf, true);
+
+    memset(&chunked_tx, 0, sizeof(chunked_tx));
+    parser_status_e chunked_status =
+        deserialize_chunks(data, size, seed, fee_payer, &chunked_tx, staging);
+
+    if ((status == PARSING_OK) != (chunked_status == PARSING_OK)) {
+        abort();
+    }
+    if (status == PARSING_OK && !same_transaction(&tx, &chunked_tx)) {
+        abort();
+    }
+    free(raw_tx);
+    return 0;
+}
+
+#ifndef FUZZ
+
+// Replay driver for hosts without libFuzzer
+int main(int argc, char *argv[]) {
+    static uint8_t input[1 + MAX_TRANSACTION_LEN];
+    struct timespec start, end;
+    unsigned long execs = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 1; i < argc; i++) {
+        FILE *f = fopen(argv[i], "rb");
+        if (f == NULL) {
+            perror(argv[i]);
+            return 1;
+        }
+        size_t size = fread(input, 1, sizeof(input), f);
+        fclose(f);
+        // Replay every chunk split
+        for (unsigned int seed = 0; seed < 256; seed++) {
+            input[0] = seed;
+            LLVMFuzzerTestOneInput(input, size);
+            execs++;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    printf("%lu runs in %.3f s, %.0f exec/s\n", execs, elapsed, execs / elapsed);
+    return 0;
+}
+#endif
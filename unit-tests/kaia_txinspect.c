@@ -0,0 +1,358 @@
+/*
+ * Host inspection of raw transactions, with the strings displayed by the device.
+ *
+ * Each file is memory mapped and holds signature preimages, either each prefixed by its length
+ * on 4 bytes big endian, or with --hex one per line in hexadecimal. Every transaction is parsed
+ * in chunks of an APDU and formatted by review_strings_format(), as on the device, and one JSON
+ * record is written per transaction on stdout:
+ *
+ *   {"file":"txs.bin","index":0,"offset":0,"size":42,"status":"ok",
+ *    "review":[{"label":"Type","value":"Legacy"},...]}
+ *
+ * A transaction rejected by the parser has the "parse_error" status and the parser status in
+ * "error". One the device would refuse to display has the "display_error" status and the status
+ * word in "sw". With --hex, "offset" is the line number. With --fee-payer, the transactions are
+ * fee payer signature preimages, reviewed as when signed by the fee payer.
+ *
+ * With HAVE_STREAMING_SIGN_TX, as in the default device build, each chunk is dropped once parsed
+ * and the transaction length is not bounded. Without it, the chunks viewed by the transaction are
+ * kept and bounded to MAX_TRANSACTION_LEN bytes, those of the access list and of the data are
+ * dropped.
+ *
+ * Usage: kaia-txinspect [--hex] [--fee-payer] FILE...
+ */
+#define _POSIX_C_SOURCE 200112L  // mmap
+
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "constants.h"
+#include "sw.h"
+#include "transaction/deserialize.h"
+#include "transaction/registry.h"
+#include "transaction/types.h"
+#include "ui/review_strings.h"
+
+typedef struct {
+    unsigned long ok;
+    unsigned long parse_error;
+    unsigned long display_error;
+} summary_t;
+
+static const char *parser_status_name(parser_status_e status) {
+    switch (status) {
+        case PARSING_OK:
+            return "PARSING_OK";
+        case PARSING_PROCESSING:
+            return "PARSING_PROCESSING";
+        case PARSING_CONTINUE:
+            return "PARSING_CONTINUE";
+        case PARSING_ERROR:
+            return "PARSING_ERROR";
+        case NONCE_PARSING_ERROR:
+            return "NONCE_PARSING_ERROR";
+        case TO_PARSING_ERROR:
+            return "TO_PARSING_ERROR";
+        case VALUE_PARSING_ERROR:
+            return "VALUE_PARSING_ERROR";
+        case MEMO_LENGTH_ERROR:
+            return "MEMO_LENGTH_ERROR";
+        case MEMO_PARSING_ERROR:
+            return "MEMO_PARSING_ERROR";
+        case MEMO_ENCODING_ERROR:
+            return "MEMO_ENCODING_ERROR";
+        case WRONG_LENGTH_ERROR:
+            return "WRONG_LENGTH_ERROR";
+    }
+    return "UNKNOWN";
+}
+
+// Write a JSON string, the review strings are printable ASCII but the file names may not be
+static void write_json_string(const char *s) {
+    putchar('"');
+    for (; *s != '\0'; s++) {
+        unsigned char c = *s;
+        if (c == '"' || c == '\\') {
+            putchar('\\');
+            putchar(c);
+        } else if (c < 0x20) {
+            printf("\\u%04x", c);
+        } else {
+            putchar(c);
+        }
+    }
+    putchar('"');
+}
+
+// Parse a transaction in chunks of an APDU, retained or dropped as on the device
+static parser_status_e deserialize_chunks(parser_context_t *parser_ctx,
+                                          const uint8_t *raw,
+                                          size_t size) {
+    static uint8_t chunk[MAX_APDU_SIZE];
+#ifndef HAVE_STREAMING_SIGN_TX
+    static uint8_t raw_tx[MAX_TRANSACTION_LEN];
+    size_t raw_tx_len = 0;
+#endif
+    parser_status_e status;
+    size_t offset = 0;
+
+    do {
+        size_t chunk_len = MIN(size - offset, MAX_APDU_SIZE);
+        bool last = offset + chunk_len == size;
+        uint8_t *dest = chunk;
+
+#ifndef HAVE_STREAMING_SIGN_TX
+        if (transaction_deserialize_retains_chunk(parser_ctx, chunk_len)) {
+            if (raw_tx_len + chunk_len > sizeof(raw_tx)) {
+                return WRONG_LENGTH_ERROR;
+            }
+            dest = raw_tx + raw_tx_len;
+            raw_tx_len += chunk_len;
+        }
+#endif
+        memcpy(dest, raw + offset, chunk_len);
+        buffer_t buf = {.ptr = dest, .size = chunk_len, .offset = 0};
+        status = transaction_deserialize_chunk(parser_ctx, &buf, last);
+        offset += chunk_len;
+        if (last) {
+            break;
+        }
+    } while (status == PARSING_PROCESSING || status == PARSING_OK);
+    return status;
+}
+
+// Parse and format one transaction
+static void inspect(const char *file,
+                    unsigned long index,
+                    size_t offset,
+                    const uint8_t *raw,
+                    size_t size,
+                    bool fee_payer,
+                    summary_t *summary) {
+#ifdef HAVE_STREAMING_SIGN_TX
+    static uint8_t staging[TX_STAGING_LEN];
+#endif
+    parser_context_t parser_ctx;
+    transaction_t tx;
+    review_strings_t strings;
+    review_pair_t pairs[REVIEW_MAX_PAIRS];
+
+    printf("{\"file\":");
+    write_json_string(file);
+    printf(",\"index\":%lu,\"offset\":%zu,\"size\":%zu,", index, offset, size);
+
+    transaction_deserialize_init(&parser_ctx, &tx);
+    if (fee_payer) {
+        transaction_deserialize_set_fee_payer(&parser_ctx);
+    }
+#ifdef HAVE_STREAMING_SIGN_TX
+    transaction_deserialize_set_staging(&parser_ctx, staging, sizeof(staging));
+#endif
+    parser_status_e status = deserialize_chunks(&parser_ctx, raw, size);
+    if (status != PARSING_OK) {
+        printf("\"status\":\"parse_error\",\"error\":\"%s\"}\n", parser_status_name(status));
+        summary->parse_error++;
+        return;
+    }
+
+    uint16_t sw = review_strings_format(&tx, &strings);
+    if (sw != SW_OK) {
+        printf("\"status\":\"display_error\",\"sw\":\"0x%04X\"}\n", sw);
+        summary->display_error++;
+        return;
+    }
+
+    size_t count = review_strings_pairs(tx_registry_lookup(tx.txType), &tx, &strings, pairs);
+    printf("\"status\":\"ok\",\"review\":[");
+    for (size_t i = 0; i < count; i++) {
+        printf(i == 0 ? "{\"label\":" : ",{\"label\":");
+        write_json_string(pairs[i].label);
+        printf(",\"value\":");
+        write_json_string(pairs[i].value);
+        putchar('}');
+    }
+    printf("]}\n");
+    summary->ok++;
+}
+
+// Records of a 4 bytes big endian length followed by the raw transaction
+static bool inspect_binary(const char *file,
+                           const uint8_t *data,
+                           size_t size,
+                           bool fee_payer,
+                           summary_t *summary) {
+    unsigned long index = 0;
+    size_t offset = 0;
+
+    while (offset < size) {
+        if (size - offset < 4) {
+            fprintf(stderr, "%s: truncated length at offset %zu\n", file, offset);
+            return false;
+        }
+        uint32_t length = (uint32_t) data[offset] << 24 | (uint32_t) data[offset + 1] << 16 |
+                          (uint32_t) data[offset + 2] << 8 | data[offset + 3];
+        if (length > size - offset - 4) {
+            fprintf(stderr, "%s: truncated transaction at offset %zu\n", file, offset);
+            return false;
+        }
+        inspect(file, index++, offset, data + offset + 4, length, fee_payer, summary);
+        offset += 4 + length;
+    }
+    return true;
+}
+
+static int hex_digit(uint8_t c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+// One transaction per line in hexadecimal, with an optional 0x prefix. Blank lines are skipped,
+// malformed ones are reported and skipped.
+static bool inspect_hex(const char *file,
+                        const uint8_t *data,
+                        size_t size,
+                        bool fee_payer,
+                        summary_t *summary) {
+    // Large enough for any line, the length of a transaction is checked as on the device
+    uint8_t *raw = malloc(size / 2 + 1);
+    unsigned long index = 0;
+    size_t line = 0;
+    size_t pos = 0;
+    bool ok = true;
+
+    if (raw == NULL) {
+        perror(file);
+        return false;
+    }
+    while (pos < size) {
+        const uint8_t *end = memchr(data + pos, '\n', size - pos);
+        size_t next = end == NULL ? size : (size_t) (end - data) + 1;
+        size_t start = pos;
+        size_t stop = end == NULL ? size : (size_t) (end - data);
+        line++;
+        pos = next;
+
+        while (start < stop && (data[start] == ' ' || data[start] == '\t')) {
+            start++;
+        }
+        while (stop > start &&
+               (data[stop - 1] == ' ' || data[stop - 1] == '\t' || data[stop - 1] == '\r')) {
+            stop--;
+        }
+        if (stop - start >= 2 && data[start] == '0' && (data[start + 1] | 0x20) == 'x') {
+            start += 2;
+        }
+        if (start == stop) {
+            continue;
+        }
+        if ((stop - start) % 2 != 0) {
+            fprintf(stderr, "%s:%zu: odd number of hex digits, skipped\n", file, line);
+            ok = false;
+            continue;
+        }
+
+        size_t length = (stop - start) / 2;
+        size_t i;
+        for (i = 0; i < length; i++) {
+            int high = hex_digit(data[start + 2 * i]);
+            int low = hex_digit(data[start + 2 * i + 1]);
+            if (high < 0 || low < 0) {
+                break;
+            }
+            raw[i] = high << 4 | low;
+        }
+        if (i < length) {
+            fprintf(stderr, "%s:%zu: invalid hex digit, skipped\n", file, line);
+            ok = false;
+            continue;
+        }
+        inspect(file, index++, line, raw, length, fee_payer, summary);
+    }
+    free(raw);
+    return ok;
+}
+
+static bool inspect_file(const char *file, bool hex, bool fee_payer, summary_t *summary) {
+    struct stat st;
+    bool ok;
+
+    int fd = open(file, O_RDONLY);
+    if (fd < 0) {
+        perror(file);
+        return false;
+    }
+    if (fstat(fd, &st) < 0) {
+        perror(file);
+        close(fd);
+        return false;
+    }
+    if (st.st_size == 0) {
+        close(fd);
+        return true;
+    }
+
+    void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        perror(file);
+        return false;
+    }
+    if (hex) {
+        ok = inspect_hex(file, data, st.st_size, fee_payer, summary);
+    } else {
+        ok = inspect_binary(file, data, st.st_size, fee_payer, summary);
+    }
+    munmap(data, st.st_size);
+    return ok;
+}
+
+int main(int argc, char *argv[]) {
+    static char out[1 << 16];
+    summary_t summary = {0, 0, 0};
+    bool hex = false;
+    bool fee_payer = false;
+    bool ok = true;
+    int first = 1;
+
+    if (first < argc && strcmp(argv[first], "--hex") == 0) {
+        hex = true;
+        first++;
+    }
+    if (first < argc && strcmp(argv[first], "--fee-payer") == 0) {
+        fee_payer = true;
+        first++;
+    }
+    if (first >= argc) {
+        fprintf(stderr, "Usage: %s [--hex] [--fee-payer] FILE...\n", argv[0]);
+        return 2;
+    }
+
+    setvbuf(stdout, out, _IOFBF, sizeof(out));
+    for (int i = first; i < argc; i++) {
+        ok &= inspect_file(argv[i], hex, fee_payer, &summary);
+    }
+    fflush(stdout);
+
+    fprintf(stderr,
+            "%lu transactions: %lu ok, %lu parse errors, %lu display errors\n",
+            summary.ok + summary.parse_error + summary.display_error,
+            summary.ok,
+            summary.parse_error,
+            summary.display_error);
+    return ok ? 0 : 1;
+}
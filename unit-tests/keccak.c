@@ -0,0 +1,95 @@
+/*
+ * Host implementation of data_hash.h: a portable Keccak-256, linked into the unit tests and the
+ * host tools in place of src/transaction/data_hash.c, which uses the cx Keccak-256 of the device.
+ */
+
+#include <string.h>  // memset
+
+#include "transaction/data_hash.h"
+
+// Keccak-256 absorbs 136 bytes blocks: 1600 bits of state less twice the digest size
+#define KECCAK_RATE (200 - 2 * DATA_HASH_LEN)
+
+#define ROTL64(x, n) (((x) << (n)) | ((x) >> (64 - (n))))
+
+static const uint64_t ROUND_CONSTANTS[24] = {
+    0x0000000000000001, 0x0000000000008082, 0x800000000000808a, 0x8000000080008000,
+    0x000000000000808b, 0x0000000080000001, 0x8000000080008081, 0x8000000000008009,
+    0x000000000000008a, 0x0000000000000088, 0x0000000080008009, 0x000000008000000a,
+    0x000000008000808b, 0x800000000000008b, 0x8000000000008089, 0x8000000000008003,
+    0x8000000000008002, 0x8000000000000080, 0x000000000000800a, 0x800000008000000a,
+    0x8000000080008081, 0x8000000000008080, 0x0000000080000001, 0x8000000080008008};
+
+// Rotation and destination lane of the rho and pi steps, following lane 1
+static const uint8_t ROTATIONS[24] = {1,  3,  6,  10, 15, 21, 28, 36, 45, 55, 2,  14,
+                                      27, 41, 56, 8,  25, 43, 62, 18, 39, 61, 20, 44};
+static const uint8_t LANES[24] = {10, 7,  11, 17, 18, 3, 5,  16, 8,  21, 24, 4,
+                                  15, 23, 19, 13, 12, 2, 20, 14, 22, 9,  6,  1};
+
+static void keccakf(uint64_t state[25]) {
+    for (int round = 0; round < 24; round++) {
+        uint64_t columns[5];
+        uint64_t lane;
+
+        // Theta
+        for (int i = 0; i < 5; i++) {
+            columns[i] =
+                state[i] ^ state[i + 5] ^ state[i + 10] ^ state[i + 15] ^ state[i + 20];
+        }
+        for (int i = 0; i < 5; i++) {
+            lane = columns[(i + 4) % 5] ^ ROTL64(columns[(i + 1) % 5], 1);
+            for (int j = 0; j < 25; j += 5) {
+                state[j + i] ^= lane;
+            }
+        }
+        // Rho and pi
+        lane = state[1];
+        for (int i = 0; i < 24; i++) {
+            uint64_t next = state[LANES[i]];
+            state[LANES[i]] = ROTL64(lane, ROTATIONS[i]);
+            lane = next;
+        }
+        // Chi
+        for (int j = 0; j < 25; j += 5) {
+            for (int i = 0; i < 5; i++) {
+                columns[i] = state[j + i];
+            }
+            for (int i = 0; i < 5; i++) {
+                state[j + i] ^= ~columns[(i + 1) % 5] & columns[(i + 2) % 5];
+            }
+        }
+        // Iota
+        state[0] ^= ROUND_CONSTANTS[round];
+    }
+}
+
+static void absorb(data_hash_t *hash, uint8_t byte) {
+    hash->state[hash->pos / 8] ^= (uint64_t) byte << (8 * (hash->pos % 8));
+    if (++hash->pos == KECCAK_RATE) {
+        keccakf(hash->state);
+        hash->pos = 0;
+    }
+}
+
+bool data_hash_init(data_hash_t *hash) {
+    memset(hash, 0, sizeof(*hash));
+    return true;
+}
+
+bool data_hash_update(data_hash_t *hash, const uint8_t *data, uint32_t length) {
+    for (uint32_t i = 0; i < length; i++) {
+        absorb(hash, data[i]);
+    }
+    return true;
+}
+
+bool data_hash_final(data_hash_t *hash, uint8_t *digest) {
+    // Keccak padding, not the SHA-3 one: 0x01, zeroes, then 0x80 on the last byte of the block
+    hash->state[hash->pos / 8] ^= (uint64_t) 0x01 << (8 * (hash->pos % 8));
+    hash->state[(KECCAK_RATE - 1) / 8] ^= (uint64_t) 0x80 << 56;
+    keccakf(hash->state);
+    for (uint32_t i = 0; i < DATA_HASH_LEN; i++) {
+        digest[i] = (uint8_t) (hash->state[i / 8] >> (8 * (i % 8)));
+    }
+    return true;
+}
@@ -0,0 +1,21 @@
+/*
+ * Host stand-in of the crypto_helpers.h of the SDK: the derivation of the public key of a path,
+ * every step of it from the seed, which the cached derivation is compared to.
+ */
+
+#pragma once
+
+#include <stddef.h>  // size_t
+#include <stdint.h>  // uint*_t
+
+#include "cx.h"
+
+cx_err_t bip32_derive_with_seed_get_pubkey_256(unsigned int derivation_mode,
+                                               cx_curve_t curve,
+                                               const uint32_t *path,
+                                               size_t path_len,
+                                               uint8_t raw_pubkey[static 65],
+                                               uint8_t *chain_code,
+                                               cx_md_t hash_id,
+                                               unsigned char *seed,
+                                               size_t seed_len);
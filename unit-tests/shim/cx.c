@@ -0,0 +1,294 @@
+/*
+ * Host implementation of the cx and os functions of shim/cx.h and shim/os.h, with OpenSSL.
+ *
+ * os_derive_bip32_no_throw() derives every step of a path from the seed set by the test, with
+ * its own BIP32 implementation, so that the cached derivation of src/helper/bip32_cache.c is
+ * compared to an independent one.
+ */
+
+#define OPENSSL_SUPPRESS_DEPRECATED  // EC_KEY, for ECDSA_do_sign()
+
+#include <string.h>  // memcmp, memcpy, memset
+
+#include <openssl/bn.h>
+#include <openssl/ec.h>
+#include <openssl/ecdsa.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/obj_mac.h>
+
+#include "cx.h"
+#include "os.h"
+#include "crypto_helpers.h"
+
+#define HARDENED_INDEX 0x80000000
+#define KEY_LEN        32
+
+static uint8_t g_seed[64];
+static size_t g_seed_len;
+static bool g_pin_validated = true;
+static unsigned int g_seed_derivations;
+
+void shim_set_seed(const uint8_t *seed, size_t seed_len) {
+    memcpy(g_seed, seed, seed_len);
+    g_seed_len = seed_len;
+}
+
+void shim_set_pin_validated(bool validated) {
+    g_pin_validated = validated;
+}
+
+unsigned int shim_take_seed_derivations(void) {
+    unsigned int count = g_seed_derivations;
+
+    g_seed_derivations = 0;
+    return count;
+}
+
+bolos_bool_t os_global_pin_is_validated(void) {
+    return g_pin_validated ? BOLOS_TRUE : BOLOS_FALSE;
+}
+
+static const EC_GROUP *secp256k1(void) {
+    static EC_GROUP *group;
+
+    if (group == NULL) {
+        group = EC_GROUP_new_by_curve_name(NID_secp256k1);
+    }
+    return group;
+}
+
+// Compute the public key of a private key, compressed or not
+static bool public_key_of(const uint8_t private_key[KEY_LEN], uint8_t *out, bool compressed) {
+    BN_CTX *ctx = BN_CTX_new();
+    BIGNUM *d = BN_bin2bn(private_key, KEY_LEN, NULL);
+    EC_POINT *point = EC_POINT_new(secp256k1());
+    size_t len = compressed ? 33 : 65;
+    bool ok = EC_POINT_mul(secp256k1(), point, d, NULL, NULL, ctx) == 1 &&
+              EC_POINT_point2oct(secp256k1(),
+                                 point,
+                                 compressed ? POINT_CONVERSION_COMPRESSED
+                                            : POINT_CONVERSION_UNCOMPRESSED,
+                                 out,
+                                 len,
+                                 ctx) == len;
+
+    EC_POINT_free(point);
+    BN_clear_free(d);
+    BN_CTX_free(ctx);
+    return ok;
+}
+
+// BIP32 derivation of a path from a seed, every step included
+static bool derive_from_seed(const uint8_t *seed,
+                             size_t seed_len,
+                             const uint32_t *path,
+                             size_t path_len,
+                             uint8_t private_key[KEY_LEN],
+                             uint8_t chain_code[KEY_LEN]) {
+    uint8_t digest[2 * KEY_LEN];
+    unsigned int digest_len = sizeof(digest);
+    BN_CTX *ctx = BN_CTX_new();
+    BIGNUM *key = BN_new();
+    BIGNUM *tweak = BN_new();
+    bool ok = HMAC(EVP_sha512(), "Bitcoin seed", 12, seed, seed_len, digest, &digest_len) != NULL;
+
+    BN_bin2bn(digest, KEY_LEN, key);
+    memcpy(chain_code, digest + KEY_LEN, KEY_LEN);
+    for (size_t i = 0; ok && i < path_len; i++) {
+        uint8_t data[33 + 4] = {0};
+
+        // Hardened children hash the private key, normal ones the compressed public key
+        BN_bn2binpad(key, private_key, KEY_LEN);
+        if (path[i] & HARDENED_INDEX) {
+            memcpy(data + 1, private_key, KEY_LEN);
+        } else {
+            ok = public_key_of(private_key, data, true);
+        }
+        U4BE_ENCODE(data, 33, path[i]);
+        ok = ok && HMAC(EVP_sha512(), chain_code, KEY_LEN, data, sizeof(data), digest,
+                        &digest_len) != NULL;
+        BN_bin2bn(digest, KEY_LEN, tweak);
+        ok = ok && BN_mod_add(key, key, tweak, EC_GROUP_get0_order(secp256k1()), ctx) == 1;
+        memcpy(chain_code, digest + KEY_LEN, KEY_LEN);
+    }
+    BN_bn2binpad(key, private_key, KEY_LEN);
+
+    BN_clear_free(key);
+    BN_clear_free(tweak);
+    BN_CTX_free(ctx);
+    return ok;
+}
+
+cx_err_t os_derive_bip32_no_throw(cx_curve_t curve,
+                                  const uint32_t *path,
+                                  size_t path_len,
+                                  uint8_t *raw_private_key,
+                                  uint8_t *chain_code) {
+    uint8_t unused_chain_code[KEY_LEN];
+
+    if (curve != CX_CURVE_256K1 || !g_pin_validated || g_seed_len == 0) {
+        return CX_INTERNAL_ERROR;
+    }
+    g_seed_derivations++;
+    // The OS writes 64 bytes of private key
+    memset(raw_private_key, 0, 2 * KEY_LEN);
+    if (!derive_from_seed(g_seed,
+                          g_seed_len,
+                          path,
+                          path_len,
+                          raw_private_key,
+                          chain_code != NULL ? chain_code : unused_chain_code)) {
+        return CX_INTERNAL_ERROR;
+    }
+    return CX_OK;
+}
+
+cx_err_t bip32_derive_with_seed_get_pubkey_256(unsigned int derivation_mode,
+                                               cx_curve_t curve,
+                                               const uint32_t *path,
+                                               size_t path_len,
+                                               uint8_t raw_pubkey[static 65],
+                                               uint8_t *chain_code,
+                                               cx_md_t hash_id,
+                                               unsigned char *seed,
+                                               size_t seed_len) {
+    uint8_t private_key[KEY_LEN];
+    uint8_t unused_chain_code[KEY_LEN];
+
+    if (derivation_mode != HDW_NORMAL || curve != CX_CURVE_256K1 || hash_id != CX_SHA512) {
+        return CX_INVALID_PARAMETER;
+    }
+    if (seed == NULL) {
+        seed = g_seed;
+        seed_len = g_seed_len;
+    }
+    if (!derive_from_seed(seed,
+                          seed_len,
+                          path,
+                          path_len,
+                          private_key,
+                          chain_code != NULL ? chain_code : unused_chain_code) ||
+        !public_key_of(private_key, raw_pubkey, false)) {
+        return CX_INTERNAL_ERROR;
+    }
+    return CX_OK;
+}
+
+cx_err_t cx_ecfp_init_private_key_no_throw(cx_curve_t curve,
+                                           const uint8_t *raw_key,
+                                           size_t key_len,
+                                           cx_ecfp_private_key_t *private_key) {
+    if (key_len != KEY_LEN) {
+        return CX_INVALID_PARAMETER;
+    }
+    private_key->curve = curve;
+    private_key->d_len = key_len;
+    memcpy(private_key->d, raw_key, key_len);
+    return CX_OK;
+}
+
+cx_err_t cx_ecfp_generate_pair_no_throw(cx_curve_t curve,
+                                        cx_ecfp_public_key_t *public_key,
+                                        cx_ecfp_private_key_t *private_key,
+                                        bool keep_private) {
+    if (curve != CX_CURVE_256K1 || !keep_private) {
+        return CX_INVALID_PARAMETER;
+    }
+    public_key->curve = curve;
+    public_key->W_len = sizeof(public_key->W);
+    return public_key_of(private_key->d, public_key->W, false) ? CX_OK : CX_INTERNAL_ERROR;
+}
+
+cx_err_t cx_hmac_sha512_init_no_throw(cx_hmac_sha512_t *hmac, const uint8_t *key, size_t key_len) {
+    if (key_len > sizeof(hmac->key)) {
+        return CX_INVALID_PARAMETER;
+    }
+    memcpy(hmac->key, key, key_len);
+    hmac->key_len = key_len;
+    return CX_OK;
+}
+
+cx_err_t cx_hmac_no_throw(cx_hmac_t *hmac,
+                          uint32_t mode,
+                          const uint8_t *in,
+                          size_t len,
+                          uint8_t *mac,
+                          size_t mac_len) {
+    unsigned int digest_len = 64;
+
+    // Only one shot HMAC-SHA512 is used
+    if (mode != CX_LAST || mac_len != digest_len) {
+        return CX_INVALID_PARAMETER;
+    }
+    if (HMAC(EVP_sha512(), hmac->key, hmac->key_len, in, len, mac, &digest_len) == NULL) {
+        return CX_INTERNAL_ERROR;
+    }
+    return CX_OK;
+}
+
+cx_err_t cx_math_cmp_no_throw(const uint8_t *a, const uint8_t *b, size_t length, int *diff) {
+    *diff = memcmp(a, b, length);
+    return CX_OK;
+}
+
+cx_err_t cx_math_addm_no_throw(uint8_t *r,
+                               const uint8_t *a,
+                               const uint8_t *b,
+                               const uint8_t *m,
+                               size_t len) {
+    BN_CTX *ctx = BN_CTX_new();
+    BIGNUM *x = BN_bin2bn(a, len, NULL);
+    BIGNUM *y = BN_bin2bn(b, len, NULL);
+    BIGNUM *modulus = BN_bin2bn(m, len, NULL);
+    bool ok = BN_mod_add(x, x, y, modulus, ctx) == 1 && BN_bn2binpad(x, r, len) == (int) len;
+
+    BN_clear_free(x);
+    BN_clear_free(y);
+    BN_free(modulus);
+    BN_CTX_free(ctx);
+    return ok ? CX_OK : CX_INTERNAL_ERROR;
+}
+
+bool cx_math_is_zero(const uint8_t *a, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        if (a[i] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// The nonce is random, not RFC 6979: the tests verify the signatures, they do not compare them
+cx_err_t cx_ecdsa_sign_rs_no_throw(const cx_ecfp_private_key_t *key,
+                                   uint32_t mode,
+                                   cx_md_t hash_id,
+                                   const uint8_t *hash,
+                                   size_t hash_len,
+                                   size_t rs_len,
+                                   uint8_t *sig_r,
+                                   uint8_t *sig_s,
+                                   uint32_t *info) {
+    EC_KEY *ec_key = EC_KEY_new_by_curve_name(NID_secp256k1);
+    BIGNUM *d = BN_bin2bn(key->d, key->d_len, NULL);
+    ECDSA_SIG *signature = NULL;
+    cx_err_t error = CX_INTERNAL_ERROR;
+
+    (void) mode;
+    (void) hash_id;
+    if (EC_KEY_set_private_key(ec_key, d) == 1 &&
+        (signature = ECDSA_do_sign(hash, hash_len, ec_key)) != NULL &&
+        BN_bn2binpad(ECDSA_SIG_get0_r(signature), sig_r, rs_len) == (int) rs_len &&
+        BN_bn2binpad(ECDSA_SIG_get0_s(signature), sig_s, rs_len) == (int) rs_len) {
+        // The parity of the signature point is not recovered
+        if (info != NULL) {
+            *info = 0;
+        }
+        error = CX_OK;
+    }
+
+    ECDSA_SIG_free(signature);
+    BN_clear_free(d);
+    EC_KEY_free(ec_key);
+    return error;
+}
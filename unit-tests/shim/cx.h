@@ -0,0 +1,94 @@
+/*
+ * Host stand-in of the cx.h of the SDK, limited to what src/helper/bip32_cache.c uses. The
+ * functions are implemented with OpenSSL in shim/cx.c.
+ */
+
+#pragma once
+
+#include <stdbool.h>  // bool
+#include <stddef.h>   // size_t
+#include <stdint.h>   // uint*_t
+
+typedef uint32_t cx_err_t;
+
+#define CX_OK                0x00000000
+#define CX_INTERNAL_ERROR    0xFFFFFF85
+#define CX_INVALID_PARAMETER 0xFFFFFF84
+
+#define CX_CHECK(call)      \
+    do {                    \
+        error = call;       \
+        if (error) {        \
+            goto end;       \
+        }                   \
+    } while (0)
+
+#define CX_LAST        (1 << 0)
+#define CX_RND_RFC6979 (3 << 9)
+
+#define CX_ECCINFO_PARITY_ODD 1
+
+#define CX_SHA256_SIZE    32
+#define CX_RIPEMD160_SIZE 20
+
+typedef enum { CX_CURVE_256K1 = 0x21 } cx_curve_t;
+
+typedef enum { CX_SHA256 = 3, CX_SHA512 = 5 } cx_md_t;
+
+typedef struct {
+    cx_curve_t curve;
+    size_t d_len;
+    uint8_t d[32];
+} cx_ecfp_private_key_t;
+
+typedef struct {
+    cx_curve_t curve;
+    size_t W_len;
+    uint8_t W[65];
+} cx_ecfp_public_key_t;
+
+typedef struct {
+    uint8_t key[64];
+    size_t key_len;
+} cx_hmac_t;
+
+typedef cx_hmac_t cx_hmac_sha512_t;
+
+cx_err_t cx_ecfp_init_private_key_no_throw(cx_curve_t curve,
+                                           const uint8_t *raw_key,
+                                           size_t key_len,
+                                           cx_ecfp_private_key_t *private_key);
+
+cx_err_t cx_ecfp_generate_pair_no_throw(cx_curve_t curve,
+                                        cx_ecfp_public_key_t *public_key,
+                                        cx_ecfp_private_key_t *private_key,
+                                        bool keep_private);
+
+cx_err_t cx_hmac_sha512_init_no_throw(cx_hmac_sha512_t *hmac, const uint8_t *key, size_t key_len);
+
+cx_err_t cx_hmac_no_throw(cx_hmac_t *hmac,
+                          uint32_t mode,
+                          const uint8_t *in,
+                          size_t len,
+                          uint8_t *mac,
+                          size_t mac_len);
+
+cx_err_t cx_math_cmp_no_throw(const uint8_t *a, const uint8_t *b, size_t length, int *diff);
+
+cx_err_t cx_math_addm_no_throw(uint8_t *r,
+                               const uint8_t *a,
+                               const uint8_t *b,
+                               const uint8_t *m,
+                               size_t len);
+
+bool cx_math_is_zero(const uint8_t *a, size_t len);
+
+cx_err_t cx_ecdsa_sign_rs_no_throw(const cx_ecfp_private_key_t *key,
+                                   uint32_t mode,
+                                   cx_md_t hash_id,
+                                   const uint8_t *hash,
+                                   size_t hash_len,
+                                   size_t rs_len,
+                                   uint8_t *sig_r,
+                                   uint8_t *sig_s,
+                                   uint32_t *info);
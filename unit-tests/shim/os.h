@@ -0,0 +1,50 @@
+/*
+ * Host stand-in of the os.h of the SDK, limited to what src/helper/bip32_cache.c uses. The seed
+ * and the PIN state of the device are set by the tests, see shim/cx.c.
+ */
+
+#pragma once
+
+#include <stdbool.h>  // bool
+#include <stddef.h>   // size_t
+#include <stdint.h>   // uint*_t
+#include <string.h>   // explicit_bzero
+
+#include "cx.h"
+
+typedef uint8_t bolos_bool_t;
+
+#define BOLOS_TRUE  0xaa
+#define BOLOS_FALSE 0x55
+
+#define HDW_NORMAL 0
+
+#define U4BE_ENCODE(buf, off, value)                \
+    do {                                            \
+        (buf)[(off) + 0] = ((value) >> 24) & 0xFF; \
+        (buf)[(off) + 1] = ((value) >> 16) & 0xFF; \
+        (buf)[(off) + 2] = ((value) >> 8) & 0xFF;  \
+        (buf)[(off) + 3] = (value) & 0xFF;         \
+    } while (0)
+
+/**
+ * Derive every step of a path from the seed, as the OS does.
+ */
+cx_err_t os_derive_bip32_no_throw(cx_curve_t curve,
+                                  const uint32_t *path,
+                                  size_t path_len,
+                                  uint8_t *raw_private_key,
+                                  uint8_t *chain_code);
+
+bolos_bool_t os_global_pin_is_validated(void);
+
+/**
+ * Seed of the device, and whether its PIN is validated.
+ */
+void shim_set_seed(const uint8_t *seed, size_t seed_len);
+void shim_set_pin_validated(bool validated);
+
+/**
+ * Number of derivations from the seed since the last call.
+ */
+unsigned int shim_take_seed_derivations(void);
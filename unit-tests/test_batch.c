@@ -0,0 +1,158 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <cmocka.h>
+
+#include "transaction/batch.h"
+#include "transaction/types.h"
+
+// 1.5 KAIA in its smallest unit, a 25 gkei gas price, a 21000 gas limit and the chain ID 8217
+static const uint8_t VALUE[] = {0x14, 0xd1, 0x12, 0x0d, 0x7b, 0x16, 0x00, 0x00};
+static const uint8_t GAS_PRICE[] = {0x05, 0xd2, 0x1d, 0xba, 0x00};
+static const uint8_t GAS_LIMIT[] = {0x52, 0x08};
+static const uint8_t CHAIN_ID[] = {0x20, 0x19};
+static const uint8_t TESTNET_CHAIN_ID[] = {0x03, 0xe9};
+static const uint8_t NONCE[] = {0x01, 0x02};
+static const uint8_t LONG_NONCE[] = {0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+static const uint8_t MAX_VALUE[MAX_INT256] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
+
+#define VIEW(bytes) ((uint256_view_t){.value = bytes, .length = sizeof(bytes)})
+
+static transaction_t transfer(uint8_t recipient) {
+    transaction_t tx;
+
+    memset(&tx, 0, sizeof(tx));
+    tx.txType = EIP1559;
+    tx.nonce = VIEW(NONCE);
+    tx.gasprice = VIEW(GAS_PRICE);
+    tx.startgas = VIEW(GAS_LIMIT);
+    tx.value = VIEW(VALUE);
+    tx.chainID = VIEW(CHAIN_ID);
+    memset(tx.to, recipient, sizeof(tx.to));
+    tx.toLength = ADDRESS_LEN;
+    return tx;
+}
+
+static void test_batch_init(void **state) {
+    (void) state;
+    batch_ctx_t batch;
+
+    assert_false(batch_init(&batch, 0));
+    assert_false(batch_init(&batch, MAX_BATCH_TXS + 1));
+    assert_true(batch_init(&batch, MAX_BATCH_TXS));
+    assert_int_equal(batch.count, MAX_BATCH_TXS);
+    assert_int_equal(batch.received, 0);
+    assert_int_equal(batch_recipients(&batch), 0);
+}
+
+static void test_batch_totals(void **state) {
+    (void) state;
+    batch_ctx_t batch;
+    uint8_t hash[BATCH_HASH_LEN];
+    uint8_t bytes[MAX_INT256];
+    u256_t expected;
+    u256_t operand;
+    transaction_t tx;
+
+    assert_true(batch_init(&batch, 3));
+    for (uint8_t i = 0; i < 3; i++) {
+        // Two transactions to the same recipient
+        tx = transfer(i == 2 ? 0x22 : 0x11);
+        memset(hash, i, sizeof(hash));
+        assert_true(batch_add(&batch, &tx, hash));
+        assert_memory_equal(batch.entries[i].hash, hash, sizeof(hash));
+        assert_memory_equal(batch.entries[i].to, tx.to, ADDRESS_LEN);
+        assert_int_equal(batch.entries[i].nonce, 0x0102);
+    }
+    assert_int_equal(batch.received, 3);
+    assert_int_equal(batch_recipients(&batch), 2);
+
+    // The batch is complete
+    assert_false(batch_add(&batch, &tx, hash));
+
+    // Values are kept on 32 bytes, big endian
+    memset(bytes, 0, sizeof(bytes));
+    memcpy(bytes + sizeof(bytes) - sizeof(VALUE), VALUE, sizeof(VALUE));
+    assert_memory_equal(batch.entries[0].value, bytes, sizeof(bytes));
+
+    // 3 times the value, 3 times the gas price times the gas limit
+    tx = transfer(0x11);
+    assert_true(u256_from_view(&expected, &tx.value));
+    assert_true(u256_add(&expected, &expected, &expected));
+    assert_true(u256_from_view(&operand, &tx.value));
+    assert_true(u256_add(&expected, &expected, &operand));
+    assert_int_equal(u256_cmp(&batch.totalValue, &expected), 0);
+    assert_true(u256_from_view(&expected, &tx.gasprice));
+    assert_true(u256_from_view(&operand, &tx.startgas));
+    assert_true(u256_mul(&expected, &expected, &operand));
+    u256_t three = {.limbs = {3}};
+    assert_true(u256_mul(&expected, &expected, &three));
+    assert_int_equal(u256_cmp(&batch.totalFee, &expected), 0);
+}
+
+static void test_batch_refused(void **state) {
+    (void) state;
+    batch_ctx_t batch;
+    uint8_t hash[BATCH_HASH_LEN] = {0};
+    transaction_t tx;
+
+    assert_true(batch_init(&batch, MAX_BATCH_TXS));
+    tx = transfer(0x11);
+    assert_true(batch_add(&batch, &tx, hash));
+
+    // Another type or chain ID than the first transaction
+    tx = transfer(0x11);
+    tx.txType = LEGACY;
+    assert_false(batch_add(&batch, &tx, hash));
+    tx = transfer(0x11);
+    tx.chainID = VIEW(TESTNET_CHAIN_ID);
+    assert_false(batch_add(&batch, &tx, hash));
+
+    // Anything but a plain value transfer
+    tx = transfer(0x11);
+    tx.dataSize = 4;
+    assert_false(batch_add(&batch, &tx, hash));
+    tx = transfer(0x11);
+    tx.accessListCount = 1;
+    assert_false(batch_add(&batch, &tx, hash));
+    tx = transfer(0x00);
+    assert_false(batch_add(&batch, &tx, hash));
+    tx = transfer(0x11);
+    tx.toLength = 0;
+    assert_false(batch_add(&batch, &tx, hash));
+    tx = transfer(0x11);
+    tx.feePayerSignature = true;
+    assert_false(batch_add(&batch, &tx, hash));
+    tx = transfer(0x11);
+    tx.nonce = VIEW(LONG_NONCE);
+    assert_false(batch_add(&batch, &tx, hash));
+
+    // Totals overflowing 256 bits
+    tx = transfer(0x11);
+    tx.value = VIEW(MAX_VALUE);
+    assert_false(batch_add(&batch, &tx, hash));
+
+    assert_int_equal(batch.received, 1);
+
+    // Kaia transactions other than value transfers are refused from the first one
+    assert_true(batch_init(&batch, 1));
+    tx = transfer(0x11);
+    tx.txType = SMART_CONTRACT_EXECUTION;
+    assert_false(batch_add(&batch, &tx, hash));
+    tx.txType = VALUE_TRANSFER;
+    assert_true(batch_add(&batch, &tx, hash));
+}
+
+int main() {
+    const struct CMUnitTest tests[] = {cmocka_unit_test(test_batch_init),
+                                       cmocka_unit_test(test_batch_totals),
+                                       cmocka_unit_test(test_batch_refused)};
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
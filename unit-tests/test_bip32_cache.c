@@ -0,0 +1,374 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <cmocka.h>
+
+#define OPENSSL_SUPPRESS_DEPRECATED  // EC_KEY, for ECDSA_do_verify()
+
+#include <openssl/bn.h>
+#include <openssl/ec.h>
+#include <openssl/ecdsa.h>
+#include <openssl/evp.h>
+#include <openssl/obj_mac.h>
+
+#include "base58.h"
+#include "cx.h"
+#include "os.h"
+#include "crypto_helpers.h"
+#include "helper/bip32_cache.h"
+
+#define H 0x80000000
+
+// Serialized extended key: version, depth, parent fingerprint, child number, chain code, key
+#define XKEY_LEN             78
+#define XKEY_DEPTH           4
+#define XKEY_FINGERPRINT     5
+#define XKEY_CHILD_NUMBER    9
+#define XKEY_CHAIN_CODE      13
+#define XKEY_KEY             45
+#define BASE58_CHECKSUM_LEN  4
+
+typedef struct {
+    uint32_t path[5];
+    size_t path_len;
+    const char *xpub;
+    const char *xprv;
+} bip32_vector_t;
+
+// BIP32 test vector 1
+static const uint8_t SEED_1[] = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+                                 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f};
+
+static const bip32_vector_t VECTORS_1[] = {
+    {{0},
+     0,
+     "xpub661MyMwAqRbcFtXgS5sYJABqqG9YLmC4Q1Rdap9gSE8NqtwybGh"
+     "ePY2gZ29ESFjqJoCu1Rupje8YtGqsefD265TMg7usUDFdp6W1EGMcet8",
+     "xprv9s21ZrQH143K3QTDL4LXw2F7HEK3wJUD2nW2nRk4stbPy6cq3jP"
+     "PqjiChkVvvNKmPGJxWUtg6LnF5kejMRNNU3TGtRBeJgk33yuGBxrMPHi"},
+    {{H | 0},
+     1,
+     "xpub68Gmy5EdvgibQVfPdqkBBCHxA5htiqg55crXYuXoQRKfDBFA1WE"
+     "jWgP6LHhwBZeNK1VTsfTFUHCdrfp1bgwQ9xv5ski8PX9rL2dZXvgGDnw",
+     "xprv9uHRZZhk6KAJC1avXpDAp4MDc3sQKNxDiPvvkX8Br5ngLNv1Txv"
+     "Uxt4cV1rGL5hj6KCesnDYUhd7oWgT11eZG7XnxHrnYeSvkzY7d2bhkJ7"},
+    {{H | 0, 1},
+     2,
+     "xpub6ASuArnXKPbfEwhqN6e3mwBcDTgzisQN1wXN9BJcM47sSikHjJf"
+     "3UFHKkNAWbWMiGj7Wf5uMash7SyYq527Hqck2AxYysAA7xmALppuCkwQ",
+     "xprv9wTYmMFdV23N2TdNG573QoEsfRrWKQgWeibmLntzniatZvR9BmL"
+     "nvSxqu53Kw1UmYPxLgboyZQaXwTCg8MSY3H2EU4pWcQDnRnrVA1xe8fs"},
+    {{H | 0, 1, H | 2},
+     3,
+     "xpub6D4BDPcP2GT577Vvch3R8wDkScZWzQzMMUm3PWbmWvVJrZwQY4V"
+     "UNgqFJPMM3No2dFDFGTsxxpG5uJh7n7epu4trkrX7x7DogT5Uv6fcLW5",
+     "xprv9z4pot5VBttmtdRTWfWQmoH1taj2axGVzFqSb8C9xaxKymcFzXB"
+     "DptWmT7FwuEzG3ryjH4ktypQSAewRiNMjANTtpgP4mLTj34bhnZX7UiM"},
+    {{H | 0, 1, H | 2, 2},
+     4,
+     "xpub6FHa3pjLCk84BayeJxFW2SP4XRrFd1JYnxeLeU8EqN3vDfZmbqB"
+     "qaGJAyiLjTAwm6ZLRQUMv1ZACTj37sR62cfN7fe5JnJ7dh8zL4fiyLHV",
+     "xprvA2JDeKCSNNZky6uBCviVfJSKyQ1mDYahRjijr5idH2WwLsEd4Hs"
+     "b2Tyh8RfQMuPh7f7RtyzTtdrbdqqsunu5Mm3wDvUAKRHSC34sJ7in334"},
+    {{H | 0, 1, H | 2, 2, 1000000000},
+     5,
+     "xpub6H1LXWLaKsWFhvm6RVpEL9P4KfRZSW7abD2ttkWP3SSQvnyA8FS"
+     "VqNTEcYFgJS2UaFcxupHiYkro49S8yGasTvXEYBVPamhGW6cFJodrTHy",
+     "xprvA41z7zogVVwxVSgdKUHDy1SKmdb533PjDz7J6N6mV6uS3ze1ai8"
+     "FHa8kmHScGpWmj4WggLyQjgPie1rFSruoUihUZREPSL39UNdE3BBDu76"},
+};
+
+// BIP32 test vector 2
+static const uint8_t SEED_2[] = {
+    0xff, 0xfc, 0xf9, 0xf6, 0xf3, 0xf0, 0xed, 0xea, 0xe7, 0xe4, 0xe1, 0xde, 0xdb,
+    0xd8, 0xd5, 0xd2, 0xcf, 0xcc, 0xc9, 0xc6, 0xc3, 0xc0, 0xbd, 0xba, 0xb7, 0xb4,
+    0xb1, 0xae, 0xab, 0xa8, 0xa5, 0xa2, 0x9f, 0x9c, 0x99, 0x96, 0x93, 0x90, 0x8d,
+    0x8a, 0x87, 0x84, 0x81, 0x7e, 0x7b, 0x78, 0x75, 0x72, 0x6f, 0x6c, 0x69, 0x66,
+    0x63, 0x60, 0x5d, 0x5a, 0x57, 0x54, 0x51, 0x4e, 0x4b, 0x48, 0x45, 0x42};
+
+static const bip32_vector_t VECTORS_2[] = {
+    {{0},
+     0,
+     "xpub661MyMwAqRbcFW31YEwpkMuc5THy2PSt5bDMsktWQcFF8syAmRU"
+     "apSCGu8ED9W6oDMSgv6Zz8idoc4a6mr8BDzTJY47LJhkJ8UB7WEGuduB",
+     "xprv9s21ZrQH143K31xYSDQpPDxsXRTUcvj2iNHm5NUtrGiGG5e2DtA"
+     "LGdso3pGz6ssrdK4PFmM8NSpSBHNqPqm55Qn3LqFtT2emdEXVYsCzC2U"},
+    {{0},
+     1,
+     "xpub69H7F5d8KSRgmmdJg2KhpAK8SR3DjMwAdkxj3ZuxV27CprR9Lgp"
+     "eyGmXUbC6wb7ERfvrnKZjXoUmmDznezpbZb7ap6r1D3tgFxHmwMkQTPH",
+     "xprv9vHkqa6EV4sPZHYqZznhT2NPtPCjKuDKGY38FBWLvgaDx45zo9W"
+     "QRUT3dKYnjwih2yJD9mkrocEZXo1ex8G81dwSM1fwqWpWkeS3v86pgKt"},
+    {{0, H | 2147483647},
+     2,
+     "xpub6ASAVgeehLbnwdqV6UKMHVzgqAG8Gr6riv3Fxxpj8ksbH9ebxaE"
+     "yBLZ85ySDhKiLDBrQSARLq1uNRts8RuJiHjaDMBU4Zn9h8LZNnBC5y4a",
+     "xprv9wSp6B7kry3Vj9m1zSnLvN3xH8RdsPP1Mh7fAaR7aRLcQMKTR2v"
+     "idYEeEg2mUCTAwCd6vnxVrcjfy2kRgVsFawNzmjuHc2YmYRmagcEPdU9"},
+    {{0, H | 2147483647, 1},
+     3,
+     "xpub6DF8uhdarytz3FWdA8TvFSvvAh8dP3283MY7p2V4SeE2wyWmG5m"
+     "g5EwVvmdMVCQcoNJxGoWaU9DCWh89LojfZ537wTfunKau47EL2dhHKon",
+     "xprv9zFnWC6h2cLgpmSA46vutJzBcfJ8yaJGg8cX1e5StJh45BBciYT"
+     "RXSd25UEPVuesF9yog62tGAQtHjXajPPdbRCHuWS6T8XA2ECKADdw4Ef"},
+    {{0, H | 2147483647, 1, H | 2147483646},
+     4,
+     "xpub6ERApfZwUNrhLCkDtcHTcxd75RbzS1ed54G1LkBUHQVHQKqhMkh"
+     "gbmJbZRkrgZw4koxb5JaHWkY4ALHY2grBGRjaDMzQLcgJvLJuZZvRcEL",
+     "xprvA1RpRA33e1JQ7ifknakTFpgNXPmW2YvmhqLQYMmrj4xJXXWYpDP"
+     "S3xz7iAxn8L39njGVyuoseXzU6rcxFLJ8HFsTjSyQbLYnMpCqE2VbFWc"},
+    {{0, H | 2147483647, 1, H | 2147483646, 2},
+     5,
+     "xpub6FnCn6nSzZAw5Tw7cgR9bi15UV96gLZhjDstkXXxvCLsUXBGXPd"
+     "SnLFbdpq8p9HmGsApME5hQTZ3emM2rnY5agb9rXpVGyy3bdW6EEgAtqt",
+     "xprvA2nrNbFZABcdryreWet9Ea4LvTJcGsqrMzxHx98MMrotbir7yrK"
+     "CEXw7nadnHM8Dq38EGfSh6dqA9QWTyefMLEcBYJUuekgW4BYPJcr9E7j"},
+};
+
+static const uint8_t HASH[32] = {0x4b, 0x61, 0x69, 0x61};
+
+// Decode a base58check extended key, without its checksum
+static void decode_xkey(const char *encoded, uint8_t out[static XKEY_LEN]) {
+    uint8_t decoded[XKEY_LEN + BASE58_CHECKSUM_LEN];
+    uint8_t checksum[32];
+
+    assert_int_equal(base58_decode(encoded, strlen(encoded), decoded, sizeof(decoded)),
+                     sizeof(decoded));
+    assert_int_equal(EVP_Digest(decoded, XKEY_LEN, checksum, NULL, EVP_sha256(), NULL), 1);
+    assert_int_equal(EVP_Digest(checksum, sizeof(checksum), checksum, NULL, EVP_sha256(), NULL),
+                     1);
+    assert_memory_equal(decoded + XKEY_LEN, checksum, BASE58_CHECKSUM_LEN);
+    memcpy(out, decoded, XKEY_LEN);
+}
+
+// First bytes of the HASH160 of a compressed public key
+static void fingerprint(const uint8_t public_key[static COMPRESSED_PUBKEY_LEN], uint8_t out[4]) {
+    uint8_t sha256[32];
+    uint8_t hash160[20];
+
+    assert_int_equal(
+        EVP_Digest(public_key, COMPRESSED_PUBKEY_LEN, sha256, NULL, EVP_sha256(), NULL),
+        1);
+    assert_int_equal(EVP_Digest(sha256, sizeof(sha256), hash160, NULL, EVP_ripemd160(), NULL), 1);
+    memcpy(out, hash160, 4);
+}
+
+// Verify a signature with an uncompressed public key
+static bool verify(const uint8_t raw_public_key[static 65],
+                   const uint8_t r[static BIP32_KEY_LEN],
+                   const uint8_t s[static BIP32_KEY_LEN]) {
+    EC_KEY *key = EC_KEY_new_by_curve_name(NID_secp256k1);
+    EC_POINT *point = EC_POINT_new(EC_KEY_get0_group(key));
+    ECDSA_SIG *signature = ECDSA_SIG_new();
+    bool ok = EC_POINT_oct2point(EC_KEY_get0_group(key), point, raw_public_key, 65, NULL) == 1 &&
+              EC_KEY_set_public_key(key, point) == 1 &&
+              ECDSA_SIG_set0(signature,
+                             BN_bin2bn(r, BIP32_KEY_LEN, NULL),
+                             BN_bin2bn(s, BIP32_KEY_LEN, NULL)) == 1 &&
+              ECDSA_do_verify(HASH, sizeof(HASH), signature, key) == 1;
+
+    ECDSA_SIG_free(signature);
+    EC_POINT_free(point);
+    EC_KEY_free(key);
+    return ok;
+}
+
+// Check the cached derivation of a path against its serialized extended keys
+static void check_vector(const bip32_vector_t *vector) {
+    uint8_t xpub[XKEY_LEN];
+    uint8_t xprv[XKEY_LEN];
+    uint8_t raw_public_key[65];
+    uint8_t public_key[COMPRESSED_PUBKEY_LEN];
+    uint8_t chain_code[BIP32_KEY_LEN];
+    uint8_t parent_fingerprint[4] = {0};
+    uint8_t child_number[4] = {0};
+    uint8_t r[BIP32_KEY_LEN];
+    uint8_t s[BIP32_KEY_LEN];
+    uint32_t info;
+    cx_ecfp_private_key_t private_key;
+    cx_ecfp_public_key_t xprv_public_key;
+
+    decode_xkey(vector->xpub, xpub);
+    decode_xkey(vector->xprv, xprv);
+
+    assert_int_equal(
+        bip32_cache_get_pubkey(vector->path, vector->path_len, raw_public_key, chain_code),
+        CX_OK);
+    compress_public_key(raw_public_key, public_key);
+    if (vector->path_len > 0) {
+        uint8_t parent_key[65];
+        uint8_t parent_public_key[COMPRESSED_PUBKEY_LEN];
+
+        assert_int_equal(
+            bip32_cache_get_pubkey(vector->path, vector->path_len - 1, parent_key, NULL),
+            CX_OK);
+        compress_public_key(parent_key, parent_public_key);
+        fingerprint(parent_public_key, parent_fingerprint);
+        U4BE_ENCODE(child_number, 0, vector->path[vector->path_len - 1]);
+    }
+
+    // xpub: depth, parent, child number, chain code and public key
+    assert_int_equal(xpub[XKEY_DEPTH], vector->path_len);
+    assert_memory_equal(xpub + XKEY_FINGERPRINT, parent_fingerprint, 4);
+    assert_memory_equal(xpub + XKEY_CHILD_NUMBER, child_number, 4);
+    assert_memory_equal(xpub + XKEY_CHAIN_CODE, chain_code, BIP32_KEY_LEN);
+    assert_memory_equal(xpub + XKEY_KEY, public_key, COMPRESSED_PUBKEY_LEN);
+
+    // xprv: same node, its private key is the one of the derived public key
+    assert_memory_equal(xprv + XKEY_DEPTH, xpub + XKEY_DEPTH, XKEY_KEY - XKEY_DEPTH);
+    assert_int_equal(xprv[XKEY_KEY], 0);
+    assert_int_equal(cx_ecfp_init_private_key_no_throw(CX_CURVE_256K1,
+                                                       xprv + XKEY_KEY + 1,
+                                                       BIP32_KEY_LEN,
+                                                       &private_key),
+                     CX_OK);
+    assert_int_equal(
+        cx_ecfp_generate_pair_no_throw(CX_CURVE_256K1, &xprv_public_key, &private_key, true),
+        CX_OK);
+    assert_memory_equal(xprv_public_key.W, raw_public_key, sizeof(raw_public_key));
+
+    // The signing key is the same as well
+    assert_int_equal(bip32_cache_sign_hash(vector->path,
+                                           vector->path_len,
+                                           HASH,
+                                           sizeof(HASH),
+                                           r,
+                                           s,
+                                           &info),
+                     CX_OK);
+    assert_true(verify(raw_public_key, r, s));
+}
+
+static void test_bip32_vector_1(void **state) {
+    (void) state;
+
+    bip32_cache_wipe();
+    shim_set_seed(SEED_1, sizeof(SEED_1));
+    for (size_t i = 0; i < sizeof(VECTORS_1) / sizeof(VECTORS_1[0]); i++) {
+        check_vector(&VECTORS_1[i]);
+    }
+    // And from the deepest node back to the master one
+    for (size_t i = sizeof(VECTORS_1) / sizeof(VECTORS_1[0]); i > 0; i--) {
+        check_vector(&VECTORS_1[i - 1]);
+    }
+}
+
+static void test_bip32_vector_2(void **state) {
+    (void) state;
+
+    bip32_cache_wipe();
+    shim_set_seed(SEED_2, sizeof(SEED_2));
+    for (size_t i = 0; i < sizeof(VECTORS_2) / sizeof(VECTORS_2[0]); i++) {
+        check_vector(&VECTORS_2[i]);
+    }
+    for (size_t i = sizeof(VECTORS_2) / sizeof(VECTORS_2[0]); i > 0; i--) {
+        check_vector(&VECTORS_2[i - 1]);
+    }
+}
+
+// Check the cached derivation of a path against the derivation of every step from the seed
+static void check_path(const uint32_t *path, size_t path_len) {
+    uint8_t raw_public_key[65];
+    uint8_t chain_code[BIP32_KEY_LEN];
+    uint8_t ref_public_key[65];
+    uint8_t ref_chain_code[BIP32_KEY_LEN];
+    uint8_t r[BIP32_KEY_LEN];
+    uint8_t s[BIP32_KEY_LEN];
+    uint32_t info;
+
+    assert_int_equal(bip32_derive_with_seed_get_pubkey_256(HDW_NORMAL,
+                                                           CX_CURVE_256K1,
+                                                           path,
+                                                           path_len,
+                                                           ref_public_key,
+                                                           ref_chain_code,
+                                                           CX_SHA512,
+                                                           NULL,
+                                                           0),
+                     CX_OK);
+    assert_int_equal(bip32_cache_get_pubkey(path, path_len, raw_public_key, chain_code), CX_OK);
+    assert_memory_equal(raw_public_key, ref_public_key, sizeof(ref_public_key));
+    assert_memory_equal(chain_code, ref_chain_code, sizeof(ref_chain_code));
+
+    assert_int_equal(bip32_cache_sign_hash(path, path_len, HASH, sizeof(HASH), r, s, &info),
+                     CX_OK);
+    assert_true(verify(ref_public_key, r, s));
+}
+
+static void test_bip32_app_paths(void **state) {
+    (void) state;
+
+    bip32_cache_wipe();
+    shim_set_seed(SEED_2, sizeof(SEED_2));
+    shim_take_seed_derivations();
+
+    // Addresses of the first accounts, as listed for account discovery
+    for (uint32_t account = 0; account < 3; account++) {
+        for (uint32_t index = 0; index < 20; index++) {
+            const uint32_t path[] = {H | 44, H | 60, H | account, 0, index};
+            check_path(path, 5);
+            // Only the first address of an account is derived from the seed
+            assert_int_equal(shim_take_seed_derivations(), index == 0 ? 1 : 0);
+        }
+    }
+
+    // Extended public key of an account and its parent, change addresses and legacy paths,
+    // interleaved so that the cached nodes are replaced
+    const uint32_t paths[][5] = {{H | 44, H | 60, H | 0},
+                                 {H | 44, H | 60},
+                                 {H | 44, H | 60, H | 0, 1, 3},
+                                 {H | 44, H | 60, H | 0, 0, 3},
+                                 {H | 44, H | 60, H | 0, 7},
+                                 {H | 44, H | 60, H | 5, 0, 0},
+                                 {H | 44, H | 60, H | 0, 0, 4},
+                                 {H | 44, H | 60, H | 0, 0},
+                                 {H | 44, H | 60, H | 0, 0, 0x7fffffff},
+                                 {H | 44, H | 60, 0, 0, 0}};
+    const size_t lengths[] = {3, 2, 5, 5, 4, 5, 5, 4, 5, 5};
+    for (size_t i = 0; i < sizeof(paths) / sizeof(paths[0]); i++) {
+        check_path(paths[i], lengths[i]);
+    }
+}
+
+static void test_bip32_pin_lock(void **state) {
+    (void) state;
+
+    const uint32_t path[] = {H | 44, H | 60, H | 0, 0, 0};
+    const uint32_t next_path[] = {H | 44, H | 60, H | 0, 0, 1};
+    uint8_t raw_public_key[65];
+    uint8_t r[BIP32_KEY_LEN];
+    uint8_t s[BIP32_KEY_LEN];
+    uint32_t info;
+
+    bip32_cache_wipe();
+    shim_set_seed(SEED_2, sizeof(SEED_2));
+    check_path(path, 5);
+    shim_take_seed_derivations();
+
+    // Nothing is derived while the device is locked, the cached nodes are wiped
+    shim_set_pin_validated(false);
+    assert_int_not_equal(bip32_cache_get_pubkey(next_path, 5, raw_public_key, NULL), CX_OK);
+    assert_int_not_equal(bip32_cache_sign_hash(next_path, 5, HASH, sizeof(HASH), r, s, &info),
+                         CX_OK);
+    shim_set_pin_validated(true);
+    check_path(next_path, 5);
+    assert_int_equal(shim_take_seed_derivations(), 1);
+
+    // As on app exit
+    bip32_cache_wipe();
+    check_path(path, 5);
+    assert_int_equal(shim_take_seed_derivations(), 1);
+}
+
+int main() {
+    const struct CMUnitTest tests[] = {cmocka_unit_test(test_bip32_vector_1),
+                                       cmocka_unit_test(test_bip32_vector_2),
+                                       cmocka_unit_test(test_bip32_app_paths),
+                                       cmocka_unit_test(test_bip32_pin_lock)};
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -7,10 +7,15 @@
 
 #include <cmocka.h>
 
+#include "constants.h"
+#include "transaction/batch.h"
+#include "transaction/calldata.h"
+#include "transaction/data_hash.h"
 #include "transaction/deserialize.h"
-#include "transaction/process_txs.h"
 #include "transaction/process_rlp_fields.h"
-#include "types.h"
+#include "transaction/registry.h"
+#include "transaction/types.h"
+#include "transaction/utils.h"
 
 static void test_tx_deserialization(void **state) {
     (void) state;
@@ -53,10 +58,1061 @@ static void test_error_tx_deserialization(void **state) {
 
 }
 
+static void test_tx_deserialization_chunks(void **state) {
+    (void) state;
+
+    // Value transfer: rlp([rlp([type, nonce, gasPrice, gas, to, value, from]), chainId, 0, 0])
+    // clang-format off
+    uint8_t raw_tx[] = {
+        0xf8, 0x4e, 0xb8, 0x47, 0xf8, 0x45, 0x08, 0x82,
+        0x11, 0x5c, 0x85, 0x0b, 0xa4, 0x3b, 0x74, 0x00,
+        0x83, 0x04, 0x93, 0xe0, 0x94, 0x0e, 0xe5, 0x6b,
+        0x60, 0x4c, 0x86, 0x9e, 0x37, 0x92, 0xc9, 0x9e,
+        0x35, 0xc1, 0xc4, 0x24, 0xf8, 0x8f, 0x87, 0xdc,
+        0x8a, 0x8c, 0xa1, 0x8f, 0x07, 0xd7, 0x36, 0xb9,
+        0x0b, 0xe5, 0x50, 0x00, 0x00, 0x01, 0x94, 0x6e,
+        0x93, 0xa3, 0xac, 0xfb, 0xad, 0xf4, 0x57, 0xf2,
+        0x9f, 0xb0, 0xe5, 0x7f, 0xa4, 0x22, 0x74, 0x00,
+        0x4c, 0x32, 0xea, 0x82, 0x03, 0xe9, 0x80, 0x80
+    };
+    // clang-format on
+
+    // Any split, including inside the envelope, gives the same result as a single buffer
+    for (size_t split = 1; split < sizeof(raw_tx); split++) {
+        transaction_t tx;
+        parser_context_t parser_ctx;
+        memset(&tx, 0, sizeof(tx));
+        transaction_deserialize_init(&parser_ctx, &tx);
+
+        buffer_t first = {.ptr = raw_tx, .size = split, .offset = 0};
+        buffer_t last = {.ptr = raw_tx + split, .size = sizeof(raw_tx) - split, .offset = 0};
+
+        assert_int_equal(transaction_deserialize_chunk(&parser_ctx, &first, false),
+                         PARSING_PROCESSING);
+        assert_int_equal(transaction_deserialize_chunk(&parser_ctx, &last, true), PARSING_OK);
+        assert_int_equal(tx.txType, VALUE_TRANSFER);
+        assert_int_equal(tx.nonce.length, 2);
+        assert_int_equal(tx.value.length, 12);
+        assert_int_equal(tx.chainID.length, 2);
+        assert_memory_equal(tx.to, raw_tx + 21, ADDRESS_LEN);
+        // Integer fields are read in place from the retained buffer
+        assert_ptr_equal(tx.value.value, raw_tx + 42);
+
+        // Once complete, a late chunk is refused, even empty
+        buffer_t late = {.ptr = raw_tx, .size = 0, .offset = 0};
+        assert_true(parser_ctx.complete);
+        assert_int_equal(transaction_deserialize_chunk(&parser_ctx, &late, true), PARSING_ERROR);
+    }
+}
+
+static void test_tx_deserialization_staging(void **state) {
+    (void) state;
+
+    // Value transfer, as in test_tx_deserialization_chunks
+    // clang-format off
+    const uint8_t raw_tx[] = {
+        0xf8, 0x4e, 0xb8, 0x47, 0xf8, 0x45, 0x08, 0x82,
+        0x11, 0x5c, 0x85, 0x0b, 0xa4, 0x3b, 0x74, 0x00,
+        0x83, 0x04, 0x93, 0xe0, 0x94, 0x0e, 0xe5, 0x6b,
+        0x60, 0x4c, 0x86, 0x9e, 0x37, 0x92, 0xc9, 0x9e,
+        0x35, 0xc1, 0xc4, 0x24, 0xf8, 0x8f, 0x87, 0xdc,
+        0x8a, 0x8c, 0xa1, 0x8f, 0x07, 0xd7, 0x36, 0xb9,
+        0x0b, 0xe5, 0x50, 0x00, 0x00, 0x01, 0x94, 0x6e,
+        0x93, 0xa3, 0xac, 0xfb, 0xad, 0xf4, 0x57, 0xf2,
+        0x9f, 0xb0, 0xe5, 0x7f, 0xa4, 0x22, 0x74, 0x00,
+        0x4c, 0x32, 0xea, 0x82, 0x03, 0xe9, 0x80, 0x80
+    };
+    // clang-format on
+
+    // Each chunk is wiped once parsed, the fields are read from the staging storage
+    for (size_t split = 1; split < sizeof(raw_tx); split++) {
+        transaction_t tx;
+        parser_context_t parser_ctx;
+        uint8_t staging[TX_STAGING_LEN];
+        uint8_t chunk[sizeof(raw_tx)];
+        memset(&tx, 0, sizeof(tx));
+        transaction_deserialize_init(&parser_ctx, &tx);
+        transaction_deserialize_set_staging(&parser_ctx, staging, sizeof(staging));
+
+        memcpy(chunk, raw_tx, split);
+        buffer_t first = {.ptr = chunk, .size = split, .offset = 0};
+        assert_int_equal(transaction_deserialize_chunk(&parser_ctx, &first, false),
+                         PARSING_PROCESSING);
+        memset(chunk, 0xff, sizeof(chunk));
+
+        memcpy(chunk, raw_tx + split, sizeof(raw_tx) - split);
+        buffer_t last = {.ptr = chunk, .size = sizeof(raw_tx) - split, .offset = 0};
+        assert_int_equal(transaction_deserialize_chunk(&parser_ctx, &last, true), PARSING_OK);
+        memset(chunk, 0xff, sizeof(chunk));
+
+        assert_int_equal(tx.nonce.length, 2);
+        assert_memory_equal(tx.nonce.value, raw_tx + 8, 2);
+        assert_int_equal(tx.gasprice.length, 5);
+        assert_memory_equal(tx.gasprice.value, raw_tx + 11, 5);
+        assert_int_equal(tx.startgas.length, 3);
+        assert_memory_equal(tx.startgas.value, raw_tx + 17, 3);
+        assert_int_equal(tx.value.length, 12);
+        assert_memory_equal(tx.value.value, raw_tx + 42, 12);
+        assert_int_equal(tx.chainID.length, 2);
+        assert_memory_equal(tx.chainID.value, raw_tx + 76, 2);
+    }
+
+    // The staging storage is bounded
+    transaction_t tx;
+    parser_context_t parser_ctx;
+    uint8_t staging[4];
+    transaction_deserialize_init(&parser_ctx, &tx);
+    transaction_deserialize_set_staging(&parser_ctx, staging, sizeof(staging));
+    buffer_t buf = {.ptr = raw_tx, .size = sizeof(raw_tx), .offset = 0};
+    assert_int_equal(transaction_deserialize_chunk(&parser_ctx, &buf, true), PARSING_ERROR);
+}
+
+static void test_error_tx_deserialization_chunks(void **state) {
+    (void) state;
+
+    transaction_t tx;
+    parser_context_t parser_ctx;
+    // Cancel transaction with a list instead of the nonce string
+    // clang-format off
+    uint8_t raw_tx[] = {
+        0xe8, 0xa2, 0xe1, 0x38, 0xc1, 0x19, 0x85, 0x0b,
+        0xa4, 0x3b, 0x74, 0x00, 0x83, 0x04, 0x93, 0xe0
+    };
+    // clang-format on
+
+    memset(&tx, 0, sizeof(tx));
+    transaction_deserialize_init(&parser_ctx, &tx);
+    buffer_t buf = {.ptr = raw_tx, .size = sizeof(raw_tx), .offset = 0};
+
+    // Rejected on the chunk containing the faulty field, not on the last one
+    assert_int_equal(transaction_deserialize_chunk(&parser_ctx, &buf, false), PARSING_ERROR);
+
+    // A truncated transaction is rejected on the last chunk
+    memset(&tx, 0, sizeof(tx));
+    transaction_deserialize_init(&parser_ctx, &tx);
+    raw_tx[4] = 0x19;
+    buf.offset = 0;
+    buf.size = 5;
+    assert_int_equal(transaction_deserialize_chunk(&parser_ctx, &buf, true), PARSING_ERROR);
+}
+
+static void test_tx_envelope(void **state) {
+    (void) state;
+
+    transaction_t tx;
+    // Legacy transaction with a multi-byte nonce (0x115c)
+    // clang-format off
+    uint8_t legacy_tx[] = {
+        0xe9, 0x82, 0x11, 0x5c, 0x85, 0x0b, 0xa4, 0x3b,
+        0x74, 0x00, 0x83, 0x04, 0x93, 0xe0, 0x94, 0x0e,
+        0xe5, 0x6b, 0x60, 0x4c, 0x86, 0x9e, 0x37, 0x92,
+        0xc9, 0x9e, 0x35, 0xc1, 0xc4, 0x24, 0xf8, 0x8f,
+        0x87, 0xdc, 0x8a, 0x01, 0x80, 0x82, 0x03, 0xe9,
+        0x80, 0x80
+    };
+    // clang-format on
+    buffer_t buf = {.ptr = legacy_tx, .size = sizeof(legacy_tx), .offset = 0};
+    assert_int_equal(transaction_deserialize(&buf, &tx), PARSING_OK);
+    assert_int_equal(tx.txType, LEGACY);
+    assert_int_equal(tx.nonce.length, 2);
+    assert_ptr_equal(tx.nonce.value, legacy_tx + 2);
+
+    // Kaia transaction whose encoded payload does not start with a list
+    uint8_t not_a_list[] = {0xcd, 0x8a, 0x08, 0x01, 0x01, 0x01, 0x01,
+                            0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x80};
+    buf = (buffer_t){.ptr = not_a_list, .size = sizeof(not_a_list), .offset = 0};
+    assert_int_equal(transaction_deserialize(&buf, &tx), PARSING_ERROR);
+
+    // Inner list longer than the encoded payload
+    uint8_t too_long[] = {0xcd, 0x8a, 0xca, 0x08, 0x01, 0x01, 0x01,
+                          0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x80};
+    buf = (buffer_t){.ptr = too_long, .size = sizeof(too_long), .offset = 0};
+    assert_int_equal(transaction_deserialize(&buf, &tx), PARSING_ERROR);
+
+    // Unsupported type
+    too_long[2] = 0xc9;
+    too_long[3] = 0x07;
+    buf = (buffer_t){.ptr = too_long, .size = sizeof(too_long), .offset = 0};
+    assert_int_equal(transaction_deserialize(&buf, &tx), PARSING_ERROR);
+
+    // The envelope is not a list
+    buf = (buffer_t){.ptr = too_long + 1, .size = sizeof(too_long) - 1, .offset = 0};
+    assert_int_equal(transaction_deserialize(&buf, &tx), PARSING_ERROR);
+}
+
+static void test_rlp_header_split(void **state) {
+    (void) state;
+
+    // Long string header (0xb9, 2 length bytes) followed by its first payload byte
+    uint8_t raw[] = {0xb9, 0x01, 0x02, 0xaa};
+
+    // Decoded in place from a single chunk, or carried over whatever the split
+    for (size_t split = 0; split <= 3; split++) {
+        parser_context_t parser_ctx;
+        memset(&parser_ctx, 0, sizeof(parser_ctx));
+
+        parser_ctx.workBuffer = raw;
+        parser_ctx.commandLength = split;
+        if (split < 3) {
+            assert_int_equal(parseRLP(&parser_ctx), PARSING_PROCESSING);
+            assert_int_equal(parser_ctx.commandLength, 0);
+            parser_ctx.workBuffer = raw + split;
+            parser_ctx.commandLength = sizeof(raw) - split;
+        } else {
+            parser_ctx.commandLength = sizeof(raw);
+        }
+        assert_int_equal(parseRLP(&parser_ctx), PARSING_CONTINUE);
+        assert_int_equal(parser_ctx.currentFieldLength, 0x102);
+        assert_false(parser_ctx.currentFieldIsList);
+        assert_false(parser_ctx.fieldSingleByte);
+        assert_int_equal(parser_ctx.commandLength, 1);
+        assert_int_equal(*parser_ctx.workBuffer, 0xaa);
+        assert_int_equal(parser_ctx.rlpBufferPos, 0);
+    }
+
+    // A self encoded byte is left in the buffer as the field content
+    parser_context_t parser_ctx;
+    memset(&parser_ctx, 0, sizeof(parser_ctx));
+    parser_ctx.workBuffer = raw + 3;
+    parser_ctx.commandLength = 1;
+    raw[3] = 0x7f;
+    assert_int_equal(parseRLP(&parser_ctx), PARSING_CONTINUE);
+    assert_true(parser_ctx.fieldSingleByte);
+    assert_int_equal(parser_ctx.currentFieldLength, 1);
+    assert_int_equal(parser_ctx.commandLength, 1);
+
+    // Lengths above 32 bits are refused
+    raw[0] = 0xfc;
+    parser_ctx.workBuffer = raw;
+    parser_ctx.commandLength = sizeof(raw);
+    assert_int_equal(parseRLP(&parser_ctx), PARSING_ERROR);
+}
+
+static void test_tx_typed(void **state) {
+    (void) state;
+
+    // EIP-1559, chain 8217, nonce 7, priority fee 25 gkei, max fee 50 gkei, gas 21000,
+    // value 1 KAIA, access list with two entries
+    // clang-format off
+    const uint8_t eip1559_tx[] = {
+        0x02, 0xf8, 0x83, 0x82, 0x20, 0x19, 0x07, 0x85,
+        0x05, 0xd2, 0x1d, 0xba, 0x00, 0x85, 0x0b, 0xa4,
+        0x3b, 0x74, 0x00, 0x82, 0x52, 0x08, 0x94, 0x0e,
+        0xe5, 0x6b, 0x60, 0x4c, 0x86, 0x9e, 0x37, 0x92,
+        0xc9, 0x9e, 0x35, 0xc1, 0xc4, 0x24, 0xf8, 0x8f,
+        0x87, 0xdc, 0x8a, 0x88, 0x0d, 0xe0, 0xb6, 0xb3,
+        0xa7, 0x64, 0x00, 0x00, 0x80, 0xf8, 0x4f, 0xf7,
+        0x94, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+        0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+        0x11, 0x11, 0x11, 0x11, 0x11, 0xe1, 0xa0, 0x33,
+        0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33,
+        0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33,
+        0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33,
+        0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0xd6,
+        0x94, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22,
+        0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22,
+        0x22, 0x22, 0x22, 0x22, 0x22, 0xc0
+    };
+    // EIP-2930, chain 1001, nonce 0, gas price 25 gkei, gas 21000, value 1 peb, empty access list
+    const uint8_t eip2930_tx[] = {
+        0x01, 0xe5, 0x82, 0x03, 0xe9, 0x80, 0x85, 0x05,
+        0xd2, 0x1d, 0xba, 0x00, 0x82, 0x52, 0x08, 0x94,
+        0x0e, 0xe5, 0x6b, 0x60, 0x4c, 0x86, 0x9e, 0x37,
+        0x92, 0xc9, 0x9e, 0x35, 0xc1, 0xc4, 0x24, 0xf8,
+        0x8f, 0x87, 0xdc, 0x8a, 0x01, 0x80, 0xc0
+    };
+    // clang-format on
+    const uint8_t expected_to[ADDRESS_LEN] = {0x0e, 0xe5, 0x6b, 0x60, 0x4c, 0x86, 0x9e,
+                                              0x37, 0x92, 0xc9, 0x9e, 0x35, 0xc1, 0xc4,
+                                              0x24, 0xf8, 0x8f, 0x87, 0xdc, 0x8a};
+    transaction_t tx;
+    uint8_t tx_copy[sizeof(eip1559_tx)];
+
+    memset(&tx, 0, sizeof(tx));
+    buffer_t buf = {.ptr = eip2930_tx, .size = sizeof(eip2930_tx), .offset = 0};
+    assert_int_equal(transaction_deserialize(&buf, &tx), PARSING_OK);
+    assert_int_equal(tx.txType, EIP2930);
+    assert_int_equal(tx.chainID.length, 2);
+    assert_ptr_equal(tx.chainID.value, eip2930_tx + 3);
+    assert_int_equal(tx.nonce.length, 0);
+    assert_int_equal(tx.gasprice.length, 5);
+    assert_ptr_equal(tx.gasprice.value, eip2930_tx + 7);
+    assert_memory_equal(tx.to, expected_to, ADDRESS_LEN);
+    assert_int_equal(tx.value.length, 1);
+    assert_int_equal(tx.accessListCount, 0);
+
+    // Each chunk is wiped once parsed, the access list is counted as it is skipped
+    for (size_t split = 1; split < sizeof(eip1559_tx); split++) {
+        parser_context_t parser_ctx;
+        uint8_t staging[TX_STAGING_LEN];
+        uint8_t chunk[sizeof(eip1559_tx)];
+        memset(&tx, 0, sizeof(tx));
+        transaction_deserialize_init(&parser_ctx, &tx);
+        transaction_deserialize_set_staging(&parser_ctx, staging, sizeof(staging));
+
+        memcpy(chunk, eip1559_tx, split);
+        buffer_t first = {.ptr = chunk, .size = split, .offset = 0};
+        assert_int_equal(transaction_deserialize_chunk(&parser_ctx, &first, false),
+                         PARSING_PROCESSING);
+        memset(chunk, 0xff, sizeof(chunk));
+        // The chunks are retained until the access list is reached at offset 53
+        assert_int_equal(transaction_deserialize_retains_chunk(&parser_ctx, 1), split < 53);
+
+        memcpy(chunk, eip1559_tx + split, sizeof(eip1559_tx) - split);
+        buffer_t last = {.ptr = chunk, .size = sizeof(eip1559_tx) - split, .offset = 0};
+        assert_int_equal(transaction_deserialize_chunk(&parser_ctx, &last, true), PARSING_OK);
+        memset(chunk, 0xff, sizeof(chunk));
+
+        assert_int_equal(tx.txType, EIP1559);
+        assert_int_equal(tx.chainID.length, 2);
+        assert_memory_equal(tx.chainID.value, eip1559_tx + 4, 2);
+        assert_int_equal(tx.nonce.length, 1);
+        assert_memory_equal(tx.nonce.value, eip1559_tx + 6, 1);
+        assert_int_equal(tx.priorityFee.length, 5);
+        assert_memory_equal(tx.priorityFee.value, eip1559_tx + 8, 5);
+        assert_int_equal(tx.gasprice.length, 5);
+        assert_memory_equal(tx.gasprice.value, eip1559_tx + 14, 5);
+        assert_int_equal(tx.startgas.length, 2);
+        assert_memory_equal(tx.startgas.value, eip1559_tx + 20, 2);
+        assert_memory_equal(tx.to, expected_to, ADDRESS_LEN);
+        assert_int_equal(tx.value.length, 8);
+        assert_memory_equal(tx.value.value, eip1559_tx + 44, 8);
+        assert_int_equal(tx.accessListCount, 2);
+    }
+
+    // Access list entry that is not a list
+    memcpy(tx_copy, eip1559_tx, sizeof(tx_copy));
+    tx_copy[55] = 0xb7;
+    buf = (buffer_t){.ptr = tx_copy, .size = sizeof(tx_copy), .offset = 0};
+    assert_int_equal(transaction_deserialize(&buf, &tx), PARSING_ERROR);
+
+    // Access list entry overflowing the access list
+    memcpy(tx_copy, eip1559_tx, sizeof(tx_copy));
+    tx_copy[2] = 0x53;
+    tx_copy[54] = 0x1f;
+    buf = (buffer_t){.ptr = tx_copy, .size = 86, .offset = 0};
+    assert_int_equal(transaction_deserialize(&buf, &tx), PARSING_ERROR);
+
+    // Access list entry header crossing the end of the access list
+    memcpy(tx_copy, eip1559_tx, sizeof(tx_copy));
+    tx_copy[2] = 0x36;
+    tx_copy[54] = 0x01;
+    tx_copy[55] = 0xf8;
+    tx_copy[56] = 0x37;
+    buf = (buffer_t){.ptr = tx_copy, .size = 57, .offset = 0};
+    assert_int_equal(transaction_deserialize(&buf, &tx), PARSING_ERROR);
+
+    // Typed transaction without its list
+    buf = (buffer_t){.ptr = eip2930_tx, .size = 1, .offset = 0};
+    assert_int_equal(transaction_deserialize(&buf, &tx), PARSING_ERROR);
+
+    // Unknown EIP-2718 type
+    memcpy(tx_copy, eip2930_tx, sizeof(eip2930_tx));
+    tx_copy[0] = 0x03;
+    buf = (buffer_t){.ptr = tx_copy, .size = sizeof(eip2930_tx), .offset = 0};
+    assert_int_equal(transaction_deserialize(&buf, &tx), PARSING_ERROR);
+}
+
+static void test_tx_token_call(void **state) {
+    (void) state;
+
+    // Smart contract execution calling transfer(0x2222...2222, 10^18)
+    // clang-format off
+    const uint8_t raw_tx[] = {
+        0xf8, 0x86, 0xb8, 0x7f, 0xf8, 0x7d, 0x30, 0x07, 0x85, 0x05, 0xd2, 0x1d, 0xba, 0x00, 0x83,
+        0x01, 0x86, 0xa0, 0x94, 0x0e, 0xe5, 0x6b, 0x60, 0x4c, 0x86, 0x9e, 0x37, 0x92, 0xc9, 0x9e,
+        0x35, 0xc1, 0xc4, 0x24, 0xf8, 0x8f, 0x87, 0xdc, 0x8a, 0x80, 0x94, 0x11, 0x11, 0x11, 0x11,
+        0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+        0x11, 0xb8, 0x44, 0xa9, 0x05, 0x9c, 0xbb, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22,
+        0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x0d, 0xe0, 0xb6, 0xb3, 0xa7, 0x64, 0x00, 0x00, 0x82, 0x03, 0xe9, 0x80,
+        0x80
+    };
+    // clang-format on
+    const size_t calldata_offset = 63;
+    uint8_t expected_to[ADDRESS_LEN];
+    uint8_t expected_value[MAX_INT256] = {0};
+    uint8_t tx_copy[sizeof(raw_tx)];
+    transaction_t tx;
+
+    memset(expected_to, 0x22, sizeof(expected_to));
+    memcpy(expected_value + 24, raw_tx + calldata_offset + 60, 8);
+
+    memset(&tx, 0, sizeof(tx));
+    buffer_t buf = {.ptr = raw_tx, .size = sizeof(raw_tx), .offset = 0};
+    assert_int_equal(transaction_deserialize(&buf, &tx), PARSING_OK);
+    assert_int_equal(tx.txType, SMART_CONTRACT_EXECUTION);
+    assert_int_equal(tx.tokenCall, TOKEN_TRANSFER);
+    assert_memory_equal(tx.tokenTo, expected_to, ADDRESS_LEN);
+    assert_memory_equal(tx.tokenValue, expected_value, MAX_INT256);
+    assert_string_equal(calldata_method_name(tx.tokenCall), "transfer");
+
+    // The calldata is decoded as it streams, whatever the chunk boundaries
+    for (size_t split = 1; split < sizeof(raw_tx); split++) {
+        parser_context_t parser_ctx;
+        uint8_t staging[TX_STAGING_LEN];
+        uint8_t chunk[sizeof(raw_tx)];
+        memset(&tx, 0, sizeof(tx));
+        transaction_deserialize_init(&parser_ctx, &tx);
+        transaction_deserialize_set_staging(&parser_ctx, staging, sizeof(staging));
+
+        memcpy(chunk, raw_tx, split);
+        buffer_t first = {.ptr = chunk, .size = split, .offset = 0};
+        assert_int_equal(transaction_deserialize_chunk(&parser_ctx, &first, false),
+                         PARSING_PROCESSING);
+        memset(chunk, 0xff, sizeof(chunk));
+
+        memcpy(chunk, raw_tx + split, sizeof(raw_tx) - split);
+        buffer_t last = {.ptr = chunk, .size = sizeof(raw_tx) - split, .offset = 0};
+        assert_int_equal(transaction_deserialize_chunk(&parser_ctx, &last, true), PARSING_OK);
+
+        assert_int_equal(tx.tokenCall, TOKEN_TRANSFER);
+        assert_memory_equal(tx.tokenTo, expected_to, ADDRESS_LEN);
+        assert_memory_equal(tx.tokenValue, expected_value, MAX_INT256);
+    }
+
+    // Unknown selector, the transaction is still valid but not decoded
+    memcpy(tx_copy, raw_tx, sizeof(tx_copy));
+    tx_copy[calldata_offset + 3] = 0xbc;
+    buf = (buffer_t){.ptr = tx_copy, .size = sizeof(tx_copy), .offset = 0};
+    assert_int_equal(transaction_deserialize(&buf, &tx), PARSING_OK);
+    assert_int_equal(tx.tokenCall, TOKEN_CALL_NONE);
+
+    // Address argument that is not zero padded
+    memcpy(tx_copy, raw_tx, sizeof(tx_copy));
+    tx_copy[calldata_offset + 4] = 0x01;
+    buf = (buffer_t){.ptr = tx_copy, .size = sizeof(tx_copy), .offset = 0};
+    assert_int_equal(transaction_deserialize(&buf, &tx), PARSING_OK);
+    assert_int_equal(tx.tokenCall, TOKEN_CALL_NONE);
+
+    const uint32_t selectors[] = {0x095ea7b3,
+                                  0x23b872dd,
+                                  0x423f6cef,
+                                  0x42842e0e,
+                                  0xa9059cbb,
+                                  0xb88d4fde,
+                                  0xeb795549};
+    for (size_t i = 0; i < sizeof(selectors) / sizeof(selectors[0]); i++) {
+        assert_non_null(calldata_lookup(selectors[i]));
+        assert_int_equal(calldata_lookup(selectors[i])->selector, selectors[i]);
+    }
+    assert_null(calldata_lookup(0x00000000));
+    assert_null(calldata_lookup(0xa9059cbc));
+    assert_null(calldata_lookup(0xffffffff));
+
+    // Static calls must have their exact length, dynamic ones at least their static arguments
+    const uint8_t *calldata = raw_tx + calldata_offset;
+    const uint8_t dynamic_calldata[] = {0xeb, 0x79, 0x55, 0x49};
+    uint8_t words[5 * CALLDATA_WORD_LEN] = {0};
+    calldata_decoder_t decoder;
+
+    memset(&decoder, 0, sizeof(decoder));
+    calldata_feed(&decoder, &tx, calldata, 0x43);
+    calldata_finish(&decoder, &tx);
+    assert_int_equal(tx.tokenCall, TOKEN_CALL_NONE);
+
+    memset(&decoder, 0, sizeof(decoder));
+    calldata_feed(&decoder, &tx, calldata, 0x44);
+    calldata_feed(&decoder, &tx, words, 1);
+    calldata_finish(&decoder, &tx);
+    assert_int_equal(tx.tokenCall, TOKEN_CALL_NONE);
+
+    memset(&decoder, 0, sizeof(decoder));
+    calldata_feed(&decoder, &tx, calldata, 0x44);
+    calldata_finish(&decoder, &tx);
+    assert_int_equal(tx.tokenCall, TOKEN_TRANSFER);
+    assert_false(tx.tokenBytes);
+
+    // safeTransfer(to, amount, data): offset 0x60, then the length word and the padded content
+    words[3 * CALLDATA_WORD_LEN - 1] = 0x60;
+    words[4 * CALLDATA_WORD_LEN - 1] = 5;
+    memset(words + 4 * CALLDATA_WORD_LEN, 0xab, 5);
+
+    memset(&decoder, 0, sizeof(decoder));
+    calldata_feed(&decoder, &tx, dynamic_calldata, sizeof(dynamic_calldata));
+    calldata_feed(&decoder, &tx, words, sizeof(words));
+    calldata_finish(&decoder, &tx);
+    assert_int_equal(tx.tokenCall, TOKEN_SAFE_TRANSFER);
+    assert_true(tx.tokenBytes);
+
+    // The content is shorter or longer than its length
+    for (size_t size = 3 * CALLDATA_WORD_LEN; size < sizeof(words) + 2; size++) {
+        memset(&decoder, 0, sizeof(decoder));
+        calldata_feed(&decoder, &tx, dynamic_calldata, sizeof(dynamic_calldata));
+        calldata_feed(&decoder, &tx, words, size < sizeof(words) ? size : sizeof(words));
+        if (size > sizeof(words)) {
+            calldata_feed(&decoder, &tx, words, size - sizeof(words));
+        }
+        calldata_finish(&decoder, &tx);
+        assert_int_equal(tx.tokenCall,
+                         size == sizeof(words) ? TOKEN_SAFE_TRANSFER : TOKEN_CALL_NONE);
+    }
+
+    // Empty bytes data
+    memset(&decoder, 0, sizeof(decoder));
+    words[4 * CALLDATA_WORD_LEN - 1] = 0;
+    calldata_feed(&decoder, &tx, dynamic_calldata, sizeof(dynamic_calldata));
+    calldata_feed(&decoder, &tx, words, 4 * CALLDATA_WORD_LEN);
+    calldata_finish(&decoder, &tx);
+    assert_int_equal(tx.tokenCall, TOKEN_SAFE_TRANSFER);
+    words[4 * CALLDATA_WORD_LEN - 1] = 5;
+
+    // Offset not pointing right after the static arguments, or length too large
+    const size_t corrupted[] = {3 * CALLDATA_WORD_LEN - 1,
+                                3 * CALLDATA_WORD_LEN - 2,
+                                4 * CALLDATA_WORD_LEN - 5,
+                                3 * CALLDATA_WORD_LEN};
+    for (size_t i = 0; i < sizeof(corrupted) / sizeof(corrupted[0]); i++) {
+        uint8_t saved = words[corrupted[i]];
+        words[corrupted[i]] = i == 0 ? 0x80 : 0x01;
+        memset(&decoder, 0, sizeof(decoder));
+        calldata_feed(&decoder, &tx, dynamic_calldata, sizeof(dynamic_calldata));
+        calldata_feed(&decoder, &tx, words, sizeof(words));
+        calldata_finish(&decoder, &tx);
+        assert_int_equal(tx.tokenCall, TOKEN_CALL_NONE);
+        words[corrupted[i]] = saved;
+    }
+}
+
+// Write an RLP string or list header
+static size_t rlp_header(uint8_t *out, uint8_t offset, size_t length) {
+    if (length < 56) {
+        out[0] = offset + length;
+        return 1;
+    }
+    size_t bytes = length > 0xff ? (length > 0xffff ? 3 : 2) : 1;
+    out[0] = offset + 55 + bytes;
+    for (size_t i = 0; i < bytes; i++) {
+        out[bytes - i] = (uint8_t) (length >> (8 * i));
+    }
+    return 1 + bytes;
+}
+
+static void test_tx_data_hash(void **state) {
+    (void) state;
+
+    // Keccak-256 of "" and "abc"
+    const uint8_t empty_hash[] = {0xc5, 0xd2, 0x46, 0x01, 0x86, 0xf7, 0x23, 0x3c, 0x92, 0x7e, 0x7d,
+                                  0xb2, 0xdc, 0xc7, 0x03, 0xc0, 0xe5, 0x00, 0xb6, 0x53, 0xca, 0x82,
+                                  0x27, 0x3b, 0x7b, 0xfa, 0xd8, 0x04, 0x5d, 0x85, 0xa4, 0x70};
+    const uint8_t abc_hash[] = {0x4e, 0x03, 0x65, 0x7a, 0xea, 0x45, 0xa9, 0x4f, 0xc7, 0xd4, 0x7b,
+                                0xa8, 0x26, 0xc8, 0xd6, 0x67, 0xc0, 0xd1, 0xe6, 0xe3, 0x3a, 0x64,
+                                0xa0, 0x36, 0xec, 0x44, 0xf5, 0x8f, 0xa1, 0x2d, 0x6c, 0x45};
+    uint8_t digest[DATA_HASH_LEN];
+    data_hash_t hash;
+
+    assert_true(data_hash_init(&hash));
+    assert_true(data_hash_final(&hash, digest));
+    assert_memory_equal(digest, empty_hash, DATA_HASH_LEN);
+    assert_true(data_hash_init(&hash));
+    assert_true(data_hash_update(&hash, (const uint8_t *) "a", 1));
+    assert_true(data_hash_update(&hash, (const uint8_t *) "bc", 2));
+    assert_true(data_hash_final(&hash, digest));
+    assert_memory_equal(digest, abc_hash, DATA_HASH_LEN);
+
+    // Smart contract deploy whose bytecode is larger than MAX_TRANSACTION_LEN:
+    // rlp([encode(rlp([type, nonce, gasPrice, gas, to, value, from, input, humanReadable,
+    // codeFormat])), chainId, 0, 0])
+    static uint8_t bytecode[MAX_TRANSACTION_LEN + 2000];
+    static uint8_t inner[sizeof(bytecode) + 64];
+    static uint8_t raw_tx[sizeof(inner) + 32];
+    const uint8_t head[] = {0x28, 0x05, 0x19, 0x83, 0x0f, 0x42, 0x40, 0x80, 0x80, 0x94};
+    const uint8_t trailer[] = {0x82, 0x03, 0xe9, 0x80, 0x80};
+    size_t fields_len = 0;
+    size_t inner_len = 0;
+    size_t raw_len = 0;
+    uint8_t fields[sizeof(inner)];
+
+    for (size_t i = 0; i < sizeof(bytecode); i++) {
+        bytecode[i] = (uint8_t) (i * 7);
+    }
+    memcpy(fields, head, sizeof(head));
+    fields_len = sizeof(head);
+    memset(fields + fields_len, 0x33, ADDRESS_LEN);
+    fields_len += ADDRESS_LEN;
+    fields_len += rlp_header(fields + fields_len, 0x80, sizeof(bytecode));
+    memcpy(fields + fields_len, bytecode, sizeof(bytecode));
+    fields_len += sizeof(bytecode);
+    fields[fields_len++] = 0x80;
+    fields[fields_len++] = 0x80;
+    inner_len = rlp_header(inner, 0xc0, fields_len);
+    memcpy(inner + inner_len, fields, fields_len);
+    inner_len += fields_len;
+    uint8_t outer[8];
+    size_t outer_len = rlp_header(outer, 0x80, inner_len);
+    raw_len = rlp_header(raw_tx, 0xc0, outer_len + inner_len + sizeof(trailer));
+    memcpy(raw_tx + raw_len, outer, outer_len);
+    raw_len += outer_len;
+    memcpy(raw_tx + raw_len, inner, inner_len);
+    raw_len += inner_len;
+    memcpy(raw_tx + raw_len, trailer, sizeof(trailer));
+    raw_len += sizeof(trailer);
+
+    assert_true(data_hash_init(&hash));
+    assert_true(data_hash_update(&hash, bytecode, sizeof(bytecode)));
+    assert_true(data_hash_final(&hash, digest));
+
+    // Chunks within the bytecode are parsed in place and dropped, as by the SIGN_TX handler
+    const size_t chunk_sizes[] = {1, 17, MAX_APDU_SIZE};
+    for (size_t c = 0; c < sizeof(chunk_sizes) / sizeof(chunk_sizes[0]); c++) {
+        static uint8_t retained[MAX_TRANSACTION_LEN];
+        uint8_t chunk[MAX_APDU_SIZE];
+        size_t retained_len = 0;
+        parser_context_t parser_ctx;
+        parser_status_e status = PARSING_PROCESSING;
+        transaction_t tx;
+
+        memset(&tx, 0, sizeof(tx));
+        transaction_deserialize_init(&parser_ctx, &tx);
+        for (size_t offset = 0; offset < raw_len; offset += chunk_sizes[c]) {
+            size_t chunk_len = MIN(chunk_sizes[c], raw_len - offset);
+            buffer_t buf = {.ptr = chunk, .size = chunk_len, .offset = 0};
+            if (transaction_deserialize_retains_chunk(&parser_ctx, chunk_len)) {
+                assert_true(retained_len + chunk_len <= sizeof(retained));
+                buf.ptr = retained + retained_len;
+                retained_len += chunk_len;
+            }
+            memcpy((uint8_t *) buf.ptr, raw_tx + offset, chunk_len);
+            status = transaction_deserialize_chunk(&parser_ctx,
+                                                   &buf,
+                                                   offset + chunk_len == raw_len);
+            memset(chunk, 0xff, sizeof(chunk));
+        }
+        assert_int_equal(status, PARSING_OK);
+        assert_true(retained_len < 2 * MAX_APDU_SIZE);
+        assert_int_equal(tx.txType, SMART_CONTRACT_DEPLOY);
+        assert_int_equal(tx.nonce.length, 1);
+        assert_int_equal(tx.nonce.value[0], 0x05);
+        assert_int_equal(tx.startgas.length, 3);
+        assert_memory_equal(tx.startgas.value, head + 4, 3);
+        assert_int_equal(tx.chainID.length, 2);
+        assert_memory_equal(tx.chainID.value, trailer + 1, 2);
+        assert_int_equal(tx.dataSize, sizeof(bytecode));
+        assert_memory_equal(tx.dataHash, digest, DATA_HASH_LEN);
+    }
+
+    // An empty data has the hash of no bytes
+    const uint8_t legacy_tx[] = {0xdf, 0x80, 0x80, 0x80, 0x94, 0x0e, 0xe5, 0x6b, 0x60,
+                                 0x4c, 0x86, 0x9e, 0x37, 0x92, 0xc9, 0x9e, 0x35, 0xc1,
+                                 0xc4, 0x24, 0xf8, 0x8f, 0x87, 0xdc, 0x8a, 0x01, 0x80,
+                                 0x82, 0x03, 0xe9, 0x80, 0x80};
+    transaction_t tx;
+    memset(&tx, 0, sizeof(tx));
+    buffer_t buf = {.ptr = legacy_tx, .size = sizeof(legacy_tx), .offset = 0};
+    assert_int_equal(transaction_deserialize(&buf, &tx), PARSING_OK);
+    assert_int_equal(tx.dataSize, 0);
+    assert_memory_equal(tx.dataHash, empty_hash, DATA_HASH_LEN);
+}
+
+// Value transfer with memo: rlp([encode(rlp([type, nonce, gasPrice, gas, to, value, from,
+// memo])), chainId, 0, 0])
+static size_t build_memo_tx(uint8_t *out, const uint8_t *memo, size_t memo_len) {
+    static uint8_t fields[MAX_TRANSACTION_LEN];
+    uint8_t inner_header[4];
+    uint8_t outer_header[4];
+    const uint8_t head[] = {0x10, 0x05, 0x19, 0x82, 0x52, 0x08, 0x94};
+    const uint8_t trailer[] = {0x82, 0x03, 0xe9, 0x80, 0x80};
+    size_t fields_len = 0;
+    size_t out_len = 0;
+
+    memcpy(fields, head, sizeof(head));
+    fields_len = sizeof(head);
+    memset(fields + fields_len, 0x22, ADDRESS_LEN);
+    fields_len += ADDRESS_LEN;
+    fields[fields_len++] = 0x01;
+    fields[fields_len++] = 0x94;
+    memset(fields + fields_len, 0x33, ADDRESS_LEN);
+    fields_len += ADDRESS_LEN;
+    fields_len += rlp_header(fields + fields_len, 0x80, memo_len);
+    memcpy(fields + fields_len, memo, memo_len);
+    fields_len += memo_len;
+
+    size_t inner_header_len = rlp_header(inner_header, 0xc0, fields_len);
+    size_t outer_header_len = rlp_header(outer_header, 0x80, inner_header_len + fields_len);
+    out_len = rlp_header(out,
+                         0xc0,
+                         outer_header_len + inner_header_len + fields_len + sizeof(trailer));
+    memcpy(out + out_len, outer_header, outer_header_len);
+    out_len += outer_header_len;
+    memcpy(out + out_len, inner_header, inner_header_len);
+    out_len += inner_header_len;
+    memcpy(out + out_len, fields, fields_len);
+    out_len += fields_len;
+    memcpy(out + out_len, trailer, sizeof(trailer));
+    return out_len + sizeof(trailer);
+}
+
+static void test_tx_memo(void **state) {
+    (void) state;
+
+    static uint8_t raw_tx[MAX_TRANSACTION_LEN];
+    uint8_t memo[MAX_MEMO_LEN + 1];
+    const char deposit[] = "deposit tag 104512";
+    transaction_t tx;
+    size_t raw_len;
+
+    raw_len = build_memo_tx(raw_tx, (const uint8_t *) deposit, strlen(deposit));
+    memset(&tx, 0, sizeof(tx));
+    buffer_t buf = {.ptr = raw_tx, .size = raw_len, .offset = 0};
+    assert_int_equal(transaction_deserialize(&buf, &tx), PARSING_OK);
+    assert_int_equal(tx.txType, VALUE_TRANSFER_MEMO);
+    assert_int_equal(tx.memoLength, strlen(deposit));
+    assert_memory_equal(tx.memo, deposit, strlen(deposit));
+    assert_int_equal(tx.dataSize, strlen(deposit));
+
+    // The memo is copied as it streams, the chunks can be dropped
+    for (size_t split = 1; split < raw_len; split++) {
+        parser_context_t parser_ctx;
+        uint8_t staging[TX_STAGING_LEN];
+        uint8_t chunk[MAX_APDU_SIZE];
+        memset(&tx, 0, sizeof(tx));
+        transaction_deserialize_init(&parser_ctx, &tx);
+        transaction_deserialize_set_staging(&parser_ctx, staging, sizeof(staging));
+
+        memcpy(chunk, raw_tx, split);
+        buffer_t first = {.ptr = chunk, .size = split, .offset = 0};
+        assert_int_equal(transaction_deserialize_chunk(&parser_ctx, &first, false),
+                         PARSING_PROCESSING);
+        memset(chunk, 0xff, sizeof(chunk));
+
+        memcpy(chunk, raw_tx + split, raw_len - split);
+        buffer_t last = {.ptr = chunk, .size = raw_len - split, .offset = 0};
+        assert_int_equal(transaction_deserialize_chunk(&parser_ctx, &last, true), PARSING_OK);
+
+        assert_int_equal(tx.memoLength, strlen(deposit));
+        assert_memory_equal(tx.memo, deposit, strlen(deposit));
+    }
+
+    // Longest memo displayed
+    memset(memo, 'a', sizeof(memo));
+    raw_len = build_memo_tx(raw_tx, memo, MAX_MEMO_LEN);
+    memset(&tx, 0, sizeof(tx));
+    buf = (buffer_t){.ptr = raw_tx, .size = raw_len, .offset = 0};
+    assert_int_equal(transaction_deserialize(&buf, &tx), PARSING_OK);
+    assert_int_equal(tx.memoLength, MAX_MEMO_LEN);
+
+    // A longer memo is only hashed
+    raw_len = build_memo_tx(raw_tx, memo, MAX_MEMO_LEN + 1);
+    memset(&tx, 0, sizeof(tx));
+    buf = (buffer_t){.ptr = raw_tx, .size = raw_len, .offset = 0};
+    assert_int_equal(transaction_deserialize(&buf, &tx), PARSING_OK);
+    assert_int_equal(tx.memoLength, 0);
+    assert_int_equal(tx.dataSize, MAX_MEMO_LEN + 1);
+
+    // So is a memo that is not ASCII
+    memo[17] = 0xc3;
+    raw_len = build_memo_tx(raw_tx, memo, 40);
+    memset(&tx, 0, sizeof(tx));
+    buf = (buffer_t){.ptr = raw_tx, .size = raw_len, .offset = 0};
+    assert_int_equal(transaction_deserialize(&buf, &tx), PARSING_OK);
+    assert_int_equal(tx.memoLength, 0);
+    assert_int_equal(tx.dataSize, 40);
+
+    // So are memos with a NUL, which would cut the displayed memo, or a line feed
+    memset(memo, 'a', sizeof(memo));
+    memo[5] = '\0';
+    raw_len = build_memo_tx(raw_tx, memo, 40);
+    memset(&tx, 0, sizeof(tx));
+    buf = (buffer_t){.ptr = raw_tx, .size = raw_len, .offset = 0};
+    assert_int_equal(transaction_deserialize(&buf, &tx), PARSING_OK);
+    assert_int_equal(tx.memoLength, 0);
+    memo[5] = '\n';
+    raw_len = build_memo_tx(raw_tx, memo, 40);
+    memset(&tx, 0, sizeof(tx));
+    buf = (buffer_t){.ptr = raw_tx, .size = raw_len, .offset = 0};
+    assert_int_equal(transaction_deserialize(&buf, &tx), PARSING_OK);
+    assert_int_equal(tx.memoLength, 0);
+
+    // Whole words and remaining bytes are checked, from any alignment, against 0x20 to 0x7E
+    const uint8_t printable[] = {0x20, 0x7e};
+    const uint8_t unprintable[] = {0x00, 0x0a, 0x1f, 0x7f, 0x80, 0xff};
+    for (size_t start = 0; start < 8; start++) {
+        for (size_t len = 0; len < 40; len++) {
+            for (size_t p = 0; p < sizeof(printable); p++) {
+                memset(memo, printable[p], sizeof(memo));
+                assert_true(transaction_utils_check_encoding(memo + start, len));
+                for (size_t i = 0; i < len; i++) {
+                    for (size_t u = 0; u < sizeof(unprintable); u++) {
+                        memo[start + i] = unprintable[u];
+                        assert_false(transaction_utils_check_encoding(memo + start, len));
+                    }
+                    memo[start + i] = printable[p];
+                }
+            }
+        }
+    }
+}
+
+// Value transfer signed by the sender, rlp([encode(rlp([type, nonce, gasPrice, gas, to, value,
+// from, [ratio]])), chainId, 0, 0]), or by the fee payer with its address before the chain ID
+static size_t build_fee_payer_tx(uint8_t *out, uint8_t type, bool fee_payer) {
+    uint8_t fields[80];
+    const uint8_t head[] = {0x05, 0x19, 0x82, 0x52, 0x08, 0x94};
+    const uint8_t trailer[] = {0x82, 0x03, 0xe9, 0x80, 0x80};
+    size_t fields_len = 0;
+    size_t out_len;
+
+    fields[fields_len++] = type;
+    memcpy(fields + fields_len, head, sizeof(head));
+    fields_len += sizeof(head);
+    memset(fields + fields_len, 0x22, ADDRESS_LEN);
+    fields_len += ADDRESS_LEN;
+    fields[fields_len++] = 0x01;
+    fields[fields_len++] = 0x94;
+    memset(fields + fields_len, 0x33, ADDRESS_LEN);
+    fields_len += ADDRESS_LEN;
+    if (type == PARTIAL_FEE_DELEGATED_VALUE_TRANSFER) {
+        fields[fields_len++] = 0x1e;
+    }
+
+    size_t payload_len = 2 + fields_len + (fee_payer ? 1 + ADDRESS_LEN : 0) + sizeof(trailer);
+    out_len = rlp_header(out, 0xc0, payload_len);
+    out_len += rlp_header(out + out_len, 0x80, 1 + fields_len);
+    out_len += rlp_header(out + out_len, 0xc0, fields_len);
+    memcpy(out + out_len, fields, fields_len);
+    out_len += fields_len;
+    if (fee_payer) {
+        out[out_len++] = 0x94;
+        memset(out + out_len, 0x44, ADDRESS_LEN);
+        out_len += ADDRESS_LEN;
+    }
+    memcpy(out + out_len, trailer, sizeof(trailer));
+    return out_len + sizeof(trailer);
+}
+
+static void test_tx_fee_payer(void **state) {
+    (void) state;
+
+    uint8_t raw_tx[128];
+    uint8_t sender[ADDRESS_LEN];
+    uint8_t fee_payer[ADDRESS_LEN];
+    transaction_t tx;
+    parser_context_t parser_ctx;
+    size_t raw_len;
+
+    memset(sender, 0x33, sizeof(sender));
+    memset(fee_payer, 0x44, sizeof(fee_payer));
+
+    // The sender is decoded from both preimages, the fee payer from its own, whatever the split
+    raw_len = build_fee_payer_tx(raw_tx, PARTIAL_FEE_DELEGATED_VALUE_TRANSFER, true);
+    for (size_t split = 1; split < raw_len; split++) {
+        uint8_t staging[TX_STAGING_LEN];
+        uint8_t chunk[sizeof(raw_tx)];
+        memset(&tx, 0xff, sizeof(tx));
+        transaction_deserialize_init(&parser_ctx, &tx);
+        transaction_deserialize_set_staging(&parser_ctx, staging, sizeof(staging));
+        transaction_deserialize_set_fee_payer(&parser_ctx);
+
+        memcpy(chunk, raw_tx, split);
+        buffer_t first = {.ptr = chunk, .size = split, .offset = 0};
+        assert_int_equal(transaction_deserialize_chunk(&parser_ctx, &first, false),
+                         PARSING_PROCESSING);
+        memset(chunk, 0xff, sizeof(chunk));
+
+        memcpy(chunk, raw_tx + split, raw_len - split);
+        buffer_t last = {.ptr = chunk, .size = raw_len - split, .offset = 0};
+        assert_int_equal(transaction_deserialize_chunk(&parser_ctx, &last, true), PARSING_OK);
+
+        assert_true(tx.feePayerSignature);
+        assert_int_equal(tx.txType, PARTIAL_FEE_DELEGATED_VALUE_TRANSFER);
+        assert_int_equal(tx.ratio, 0x1e);
+        assert_memory_equal(tx.from, sender, ADDRESS_LEN);
+        assert_memory_equal(tx.feePayer, fee_payer, ADDRESS_LEN);
+        assert_int_equal(tx.chainID.length, 2);
+        assert_memory_equal(tx.chainID.value, raw_tx + raw_len - 4, 2);
+    }
+
+    raw_len = build_fee_payer_tx(raw_tx, FEE_DELEGATED_VALUE_TRANSFER, false);
+    memset(&tx, 0, sizeof(tx));
+    buffer_t buf = {.ptr = raw_tx, .size = raw_len, .offset = 0};
+    assert_int_equal(transaction_deserialize(&buf, &tx), PARSING_OK);
+    assert_false(tx.feePayerSignature);
+    assert_memory_equal(tx.from, sender, ADDRESS_LEN);
+
+    // The sender preimage lacks the fee payer address, the chain ID is read in its place
+    memset(&tx, 0, sizeof(tx));
+    transaction_deserialize_init(&parser_ctx, &tx);
+    transaction_deserialize_set_fee_payer(&parser_ctx);
+    buf.offset = 0;
+    assert_int_equal(transaction_deserialize_chunk(&parser_ctx, &buf, true), PARSING_ERROR);
+
+    // And the fee payer preimage has one field too many for the sender
+    raw_len = build_fee_payer_tx(raw_tx, FEE_DELEGATED_VALUE_TRANSFER, true);
+    memset(&tx, 0, sizeof(tx));
+    buf = (buffer_t){.ptr = raw_tx, .size = raw_len, .offset = 0};
+    assert_int_equal(transaction_deserialize(&buf, &tx), PARSING_ERROR);
+
+    // Basic transactions have no fee payer
+    raw_len = build_fee_payer_tx(raw_tx, VALUE_TRANSFER, true);
+    memset(&tx, 0, sizeof(tx));
+    transaction_deserialize_init(&parser_ctx, &tx);
+    transaction_deserialize_set_fee_payer(&parser_ctx);
+    buf = (buffer_t){.ptr = raw_tx, .size = raw_len, .offset = 0};
+    assert_int_equal(transaction_deserialize_chunk(&parser_ctx, &buf, false), PARSING_ERROR);
+
+    // Nor have legacy and typed transactions
+    const uint8_t legacy_tx[] = {0xdf, 0x80, 0x80, 0x80, 0x94, 0x0e, 0xe5, 0x6b, 0x60,
+                                 0x4c, 0x86, 0x9e, 0x37, 0x92, 0xc9, 0x9e, 0x35, 0xc1,
+                                 0xc4, 0x24, 0xf8, 0x8f, 0x87, 0xdc, 0x8a, 0x01, 0x80,
+                                 0x82, 0x03, 0xe9, 0x80, 0x80};
+    const uint8_t typed_tx[] = {EIP1559, 0xc0};
+    const buffer_t others[] = {{.ptr = legacy_tx, .size = sizeof(legacy_tx), .offset = 0},
+                               {.ptr = typed_tx, .size = sizeof(typed_tx), .offset = 0}};
+    for (size_t i = 0; i < sizeof(others) / sizeof(others[0]); i++) {
+        memset(&tx, 0, sizeof(tx));
+        transaction_deserialize_init(&parser_ctx, &tx);
+        transaction_deserialize_set_fee_payer(&parser_ctx);
+        buf = others[i];
+        assert_int_equal(transaction_deserialize_chunk(&parser_ctx, &buf, true), PARSING_ERROR);
+    }
+
+    // The sender of a Kaia transaction is a whole address
+    raw_len = build_fee_payer_tx(raw_tx, VALUE_TRANSFER, false);
+    raw_tx[raw_len - 6 - ADDRESS_LEN] = 0x93;
+    memset(&tx, 0, sizeof(tx));
+    buf = (buffer_t){.ptr = raw_tx, .size = raw_len, .offset = 0};
+    assert_int_equal(transaction_deserialize(&buf, &tx), PARSING_ERROR);
+}
+
+static void test_tx_registry(void **state) {
+    (void) state;
+
+    const uint8_t kaia_types[] = {VALUE_TRANSFER, VALUE_TRANSFER_MEMO, SMART_CONTRACT_DEPLOY,
+                                  SMART_CONTRACT_EXECUTION, CANCEL};
+    for (size_t i = 0; i < sizeof(kaia_types); i++) {
+        for (uint8_t flavor = BASIC; flavor <= PARTIAL_FEE_DELEGATED; flavor++) {
+            const tx_descriptor_t *descriptor = tx_registry_lookup(kaia_types[i] | flavor);
+            assert_non_null(descriptor);
+            assert_int_equal(descriptor->type, kaia_types[i] | flavor);
+            assert_int_equal(descriptor->flavor, flavor);
+            assert_int_equal((descriptor->review & TX_REVIEW_FEE_RATIO) != 0,
+                             flavor == PARTIAL_FEE_DELEGATED);
+            assert_int_equal((descriptor->review & TX_REVIEW_NETWORK_FEE) != 0,
+                             flavor != FEE_DELEGATED);
+            assert_int_equal((descriptor->review & TX_REVIEW_TOTAL_COST) != 0,
+                             flavor == BASIC && kaia_types[i] != CANCEL);
+            assert_non_null(tx_registry_field(descriptor, descriptor->field_count - 1));
+            assert_null(tx_registry_field(descriptor, descriptor->field_count));
+        }
+        assert_null(tx_registry_lookup(kaia_types[i] | 3));
+    }
+    assert_string_equal(tx_registry_name(tx_registry_lookup(PARTIAL_FEE_DELEGATED_CANCEL)),
+                        "Partial Fee Delegated Cancel");
+    assert_non_null(tx_registry_lookup(LEGACY));
+    assert_int_equal(tx_registry_lookup(EIP2930)->type, EIP2930);
+    assert_int_equal(tx_registry_lookup(EIP1559)->type, EIP1559);
+    assert_null(tx_registry_lookup(0x00));
+    assert_null(tx_registry_lookup(0x40));
+    assert_null(tx_registry_lookup(0xff));
+    assert_true(tx_registry_lookup(SMART_CONTRACT_EXECUTION)->review & TX_REVIEW_TOKEN_CALL);
+    assert_false(tx_registry_lookup(EIP1559)->review & TX_REVIEW_TOKEN_CALL);
+    assert_true(tx_registry_lookup(SMART_CONTRACT_DEPLOY)->review & TX_REVIEW_DATA);
+    assert_true(tx_registry_lookup(VALUE_TRANSFER_MEMO)->review & TX_REVIEW_MEMO);
+    assert_false(tx_registry_lookup(VALUE_TRANSFER)->review & TX_REVIEW_DATA);
+    assert_true(tx_registry_lookup(EIP1559)->review & TX_REVIEW_TOTAL_COST);
+}
+
+static void test_eip155_v(void **state) {
+    (void) state;
+
+    static const uint8_t KAIA_CHAIN_ID[] = {0x20, 0x19};
+    static const uint8_t CHAIN_ID_110[] = {0x6e};
+    uint8_t max_chain_id[MAX_INT256];
+    uint8_t expected[MAX_V_LEN] = {0};
+    uint8_t v[MAX_V_LEN];
+    uint256_view_t chainID = {.value = KAIA_CHAIN_ID, .length = sizeof(KAIA_CHAIN_ID)};
+
+    // 8217 * 2 + 35 + parity
+    assert_int_equal(transaction_utils_eip155_v(&chainID, 0, v), 2);
+    assert_memory_equal(v, ((uint8_t[]){0x40, 0x55}), 2);
+    assert_int_equal(transaction_utils_eip155_v(&chainID, 1, v), 2);
+    assert_memory_equal(v, ((uint8_t[]){0x40, 0x56}), 2);
+
+    // Legacy transaction without chain ID, 27 + parity as before EIP-155
+    chainID.length = 0;
+    assert_int_equal(transaction_utils_eip155_v(&chainID, 0, v), 1);
+    assert_int_equal(v[0], 27);
+    assert_int_equal(transaction_utils_eip155_v(&chainID, 1, v), 1);
+    assert_int_equal(v[0], 28);
+
+    // Across a byte boundary with the parity
+    chainID = (uint256_view_t){.value = CHAIN_ID_110, .length = sizeof(CHAIN_ID_110)};
+    assert_int_equal(transaction_utils_eip155_v(&chainID, 0, v), 1);
+    assert_int_equal(v[0], 0xff);
+    assert_int_equal(transaction_utils_eip155_v(&chainID, 1, v), 2);
+    assert_memory_equal(v, ((uint8_t[]){0x01, 0x00}), 2);
+
+    // 2^256 - 1 doubles over 257 bits: 2^257 + 33
+    memset(max_chain_id, 0xff, sizeof(max_chain_id));
+    chainID = (uint256_view_t){.value = max_chain_id, .length = sizeof(max_chain_id)};
+    expected[0] = 0x02;
+    expected[MAX_V_LEN - 1] = 0x21;
+    assert_int_equal(transaction_utils_eip155_v(&chainID, 0, v), MAX_V_LEN);
+    assert_memory_equal(v, expected, MAX_V_LEN);
+    chainID.length = MAX_INT256 + 1;
+    assert_int_equal(transaction_utils_eip155_v(&chainID, 0, v), 0);
+}
+
+static void test_tx_reused(void **state) {
+    (void) state;
+
+    // Legacy transfer of 1 kei, then a legacy contract creation of 5 kei: empty to and data
+    // clang-format off
+    uint8_t transfer[] = {
+        0xe7, 0x19, 0x85, 0x0b, 0xa4, 0x3b, 0x74, 0x00,
+        0x83, 0x04, 0x93, 0xe0, 0x94, 0x0e, 0xe5, 0x6b,
+        0x60, 0x4c, 0x86, 0x9e, 0x37, 0x92, 0xc9, 0x9e,
+        0x35, 0xc1, 0xc4, 0x24, 0xf8, 0x8f, 0x87, 0xdc,
+        0x8a, 0x01, 0x80, 0x82, 0x03, 0xe9, 0x80, 0x80
+    };
+    uint8_t creation[] = {
+        0xd3, 0x19, 0x85, 0x0b, 0xa4, 0x3b, 0x74, 0x00,
+        0x83, 0x04, 0x93, 0xe0, 0x80, 0x05, 0x80, 0x82,
+        0x03, 0xe9, 0x80, 0x80
+    };
+    // clang-format on
+    static const uint8_t ZERO_ADDRESS[ADDRESS_LEN] = {0};
+    uint8_t hash[BATCH_HASH_LEN] = {0};
+    batch_ctx_t batch;
+    transaction_t tx;
+
+    // The transactions of a batch are parsed in the same structure
+    assert_true(batch_init(&batch, 2));
+    buffer_t buf = {.ptr = transfer, .size = sizeof(transfer), .offset = 0};
+    assert_int_equal(transaction_deserialize(&buf, &tx), PARSING_OK);
+    assert_int_equal(tx.toLength, ADDRESS_LEN);
+    assert_true(batch_add(&batch, &tx, hash));
+
+    // The recipient of the transfer is not kept, the contract creation is refused
+    buf = (buffer_t){.ptr = creation, .size = sizeof(creation), .offset = 0};
+    assert_int_equal(transaction_deserialize(&buf, &tx), PARSING_OK);
+    assert_int_equal(tx.txType, LEGACY);
+    assert_int_equal(tx.toLength, 0);
+    assert_memory_equal(tx.to, ZERO_ADDRESS, ADDRESS_LEN);
+    assert_int_equal(tx.value.length, 1);
+    assert_false(batch_add(&batch, &tx, hash));
+    assert_int_equal(batch.received, 1);
+}
+
 int main() {
     const struct CMUnitTest tests[] = { 
         cmocka_unit_test(test_tx_deserialization),
-        cmocka_unit_test(test_error_tx_deserialization)
+        cmocka_unit_test(test_error_tx_deserialization),
+        cmocka_unit_test(test_tx_deserialization_chunks),
+        cmocka_unit_test(test_tx_deserialization_staging),
+        cmocka_unit_test(test_error_tx_deserialization_chunks),
+        cmocka_unit_test(test_tx_envelope),
+        cmocka_unit_test(test_rlp_header_split),
+        cmocka_unit_test(test_tx_typed),
+        cmocka_unit_test(test_tx_token_call),
+        cmocka_unit_test(test_tx_data_hash),
+        cmocka_unit_test(test_tx_memo),
+        cmocka_unit_test(test_tx_fee_payer),
+        cmocka_unit_test(test_tx_registry),
+        cmocka_unit_test(test_eip155_v),
+        cmocka_unit_test(test_tx_reused)
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
@@ -0,0 +1,350 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <cmocka.h>
+
+#include "constants.h"
+#include "helper/format.h"
+#include "helper/uint256.h"
+
+// Vectors computed with Python integers, in hexadecimal. NULL results overflow 256 bits.
+typedef struct {
+    const char *a;
+    const char *b;
+    const char *sum;
+    const char *product;
+} u256_vector_t;
+
+// clang-format off
+static const u256_vector_t ARITHMETIC_VECTORS[] = {
+    {"0",
+     "0",
+     "0",
+     "0"},
+    {"1",
+     "0",
+     "1",
+     "0"},
+    {"ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff",
+     "1",
+     NULL,
+     "ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff"},
+    {"ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff",
+     "ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff",
+     NULL,
+     NULL},
+    {"8000000000000000000000000000000000000000000000000000000000000000",
+     "2",
+     "8000000000000000000000000000000000000000000000000000000000000002",
+     NULL},
+    {"100000000000000000000000000000000",
+     "100000000000000000000000000000000",
+     "200000000000000000000000000000000",
+     NULL},
+    {"ffffffffffffffffffffffffffffffff",
+     "100000000000000000000000000000001",
+     "200000000000000000000000000000000",
+     "ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff"},
+    {"ffffffff",
+     "ffffffff",
+     "1fffffffe",
+     "fffffffe00000001"},
+    {"ffffffff00000000000000000000000000000000000000000000000000000000",
+     "1",
+     "ffffffff00000000000000000000000000000000000000000000000000000001",
+     "ffffffff00000000000000000000000000000000000000000000000000000000"},
+    {"15af1d78b58c40000",
+     "5208",
+     "15af1d78b58c45208",
+     "6f2c4e995ec98e200000"},
+    {"ffffffffffffffff",
+     "ffffffffffffffff",
+     "1fffffffffffffffe",
+     "fffffffffffffffe0000000000000001"},
+    {"1000000000000000000000000000000000000000000000000",
+     "10000000000000000",
+     "1000000000000000000000000000000010000000000000000",
+     NULL},
+    {"85a0bcc1",
+     "5d998017f5e2fc574dad2986ce834960",
+     "5d998017f5e2fc574dad298754240621",
+     "30db847fcc83c59a235bdda9b7969576d6dcd160"},
+    {"4a24e39a",
+     "c41f9dfd",
+     "10e448197",
+     "38cd667b5db06132"},
+    {"b447c0ceb48438b5",
+     "3fb81d2706e55426eae0d2c11c339464473d212ba950666d",
+     "3fb81d2706e55426eae0d2c11c339464fb84e1fa5dd49f22",
+     "2cdf508d0f9f40e50c1e1388a621b631bd296b0950f37ec322c90217c0744311"},
+    {"d0b0090d62590992",
+     "cd68615c80690847dc159e6a409c38f2",
+     "cd68615c80690848acc5a777a2f54284",
+     "a7720e21809037635e1d72ea7da32b3792e1bf44c73afc04"},
+    {"af371d87d8a8f065a3f96f0e51436d1f",
+     "febddf88d1a6bffff9a39142335e9e2",
+     "bf22fb8065c35c65a393a82274795701",
+     "ae5aa3fc3dc1b966f6a7892ec53130e9a8ca54b661859249d918ae6f0428c5e"},
+    {"e014be00caa7e9bfd00724a123cf493f",
+     "26a2658f",
+     "e014be00caa7e9bfd00724a14a71aece",
+     "21d13a39b5219d59d746f32d1eba772f7c8dc531"},
+    {"cd425ec38f1389998869510db4a02517e1ff83ab",
+     "54bec7d8",
+     "cd425ec38f1389998869510db4a0251836be4b83",
+     "43f2be9647c092df69283f579e4ea60041d66fac23db0548"},
+    {"a386a3a0b730d88fe1e8a4aa1f9db8dd8a3b09dd",
+     "4f",
+     "a386a3a0b730d88fe1e8a4aa1f9db8dd8a3b0a2c",
+     "32768c7e988812d466b6cad07fc1ac0c5da8380b33"},
+    {"ff0f3ba3e2889c795e846bdbd5f6d2f09529af81dda9da14f5079168e06b0c",
+     "24",
+     "ff0f3ba3e2889c795e846bdbd5f6d2f09529af81dda9da14f5079168e06b30",
+     "23de24630bdb3601114a9f2aea16b5a9d4f9dcae432be2aaf2751072bf8f0db0"},
+    {"490ca561d2417eb837ba8818dced3d0398c72689edcd6cfec9e2caebf9993",
+     "e599e3580d3a2dc6925b1ec95f4807bc",
+     "490ca561d2417eb837ba8818dced4b5d36fca75d90a9d6247bcf60e07a14f",
+     NULL},
+    {"947feaa35ff4cb507a2c3b72f5a2224a0ce02d285ac9cd0ebd27b4f2c0855ac9",
+     "de",
+     "947feaa35ff4cb507a2c3b72f5a2224a0ce02d285ac9cd0ebd27b4f2c0855ba7",
+     NULL},
+    {"86e415243fa244adf517a77536be6e688e8b88c21df995313d2b9a3667cc1752",
+     "44673e230ee06e0b",
+     "86e415243fa244adf517a77536be6e688e8b88c21df995318192d85976ac855d",
+     NULL},
+};
+
+static const struct {
+    const char *value;
+    const char *decimal;
+} DECIMAL_VECTORS[] = {
+    {"0",
+     "0"},
+    {"3b9ac9ff",
+     "999999999"},
+    {"3b9aca00",
+     "1000000000"},
+    {"ffffffffffffffff",
+     "18446744073709551615"},
+    {"6f2c4e995ec98e200000",
+     "525000000000000000000000"},
+    {"dd15fe86affad91249ef0eb713f39ebeaa987b6e6fd2a0000000000000000000",
+     "100000000000000000000000000000000000000000000000000000000000000000000000000000"},
+    {"ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff",
+     "115792089237316195423570985008687907853269984665640564039457584007913129639935"},
+};
+// clang-format on
+
+static uint8_t hex_digit(char c) {
+    return (c <= '9') ? c - '0' : c - 'a' + 10;
+}
+
+// View of a hexadecimal vector as a full width big endian field
+static uint256_view_t hex_view(uint8_t bytes[MAX_INT256], const char *hex) {
+    size_t digits = strlen(hex);
+
+    assert_true(digits <= 2 * MAX_INT256);
+    memset(bytes, 0, MAX_INT256);
+    for (size_t i = 0; i < digits; i++) {
+        size_t nibble = 2 * MAX_INT256 - digits + i;
+        bytes[nibble / 2] |= hex_digit(hex[i]) << ((nibble % 2) ? 0 : 4);
+    }
+    return (uint256_view_t){.value = bytes, .length = MAX_INT256};
+}
+
+// Same view without the leading zero bytes, as the fields of a transaction
+static uint256_view_t hex_view_minimal(uint8_t bytes[MAX_INT256], const char *hex) {
+    uint256_view_t view = hex_view(bytes, hex);
+
+    while (view.length != 0 && view.value[0] == 0) {
+        view.value++;
+        view.length--;
+    }
+    return view;
+}
+
+// Load a hexadecimal vector through its big endian view
+static void load_hex(u256_t *out, const char *hex) {
+    uint8_t bytes[MAX_INT256];
+    uint256_view_t view = hex_view(bytes, hex);
+
+    assert_true(u256_from_view(out, &view));
+}
+
+static void assert_u256_equal(const u256_t *value, const char *hex) {
+    u256_t expected;
+
+    load_hex(&expected, hex);
+    assert_memory_equal(value->limbs, expected.limbs, sizeof(expected.limbs));
+    assert_int_equal(u256_cmp(value, &expected), 0);
+}
+
+static void test_u256_view(void **state) {
+    (void) state;
+
+    const uint8_t bytes[MAX_INT256 + 1] = {0x01, 0x02, 0x03, 0x04, 0x05};
+    uint8_t out[MAX_INT256];
+    u256_t value;
+
+    // Short fields are right aligned, the empty one is zero
+    uint256_view_t view = {.value = bytes, .length = 5};
+    assert_true(u256_from_view(&value, &view));
+    assert_int_equal(value.limbs[0], 0x02030405);
+    assert_int_equal(value.limbs[1], 0x01);
+    u256_to_bytes(&value, out);
+    assert_memory_equal(out + MAX_INT256 - 5, bytes, 5);
+    assert_memory_equal(out, bytes + 5, MAX_INT256 - 5);
+
+    view.length = 0;
+    assert_true(u256_from_view(&value, &view));
+    assert_true(u256_is_zero(&value));
+
+    view.length = MAX_INT256 + 1;
+    assert_false(u256_from_view(&value, &view));
+}
+
+static void test_u256_arithmetic(void **state) {
+    (void) state;
+
+    for (size_t i = 0; i < sizeof(ARITHMETIC_VECTORS) / sizeof(ARITHMETIC_VECTORS[0]); i++) {
+        const u256_vector_t *vector = &ARITHMETIC_VECTORS[i];
+        u256_t a;
+        u256_t b;
+        u256_t r;
+
+        load_hex(&a, vector->a);
+        load_hex(&b, vector->b);
+
+        assert_int_equal(u256_add(&r, &a, &b), vector->sum != NULL);
+        if (vector->sum != NULL) {
+            assert_u256_equal(&r, vector->sum);
+        }
+        assert_int_equal(u256_mul(&r, &a, &b), vector->product != NULL);
+        if (vector->product != NULL) {
+            assert_u256_equal(&r, vector->product);
+        }
+        // Both operations commute, the result may alias an operand
+        assert_int_equal(u256_mul(&b, &b, &a), vector->product != NULL);
+        if (vector->product != NULL) {
+            assert_u256_equal(&b, vector->product);
+        }
+        load_hex(&b, vector->b);
+        assert_int_equal(u256_add(&a, &b, &a), vector->sum != NULL);
+        if (vector->sum != NULL) {
+            assert_u256_equal(&a, vector->sum);
+        }
+    }
+}
+
+static void test_u256_cmp(void **state) {
+    (void) state;
+
+    u256_t a;
+    u256_t b;
+
+    load_hex(&a, "100000000");
+    load_hex(&b, "ffffffff");
+    assert_int_equal(u256_cmp(&a, &b), 1);
+    assert_int_equal(u256_cmp(&b, &a), -1);
+    assert_int_equal(u256_cmp(&a, &a), 0);
+    // The most significant limb decides
+    load_hex(&a, "100000000000000000000000000000000000000000000000000000000");
+    load_hex(&b, "ffffffffffffffffffffffffffffffffffffffffffffffffffffffff");
+    assert_int_equal(u256_cmp(&a, &b), 1);
+    assert_false(u256_is_zero(&b));
+}
+
+static void test_u256_divmod(void **state) {
+    (void) state;
+
+    for (size_t i = 0; i < sizeof(DECIMAL_VECTORS) / sizeof(DECIMAL_VECTORS[0]); i++) {
+        char decimal[90] = {0};
+        size_t pos = sizeof(decimal) - 1;
+        u256_t value;
+        u256_t tracked;
+        uint8_t limbs;
+
+        // Nine digits per division, from the least significant ones
+        load_hex(&value, DECIMAL_VECTORS[i].value);
+        tracked = value;
+        limbs = u256_limbs(&tracked);
+        do {
+            uint32_t remainder = u256_divmod_1e9(&value, &value);
+            assert_true(remainder < UINT256_1E9);
+            // Same division over the significant limbs only
+            assert_int_equal(u256_divmod_1e9_limbs(&tracked, &limbs), remainder);
+            assert_memory_equal(tracked.limbs, value.limbs, sizeof(value.limbs));
+            assert_int_equal(limbs, u256_limbs(&value));
+            for (int digit = 0; digit < 9; digit++) {
+                decimal[--pos] = '0' + remainder % 10;
+                remainder /= 10;
+            }
+        } while (!u256_is_zero(&value));
+        while (decimal[pos] == '0' && decimal[pos + 1] != '\0') {
+            pos++;
+        }
+        assert_string_equal(decimal + pos, DECIMAL_VECTORS[i].decimal);
+    }
+}
+
+static void test_decimal_format(void **state) {
+    (void) state;
+
+    static const struct {
+        const char *value;
+        uint8_t decimals;
+        const char *amount;
+    } amounts[] = {
+        {"0", 18, "0"},
+        {"1", 18, "0.000000000000000001"},
+        {"14d1120d7b160000", 18, "1.5"},
+        {"1bc16d674ec80000", 18, "2"},
+        {"3b9aca01", 9, "1.000000001"},
+        {"3b9aca00", 9, "1"},
+        {"3b9aca00", 0, "1000000000"},
+        {"ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff",
+         18,
+         "115792089237316195423570985008687907853269984665640564039457.584007913129639935"},
+    };
+    uint8_t bytes[MAX_INT256];
+    char out[90];
+
+    // Full width and minimal fields take the 256 and 64 bits paths
+    for (size_t i = 0; i < sizeof(DECIMAL_VECTORS) / sizeof(DECIMAL_VECTORS[0]); i++) {
+        uint256_view_t view = hex_view(bytes, DECIMAL_VECTORS[i].value);
+        assert_true(uint256_to_decimal(view, out, sizeof(out)));
+        assert_string_equal(out, DECIMAL_VECTORS[i].decimal);
+
+        view = hex_view_minimal(bytes, DECIMAL_VECTORS[i].value);
+        assert_true(uint256_to_decimal(view, out, sizeof(out)));
+        assert_string_equal(out, DECIMAL_VECTORS[i].decimal);
+    }
+
+    for (size_t i = 0; i < sizeof(amounts) / sizeof(amounts[0]); i++) {
+        uint256_view_t view = hex_view(bytes, amounts[i].value);
+        assert_true(amount_to_string(view, amounts[i].decimals, out, sizeof(out)));
+        assert_string_equal(out, amounts[i].amount);
+
+        // Exact fit, then one character short
+        size_t length = strlen(amounts[i].amount);
+        view = hex_view_minimal(bytes, amounts[i].value);
+        assert_true(amount_to_string(view, amounts[i].decimals, out, length + 1));
+        assert_string_equal(out, amounts[i].amount);
+        assert_false(amount_to_string(view, amounts[i].decimals, out, length));
+    }
+}
+
+int main() {
+    const struct CMUnitTest tests[] = {cmocka_unit_test(test_u256_view),
+                                       cmocka_unit_test(test_u256_arithmetic),
+                                       cmocka_unit_test(test_u256_cmp),
+                                       cmocka_unit_test(test_u256_divmod),
+                                       cmocka_unit_test(test_decimal_format)};
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}